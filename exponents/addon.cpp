@@ -0,0 +1,950 @@
+// addon.cpp
+// Node-API binding of the engine (built by binding.gyp, not by the Makefile). Every call is queued on
+// the libuv thread pool as napi_async_work and returns a Promise, so the event loop is never blocked.
+// Float64Array arguments are read in place and batch results are written straight into a
+// Float64Array, RESULT_FIELDS doubles per point: {Pe, E0, rho, I(X;Y), R0, R_crit, status, converged,
+// evaluation_mode}.
+// The typed arrays must not be modified until the Promise settles. Batches accept options.onResult,
+// called on the main thread with (index, row) for each point as soon as it is solved; the Promise
+// settles after the last of these calls. options.cancelToken (from createCancelToken()) and
+// options.timeoutMs stop the work cooperatively: unstarted points get EP_STATUS_CANCELLED and the
+// point being solved returns its last iterate with EP_STATUS_STOPPED. options.onStats receives the
+// per-worker scheduling counters ({wallMs, threads: [{busyMs, utilisation, points, chunks, stolen,
+// setups}]}) just before the Promise settles. options.memoryBudgetMb caps the quadrature matrices of
+// each worker; points over it are evaluated in streaming mode (EP_EVAL_STREAMING). options.tiled runs
+// every point with the cache-tiled kernel (EP_EVAL_TILED), whose tiles each E0 evaluation may split
+// over options.kernelThreads threads. options.globalGrid integrates over one lattice of received
+// points shared by all symbols (EP_EVAL_GLOBAL_GRID); options.fastGaussTolerance > 0 evaluates the
+// inner sums of constellations of 64+ points by a fast Gauss transform (EP_EVAL_FAST_GAUSS).
+// exponentsProgressive/exponentsCustomProgressive solve one point at growing N (options.initialN,
+// growth, tolerance) and pass each level to options.onLevel({level, N, errorEstimate, final, result})
+// before resolving with the last one.
+// createSession(constellation) wraps an EPSession for editors that move, add or remove single points
+// between solves; its edits are synchronous and throw while a sessionSolve() of it is pending.
+#include <node_api.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "exponents.h"
+
+namespace {
+
+const size_t RESULT_FIELDS = 9;
+
+// EPSession behind a createSession() external; busy while a sessionSolve() runs on the thread pool
+struct SessionHandle {
+    EPSession* session = nullptr;
+    bool busy = false;
+};
+
+struct AddonWork {
+    napi_async_work work = nullptr;
+    napi_deferred deferred = nullptr;
+    SessionHandle* session = nullptr;   // sessionSolve() of this session at session_params
+    EPCustomParams session_params = {};
+    bool custom = false;
+    bool single = false;                // resolve with an object instead of the result array
+    bool progressive = false;           // resolve with final_level; on_result then calls options.onLevel
+    EPProgressiveOptions progressive_options = {};
+    EPProgressiveResult final_level = {};
+    std::vector<EPParams> params;
+    std::vector<EPCustomParams> custom_params;
+    EPBatchOptions options = {};
+    double* out = nullptr;              // backing store of the result Float64Array
+    napi_ref out_ref = nullptr;
+    std::vector<napi_ref> inputs;       // Float64Array inputs read by the worker thread
+    napi_threadsafe_function on_result = nullptr;
+    napi_ref on_stats = nullptr;
+    EPBatchStats stats = {};
+    std::vector<EPThreadStats> thread_stats;
+    napi_status status = napi_ok;
+};
+
+// one row on its way from a worker thread to options.onResult
+struct StreamedRow {
+    size_t index;
+    double row[RESULT_FIELDS];
+};
+
+napi_value throw_type_error(napi_env env, const char* message) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+}
+
+bool has_property(napi_env env, napi_value object, const char* name) {
+    bool has = false;
+    napi_has_named_property(env, object, name, &has);
+    return has;
+}
+
+// Whether options is an object with this property
+bool has_option(napi_env env, napi_value options, const char* name) {
+    napi_valuetype type = napi_undefined;
+    if (options) napi_typeof(env, options, &type);
+    return type == napi_object && has_property(env, options, name);
+}
+
+// Number property, or fallback when it is missing
+bool get_number(napi_env env, napi_value object, const char* name, double fallback, double& value) {
+    if (!has_property(env, object, name)) {
+        value = fallback;
+        return true;
+    }
+    napi_value property;
+    napi_get_named_property(env, object, name, &property);
+    return napi_get_value_double(env, property, &value) == napi_ok;
+}
+
+bool get_bool(napi_env env, napi_value object, const char* name, bool fallback, bool& value) {
+    if (!has_property(env, object, name)) {
+        value = fallback;
+        return true;
+    }
+    napi_value property;
+    napi_get_named_property(env, object, name, &property);
+    return napi_get_value_bool(env, property, &value) == napi_ok;
+}
+
+bool get_string(napi_env env, napi_value object, const char* name, const char* fallback, std::string& value) {
+    if (!has_property(env, object, name)) {
+        value = fallback;
+        return true;
+    }
+    napi_value property;
+    napi_get_named_property(env, object, name, &property);
+    size_t length;
+    if (napi_get_value_string_utf8(env, property, nullptr, 0, &length) != napi_ok) return false;
+    value.resize(length);
+    napi_get_value_string_utf8(env, property, &value[0], length + 1, &length);
+    return true;
+}
+
+// Data pointer of a Float64Array (no copy) and a reference that keeps it alive during the work
+bool get_float64_array(napi_env env, napi_value value, double*& data, size_t& length, AddonWork* w) {
+    bool is_typedarray = false;
+    napi_is_typedarray(env, value, &is_typedarray);
+    if (!is_typedarray) return false;
+    napi_typedarray_type type;
+    void* raw;
+    napi_value arraybuffer;
+    size_t offset;
+    napi_get_typedarray_info(env, value, &type, &length, &raw, &arraybuffer, &offset);
+    if (type != napi_float64_array) return false;
+    data = static_cast<double*>(raw);
+    napi_ref ref;
+    napi_create_reference(env, value, 1, &ref);
+    w->inputs.push_back(ref);
+    return true;
+}
+
+int modulation_code(const std::string& name) {
+    if (name == "PAM") return EP_MOD_PAM;
+    if (name == "PSK") return EP_MOD_PSK;
+    if (name == "QAM") return EP_MOD_QAM;
+    return -1; // reported as EP_STATUS_INVALID_PARAMS
+}
+
+int distribution_code(const std::string& name) {
+    if (name == "uniform") return EP_DIST_UNIFORM;
+    if (name == "maxwell-boltzmann" || name == "boltzmann") return EP_DIST_MAXWELL_BOLTZMANN;
+    return -1;
+}
+
+// {M, typeModulation, SNR, R, N, n, threshold, distribution, shaping_param}, as in exponents()
+bool read_params(napi_env env, napi_value object, EPParams& p) {
+    double M, N;
+    std::string modulation, distribution;
+    bool ok = get_number(env, object, "M", 2, M) && get_string(env, object, "typeModulation", "PAM", modulation) &&
+              get_number(env, object, "SNR", 1, p.SNR) && get_number(env, object, "R", 0.5, p.R) &&
+              get_number(env, object, "N", 15, N) && get_number(env, object, "n", 100, p.n) &&
+              get_number(env, object, "threshold", 1e-6, p.threshold) &&
+              get_string(env, object, "distribution", "uniform", distribution) &&
+              get_number(env, object, "shaping_param", 0.0, p.shaping_param);
+    p.M = static_cast<int>(M);
+    p.N = static_cast<int>(N);
+    p.modulation = modulation_code(modulation);
+    p.distribution = distribution_code(distribution);
+    return ok;
+}
+
+// {SNR, R, N, n, threshold} for the constellation of the call
+bool read_custom_params(napi_env env, napi_value object, const EPCustomParams& constellation, EPCustomParams& p) {
+    double N;
+    p = constellation;
+    bool ok = get_number(env, object, "SNR", 1, p.SNR) && get_number(env, object, "R", 0.5, p.R) &&
+              get_number(env, object, "N", 15, N) && get_number(env, object, "n", 100, p.n) &&
+              get_number(env, object, "threshold", 1e-6, p.threshold);
+    p.N = static_cast<int>(N);
+    return ok;
+}
+
+// {real, imag, probabilities}: Float64Arrays of equal length
+bool read_constellation(napi_env env, napi_value object, EPCustomParams& c, AddonWork* w) {
+    const char* names[3] = {"real", "imag", "probabilities"};
+    double* data[3];
+    size_t length[3];
+    for (int k = 0; k < 3; k++) {
+        napi_value property;
+        if (napi_get_named_property(env, object, names[k], &property) != napi_ok ||
+            !get_float64_array(env, property, data[k], length[k], w))
+            return false;
+    }
+    if (length[0] != length[1] || length[0] != length[2]) return false;
+    c = EPCustomParams();
+    c.real_parts = data[0];
+    c.imag_parts = data[1];
+    c.probabilities = data[2];
+    c.num_points = static_cast<int>(length[0]);
+    return true;
+}
+
+void settle(napi_env env, AddonWork* w);
+
+// runs on the main thread for each StreamedRow
+void call_on_result(napi_env env, napi_value callback, void*, void* data) {
+    StreamedRow* streamed = static_cast<StreamedRow*>(data);
+    if (env) {
+        napi_value argv[2], arraybuffer, undefined;
+        void* raw;
+        napi_create_double(env, static_cast<double>(streamed->index), &argv[0]);
+        napi_create_arraybuffer(env, sizeof(streamed->row), &raw, &arraybuffer);
+        std::copy(streamed->row, streamed->row + RESULT_FIELDS, static_cast<double*>(raw));
+        napi_create_typedarray(env, napi_float64_array, RESULT_FIELDS, arraybuffer, 0, &argv[1]);
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, callback, 2, argv, nullptr);
+    }
+    delete streamed;
+}
+
+// the thread-safe function is finalized once its queue is drained, after the work completed
+void finalize_on_result(napi_env env, void* data, void*) {
+    settle(env, static_cast<AddonWork*>(data));
+}
+
+// {memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance} of options (may be null or
+// undefined): the evaluation settings of a call, also taken by the cost estimates
+bool read_evaluation_options(napi_env env, napi_value options, EPBatchOptions& o) {
+    double memory_budget_mb = 0, kernel_threads = 0, fast_gauss_tolerance = 0;
+    bool tiled = false, global_grid = false;
+    if (options) {
+        napi_valuetype type;
+        napi_typeof(env, options, &type);
+        if (type != napi_undefined &&
+            (type != napi_object || !get_number(env, options, "memoryBudgetMb", 0, memory_budget_mb) ||
+             !get_bool(env, options, "tiled", false, tiled) ||
+             !get_number(env, options, "kernelThreads", 0, kernel_threads) ||
+             !get_bool(env, options, "globalGrid", false, global_grid) ||
+             !get_number(env, options, "fastGaussTolerance", 0, fast_gauss_tolerance)))
+            return false;
+    }
+    o.memory_budget = static_cast<size_t>(std::max(0.0, memory_budget_mb) * 1024 * 1024);
+    o.tiled = tiled;
+    o.kernel_threads = static_cast<int>(std::max(0.0, kernel_threads));
+    o.global_grid = global_grid;
+    o.fast_gauss_tolerance = fast_gauss_tolerance;
+    return true;
+}
+
+// options = {threads, out, onResult, onStats, cancelToken, timeoutMs} and the evaluation settings of
+// read_evaluation_options: out is an optional Float64Array of at least count * RESULT_FIELDS doubles
+bool read_options(napi_env env, napi_value options, size_t count, AddonWork* w) {
+    double threads = 0, timeout_ms = 0;
+    if (options) {
+        napi_valuetype type;
+        napi_typeof(env, options, &type);
+        if (type == napi_undefined) options = nullptr;
+        else if (type != napi_object || !get_number(env, options, "threads", 0, threads) ||
+                 !get_number(env, options, "timeoutMs", 0, timeout_ms))
+            return false;
+    }
+    if (!read_evaluation_options(env, options, w->options)) return false;
+    w->options.threads = static_cast<int>(threads);
+    w->options.timeout_ms = timeout_ms;
+
+    if (options && has_property(env, options, "cancelToken")) {
+        napi_value token;
+        napi_get_named_property(env, options, "cancelToken", &token);
+        napi_valuetype type;
+        napi_typeof(env, token, &type);
+        if (type != napi_external) return false;
+        void* raw;
+        napi_get_value_external(env, token, &raw);
+        w->options.cancel = static_cast<EPCancelToken*>(raw);
+        napi_ref ref;
+        napi_create_reference(env, token, 1, &ref);
+        w->inputs.push_back(ref);
+    }
+
+    napi_value out;
+    if (options && has_property(env, options, "out")) {
+        napi_get_named_property(env, options, "out", &out);
+        size_t length;
+        bool is_typedarray = false;
+        napi_is_typedarray(env, out, &is_typedarray);
+        if (!is_typedarray) return false;
+        napi_typedarray_type type;
+        void* raw;
+        napi_value arraybuffer;
+        size_t offset;
+        napi_get_typedarray_info(env, out, &type, &length, &raw, &arraybuffer, &offset);
+        if (type != napi_float64_array || length < count * RESULT_FIELDS) return false;
+        w->out = static_cast<double*>(raw);
+    } else {
+        napi_value arraybuffer;
+        void* raw;
+        napi_create_arraybuffer(env, count * RESULT_FIELDS * sizeof(double), &raw, &arraybuffer);
+        napi_create_typedarray(env, napi_float64_array, count * RESULT_FIELDS, arraybuffer, 0, &out);
+        w->out = static_cast<double*>(raw);
+    }
+    napi_create_reference(env, out, 1, &w->out_ref);
+
+    if (options && has_property(env, options, "onResult")) {
+        napi_value callback, name;
+        napi_get_named_property(env, options, "onResult", &callback);
+        napi_valuetype type;
+        napi_typeof(env, callback, &type);
+        if (type != napi_function) return false;
+        napi_create_string_utf8(env, "epcalculator.onResult", NAPI_AUTO_LENGTH, &name);
+        napi_create_threadsafe_function(env, callback, nullptr, name, 0, 1, w, finalize_on_result, nullptr,
+                                        call_on_result, &w->on_result);
+    }
+
+    if (options && has_property(env, options, "onStats")) {
+        napi_value callback;
+        napi_get_named_property(env, options, "onStats", &callback);
+        napi_valuetype type;
+        napi_typeof(env, callback, &type);
+        if (type != napi_function) return false;
+        napi_create_reference(env, callback, 1, &w->on_stats);
+        const int threads = w->options.threads > 0 ? w->options.threads : static_cast<int>(std::thread::hardware_concurrency());
+        w->thread_stats.resize(std::max(threads, 1));
+        w->stats.per_thread = w->thread_stats.data();
+        w->stats.per_thread_capacity = static_cast<int>(w->thread_stats.size());
+        w->options.stats = &w->stats;
+    }
+    return true;
+}
+
+void to_row(const EPResult* result, double* row) {
+    row[0] = result->Pe;
+    row[1] = result->E0;
+    row[2] = result->rho;
+    row[3] = result->mutual_information;
+    row[4] = result->cutoff_rate;
+    row[5] = result->critical_rate;
+    row[6] = result->status;
+    row[7] = result->converged;
+    row[8] = result->evaluation_mode;
+}
+
+// EPResultCallback: writes the row into the result array and forwards a copy to options.onResult
+void write_result(size_t index, const EPResult* result, void* data) {
+    AddonWork* w = static_cast<AddonWork*>(data);
+    double* row = w->out + index * RESULT_FIELDS;
+    to_row(result, row);
+    if (w->on_result) {
+        StreamedRow* streamed = new StreamedRow();
+        streamed->index = index;
+        std::copy(row, row + RESULT_FIELDS, streamed->row);
+        napi_call_threadsafe_function(w->on_result, streamed, napi_tsfn_blocking);
+    }
+}
+
+// EPProgressiveCallback: forwards a copy of the level to options.onLevel
+void write_level(const EPProgressiveResult* level, void* data) {
+    AddonWork* w = static_cast<AddonWork*>(data);
+    if (w->on_result) napi_call_threadsafe_function(w->on_result, new EPProgressiveResult(*level), napi_tsfn_blocking);
+}
+
+void execute(napi_env, void* data) {
+    AddonWork* w = static_cast<AddonWork*>(data);
+    const size_t count = w->session ? 1 : w->custom ? w->custom_params.size() : w->params.size();
+    std::vector<EPResult> results(count);
+    w->options.on_result = write_result;
+    w->options.user_data = w;
+    if (w->progressive) {
+        w->progressive_options.on_level = write_level;
+        w->progressive_options.user_data = w;
+        if (w->custom) {
+            exponents_custom_progressive(&w->custom_params[0], &w->progressive_options, &w->options, &w->final_level);
+        } else {
+            exponents_progressive(&w->params[0], &w->progressive_options, &w->options, &w->final_level);
+        }
+        to_row(&w->final_level.result, w->out);
+    } else if (w->session) {
+        const EPCustomParams& p = w->session_params;
+        ep_session_solve(w->session->session, p.SNR, p.R, p.N, p.n, p.threshold, &w->options, &results[0]);
+        write_result(0, &results[0], w);
+    } else if (w->custom) {
+        exponents_custom_batch(w->custom_params.data(), count, results.data(), &w->options);
+    } else {
+        exponents_batch(w->params.data(), count, results.data(), &w->options);
+    }
+}
+
+void set_number(napi_env env, napi_value object, const char* name, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, name, number);
+}
+
+// {error_probability, ..., evaluation_mode} of one result row
+napi_value result_object(napi_env env, const double* row) {
+    const char* names[RESULT_FIELDS] = {"error_probability", "error_exponent", "optimal_rho", "mutual_information",
+                                        "cutoff_rate", "critical_rate", "status", "converged", "evaluation_mode"};
+    napi_value result;
+    napi_create_object(env, &result);
+    for (size_t k = 0; k < RESULT_FIELDS; k++) set_number(env, result, names[k], row[k]);
+    return result;
+}
+
+// {level, N, errorEstimate, final, result}
+napi_value level_object(napi_env env, const EPProgressiveResult& level) {
+    double row[RESULT_FIELDS];
+    to_row(&level.result, row);
+    napi_value object, final;
+    napi_create_object(env, &object);
+    set_number(env, object, "level", level.level);
+    set_number(env, object, "N", level.N);
+    set_number(env, object, "errorEstimate", level.error_estimate);
+    napi_get_boolean(env, level.final != 0, &final);
+    napi_set_named_property(env, object, "final", final);
+    napi_set_named_property(env, object, "result", result_object(env, row));
+    return object;
+}
+
+// runs on the main thread for each level of a progressive call
+void call_on_level(napi_env env, napi_value callback, void*, void* data) {
+    EPProgressiveResult* level = static_cast<EPProgressiveResult*>(data);
+    if (env) {
+        napi_value argv[1] = {level_object(env, *level)}, undefined;
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, callback, 1, argv, nullptr);
+    }
+    delete level;
+}
+
+// options = {initialN, growth, tolerance, onLevel} of a progressive call, next to read_options'
+bool read_progressive_options(napi_env env, napi_value options, AddonWork* w) {
+    double initial_N = 0, growth = 0, tolerance = 0;
+    napi_valuetype type = napi_undefined;
+    if (options) napi_typeof(env, options, &type);
+    if (type == napi_object &&
+        (!get_number(env, options, "initialN", 0, initial_N) || !get_number(env, options, "growth", 0, growth) ||
+         !get_number(env, options, "tolerance", 0, tolerance)))
+        return false;
+    w->progressive = true;
+    w->progressive_options.initial_N = static_cast<int>(initial_N);
+    w->progressive_options.growth = growth;
+    w->progressive_options.tolerance = tolerance;
+
+    if (type == napi_object && has_property(env, options, "onLevel")) {
+        napi_value callback, name;
+        napi_get_named_property(env, options, "onLevel", &callback);
+        napi_valuetype callback_type;
+        napi_typeof(env, callback, &callback_type);
+        if (callback_type != napi_function) return false;
+        napi_create_string_utf8(env, "epcalculator.onLevel", NAPI_AUTO_LENGTH, &name);
+        napi_create_threadsafe_function(env, callback, nullptr, name, 0, 1, w, finalize_on_result, nullptr,
+                                        call_on_level, &w->on_result);
+    }
+    return true;
+}
+
+// options.onStats({wallMs, threads: [...]})
+void report_stats(napi_env env, AddonWork* w) {
+    napi_value callback, stats, threads, undefined;
+    napi_get_reference_value(env, w->on_stats, &callback);
+    napi_create_object(env, &stats);
+    set_number(env, stats, "wallMs", w->stats.wall_ms);
+    const int count = std::min(w->stats.threads, w->stats.per_thread_capacity);
+    napi_create_array_with_length(env, count, &threads);
+    for (int t = 0; t < count; t++) {
+        const EPThreadStats& s = w->thread_stats[t];
+        napi_value thread;
+        napi_create_object(env, &thread);
+        set_number(env, thread, "busyMs", s.busy_ms);
+        set_number(env, thread, "utilisation", s.utilisation);
+        set_number(env, thread, "points", static_cast<double>(s.points));
+        set_number(env, thread, "chunks", static_cast<double>(s.chunks));
+        set_number(env, thread, "stolen", static_cast<double>(s.stolen));
+        set_number(env, thread, "setups", static_cast<double>(s.setups));
+        napi_set_element(env, threads, t, thread);
+    }
+    napi_set_named_property(env, stats, "threads", threads);
+    napi_get_undefined(env, &undefined);
+    napi_call_function(env, undefined, callback, 1, &stats, nullptr);
+}
+
+void settle(napi_env env, AddonWork* w) {
+    napi_value out;
+    napi_get_reference_value(env, w->out_ref, &out);
+    if (w->on_stats && w->status == napi_ok) report_stats(env, w);
+
+    if (w->status != napi_ok) {
+        napi_value message, error;
+        napi_create_string_utf8(env, "computation was not run", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, nullptr, message, &error);
+        napi_reject_deferred(env, w->deferred, error);
+    } else if (w->progressive) {
+        napi_resolve_deferred(env, w->deferred, level_object(env, w->final_level));
+    } else if (w->single) {
+        napi_resolve_deferred(env, w->deferred, result_object(env, w->out));
+    } else {
+        napi_resolve_deferred(env, w->deferred, out);
+    }
+
+    napi_delete_reference(env, w->out_ref);
+    if (w->on_stats) napi_delete_reference(env, w->on_stats);
+    for (napi_ref ref: w->inputs) napi_delete_reference(env, ref);
+    napi_delete_async_work(env, w->work);
+    delete w;
+}
+
+void complete(napi_env env, napi_status status, void* data) {
+    AddonWork* w = static_cast<AddonWork*>(data);
+    w->status = status;
+    if (w->session) w->session->busy = false;
+    if (w->on_result) {
+        napi_release_threadsafe_function(w->on_result, napi_tsfn_release); // settles when drained
+    } else {
+        settle(env, w);
+    }
+}
+
+napi_value queue(napi_env env, AddonWork* w) {
+    napi_value promise, name;
+    napi_create_promise(env, &w->deferred, &promise);
+    napi_create_string_utf8(env, "epcalculator", NAPI_AUTO_LENGTH, &name);
+    napi_create_async_work(env, nullptr, name, execute, complete, w, &w->work);
+    napi_queue_async_work(env, w->work);
+    return promise;
+}
+
+// releases a work item that was never queued
+napi_value reject_arguments(napi_env env, AddonWork* w, const char* message) {
+    if (w->out_ref) napi_delete_reference(env, w->out_ref);
+    if (w->on_stats) napi_delete_reference(env, w->on_stats);
+    for (napi_ref ref: w->inputs) napi_delete_reference(env, ref);
+    delete w;
+    return throw_type_error(env, message);
+}
+
+// Array elements as objects
+bool read_array(napi_env env, napi_value array, std::vector<napi_value>& items) {
+    bool is_array = false;
+    napi_is_array(env, array, &is_array);
+    if (!is_array) return false;
+    uint32_t length;
+    napi_get_array_length(env, array, &length);
+    items.resize(length);
+    for (uint32_t k = 0; k < length; k++) {
+        napi_get_element(env, array, k, &items[k]);
+        napi_valuetype type;
+        napi_typeof(env, items[k], &type);
+        if (type != napi_object) return false;
+    }
+    return true;
+}
+
+// exponents(params, options?) -> Promise<result>
+napi_value Exponents(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2] = {nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    w->single = true;
+    w->params.resize(1);
+    if (argc < 1 || !read_params(env, argv[0], w->params[0]))
+        return reject_arguments(env, w, "exponents(params, options): params must be an object of numbers and strings");
+    if (!read_options(env, argv[1], 1, w))
+        return reject_arguments(env, w, "exponents(params, options): invalid options");
+    w->options.threads = 1;
+    return queue(env, w);
+}
+
+// exponentsCustom({real, imag, probabilities}, params, options?) -> Promise<result>
+napi_value ExponentsCustom(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    w->single = true;
+    w->custom = true;
+    w->custom_params.resize(1);
+    EPCustomParams constellation;
+    if (argc < 2 || !read_constellation(env, argv[0], constellation, w) ||
+        !read_custom_params(env, argv[1], constellation, w->custom_params[0]))
+        return reject_arguments(env, w, "exponentsCustom(constellation, params, options): constellation needs Float64Arrays real, imag and probabilities of equal length");
+    if (!read_options(env, argv[2], 1, w))
+        return reject_arguments(env, w, "exponentsCustom(constellation, params, options): invalid options");
+    w->options.threads = 1;
+    return queue(env, w);
+}
+
+// exponentsProgressive(params, options?) -> Promise<final level>
+napi_value ExponentsProgressive(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2] = {nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    w->params.resize(1);
+    if (argc < 1 || !read_params(env, argv[0], w->params[0]))
+        return reject_arguments(env, w, "exponentsProgressive(params, options): params must be an object of numbers and strings");
+    if (has_option(env, argv[1], "onResult") || !read_options(env, argv[1], 1, w) || !read_progressive_options(env, argv[1], w))
+        return reject_arguments(env, w, "exponentsProgressive(params, options): invalid options");
+    return queue(env, w);
+}
+
+// exponentsCustomProgressive({real, imag, probabilities}, params, options?) -> Promise<final level>
+napi_value ExponentsCustomProgressive(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    w->custom = true;
+    w->custom_params.resize(1);
+    EPCustomParams constellation;
+    if (argc < 2 || !read_constellation(env, argv[0], constellation, w) ||
+        !read_custom_params(env, argv[1], constellation, w->custom_params[0]))
+        return reject_arguments(env, w, "exponentsCustomProgressive(constellation, params, options): constellation needs Float64Arrays real, imag and probabilities of equal length");
+    if (has_option(env, argv[2], "onResult") || !read_options(env, argv[2], 1, w) || !read_progressive_options(env, argv[2], w))
+        return reject_arguments(env, w, "exponentsCustomProgressive(constellation, params, options): invalid options");
+    return queue(env, w);
+}
+
+// exponentsBatch(params[], options?) -> Promise<Float64Array>
+napi_value ExponentsBatch(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2] = {nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    std::vector<napi_value> items;
+    if (argc < 1 || !read_array(env, argv[0], items))
+        return reject_arguments(env, w, "exponentsBatch(params, options): params must be an array of objects");
+    w->params.resize(items.size());
+    for (size_t k = 0; k < items.size(); k++) {
+        if (!read_params(env, items[k], w->params[k]))
+            return reject_arguments(env, w, "exponentsBatch(params, options): invalid parameter object");
+    }
+    if (!read_options(env, argv[1], items.size(), w))
+        return reject_arguments(env, w, "exponentsBatch(params, options): options.out must be a large enough Float64Array");
+    return queue(env, w);
+}
+
+// exponentsCustomBatch({real, imag, probabilities}, params[], options?) -> Promise<Float64Array>
+napi_value ExponentsCustomBatch(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork* w = new AddonWork();
+    w->custom = true;
+    EPCustomParams constellation;
+    std::vector<napi_value> items;
+    if (argc < 2 || !read_constellation(env, argv[0], constellation, w) || !read_array(env, argv[1], items))
+        return reject_arguments(env, w, "exponentsCustomBatch(constellation, params, options): invalid constellation or params");
+    w->custom_params.resize(items.size());
+    for (size_t k = 0; k < items.size(); k++) {
+        if (!read_custom_params(env, items[k], constellation, w->custom_params[k]))
+            return reject_arguments(env, w, "exponentsCustomBatch(constellation, params, options): invalid parameter object");
+    }
+    if (!read_options(env, argv[2], items.size(), w))
+        return reject_arguments(env, w, "exponentsCustomBatch(constellation, params, options): options.out must be a large enough Float64Array");
+    return queue(env, w);
+}
+
+void finalize_session(napi_env, void* data, void*) {
+    SessionHandle* handle = static_cast<SessionHandle*>(data);
+    ep_session_destroy(handle->session);
+    delete handle;
+}
+
+// Session of a createSession() external, or nullptr (with a TypeError thrown) when the value is not
+// one or a solve of it is pending
+SessionHandle* get_session(napi_env env, napi_value value, const char* usage) {
+    napi_valuetype type = napi_undefined;
+    if (value) napi_typeof(env, value, &type);
+    if (type != napi_external) {
+        throw_type_error(env, usage);
+        return nullptr;
+    }
+    void* raw;
+    napi_get_value_external(env, value, &raw);
+    SessionHandle* handle = static_cast<SessionHandle*>(raw);
+    if (handle->busy) {
+        napi_throw_error(env, nullptr, "the session is being solved; wait for sessionSolve() to settle");
+        return nullptr;
+    }
+    return handle;
+}
+
+// createSession({real, imag, probabilities}) -> opaque session (the arrays are copied)
+napi_value CreateSession(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1] = {nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork w; // only holds the references taken by read_constellation
+    EPCustomParams constellation;
+    const bool ok = argc >= 1 && read_constellation(env, argv[0], constellation, &w) && constellation.num_points >= 1;
+    EPSession* session = ok ? ep_session_create(constellation.real_parts, constellation.imag_parts,
+                                                constellation.probabilities, constellation.num_points) : nullptr;
+    for (napi_ref ref: w.inputs) napi_delete_reference(env, ref);
+    if (!session) return throw_type_error(env, "createSession(constellation): constellation needs Float64Arrays real, imag and probabilities of equal, nonzero length");
+    SessionHandle* handle = new SessionHandle();
+    handle->session = session;
+    napi_value result;
+    napi_create_external(env, handle, finalize_session, nullptr, &result);
+    return result;
+}
+
+// Numbers argv[first..first+count) of a session edit
+bool read_numbers(napi_env env, const napi_value* argv, size_t argc, size_t first, size_t count, double* values) {
+    if (argc < first + count) return false;
+    for (size_t k = 0; k < count; k++) {
+        if (napi_get_value_double(env, argv[first + k], &values[k]) != napi_ok) return false;
+    }
+    return true;
+}
+
+// sessionMovePoint(session, index, real, imag)
+napi_value SessionMovePoint(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value argv[4] = {nullptr, nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    const char* usage = "sessionMovePoint(session, index, real, imag): invalid session or point";
+    SessionHandle* handle = get_session(env, argv[0], usage);
+    if (!handle) return nullptr;
+    double v[3];
+    if (!read_numbers(env, argv, argc, 1, 3, v) ||
+        ep_session_move_point(handle->session, static_cast<int>(v[0]), v[1], v[2]) != EP_STATUS_OK)
+        return throw_type_error(env, usage);
+    return nullptr;
+}
+
+// sessionSetProbability(session, index, probability)
+napi_value SessionSetProbability(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    const char* usage = "sessionSetProbability(session, index, probability): invalid session, index or probability";
+    SessionHandle* handle = get_session(env, argv[0], usage);
+    if (!handle) return nullptr;
+    double v[2];
+    if (!read_numbers(env, argv, argc, 1, 2, v) ||
+        ep_session_set_probability(handle->session, static_cast<int>(v[0]), v[1]) != EP_STATUS_OK)
+        return throw_type_error(env, usage);
+    return nullptr;
+}
+
+// sessionAddPoint(session, real, imag, probability) -> index of the new point
+napi_value SessionAddPoint(napi_env env, napi_callback_info info) {
+    size_t argc = 4;
+    napi_value argv[4] = {nullptr, nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    const char* usage = "sessionAddPoint(session, real, imag, probability): invalid session or point";
+    SessionHandle* handle = get_session(env, argv[0], usage);
+    if (!handle) return nullptr;
+    double v[3];
+    if (!read_numbers(env, argv, argc, 1, 3, v) ||
+        ep_session_add_point(handle->session, v[0], v[1], v[2]) != EP_STATUS_OK)
+        return throw_type_error(env, usage);
+    napi_value index;
+    napi_create_int32(env, ep_session_size(handle->session) - 1, &index);
+    return index;
+}
+
+// sessionRemovePoint(session, index): later points move down by one
+napi_value SessionRemovePoint(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2] = {nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    const char* usage = "sessionRemovePoint(session, index): invalid session or index (a session keeps at least one point)";
+    SessionHandle* handle = get_session(env, argv[0], usage);
+    if (!handle) return nullptr;
+    double index;
+    if (!read_numbers(env, argv, argc, 1, 1, &index) ||
+        ep_session_remove_point(handle->session, static_cast<int>(index)) != EP_STATUS_OK)
+        return throw_type_error(env, usage);
+    return nullptr;
+}
+
+// sessionSolve(session, {SNR, R, N, n, threshold}, options?) -> Promise<result>, as exponentsCustom
+napi_value SessionSolve(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    SessionHandle* handle = get_session(env, argv[0], "sessionSolve(session, params, options): session must come from createSession()");
+    if (!handle) return nullptr;
+    AddonWork* w = new AddonWork();
+    w->single = true;
+    if (argc < 2 || !read_custom_params(env, argv[1], EPCustomParams(), w->session_params))
+        return reject_arguments(env, w, "sessionSolve(session, params, options): params must be an object of numbers");
+    if (!read_options(env, argv[2], 1, w))
+        return reject_arguments(env, w, "sessionSolve(session, params, options): invalid options");
+    napi_ref ref; // keeps the session alive until the work settles
+    napi_create_reference(env, argv[0], 1, &ref);
+    w->inputs.push_back(ref);
+    w->session = handle;
+    handle->busy = true;
+    return queue(env, w);
+}
+
+napi_value cost_object(napi_env env, const EPCostEstimate& estimate) {
+    napi_value result;
+    napi_create_object(env, &result);
+    set_number(env, result, "timeMs", estimate.time_ms);
+    set_number(env, result, "peakBytes", estimate.peak_bytes);
+    set_number(env, result, "streamingPeakBytes", estimate.streaming_peak_bytes);
+    set_number(env, result, "evaluations", estimate.evaluations);
+    set_number(env, result, "evaluationMode", estimate.evaluation_mode);
+    return result;
+}
+
+napi_value model_object(napi_env env, const EPCostModel& model) {
+    napi_value result;
+    napi_create_object(env, &result);
+    set_number(env, result, "setupNsPerCell", model.setup_ns_per_cell);
+    set_number(env, result, "evalNsPerCell", model.eval_ns_per_cell);
+    set_number(env, result, "tiledNsPerCell", model.tiled_ns_per_cell);
+    set_number(env, result, "gridNsPerCell", model.grid_ns_per_cell);
+    set_number(env, result, "evaluations", model.evaluations);
+    set_number(env, result, "overheadMs", model.overhead_ms);
+    set_number(env, result, "calibrationMs", model.calibration_ms);
+    return result;
+}
+
+// estimateCost(params, options) -> {timeMs, peakBytes, streamingPeakBytes, evaluations, evaluationMode},
+// synchronous, in the mode a call with the evaluation settings of options would run in (the first
+// call runs the calibration unless calibrateCostModel() did)
+napi_value EstimateCost(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2] = {nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    EPParams params;
+    EPBatchOptions options = {};
+    EPCostEstimate estimate;
+    bool ok = argc >= 1 && read_params(env, argv[0], params) && read_evaluation_options(env, argv[1], options);
+    if (ok) {
+        applyCallOptions(&options, std::chrono::steady_clock::now());
+        ok = ep_estimate_cost(&params, &estimate) == EP_STATUS_OK;
+        resetCallOptions();
+    }
+    if (!ok) return throw_type_error(env, "estimateCost(params, options): params must be an object of numbers and strings");
+    return cost_object(env, estimate);
+}
+
+// estimateCustomCost({real, imag, probabilities}, params, options) -> same as estimateCost
+napi_value EstimateCustomCost(napi_env env, napi_callback_info info) {
+    size_t argc = 3;
+    napi_value argv[3] = {nullptr, nullptr, nullptr};
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    AddonWork w; // only holds the references taken by read_constellation
+    EPCustomParams constellation, params;
+    EPBatchOptions options = {};
+    EPCostEstimate estimate;
+    bool ok = argc >= 2 && read_constellation(env, argv[0], constellation, &w) &&
+              read_custom_params(env, argv[1], constellation, params) && read_evaluation_options(env, argv[2], options);
+    if (ok) {
+        applyCallOptions(&options, std::chrono::steady_clock::now());
+        ok = ep_estimate_custom_cost(&params, &estimate) == EP_STATUS_OK;
+        resetCallOptions();
+    }
+    for (napi_ref ref: w.inputs) napi_delete_reference(env, ref);
+    if (!ok) return throw_type_error(env, "estimateCustomCost(constellation, params, options): invalid constellation, params or options");
+    return cost_object(env, estimate);
+}
+
+// costModel() -> coefficients of the calibrated model
+napi_value CostModel(napi_env env, napi_callback_info) {
+    EPCostModel model;
+    ep_get_cost_model(&model);
+    return model_object(env, model);
+}
+
+struct CalibrationWork {
+    napi_async_work work = nullptr;
+    napi_deferred deferred = nullptr;
+    EPCostModel model = {};
+};
+
+void execute_calibration(napi_env, void* data) {
+    ep_calibrate_cost_model(&static_cast<CalibrationWork*>(data)->model);
+}
+
+void complete_calibration(napi_env env, napi_status, void* data) {
+    CalibrationWork* w = static_cast<CalibrationWork*>(data);
+    napi_resolve_deferred(env, w->deferred, model_object(env, w->model));
+    napi_delete_async_work(env, w->work);
+    delete w;
+}
+
+// calibrateCostModel() -> Promise<model>, runs the microbenchmark on the thread pool
+napi_value CalibrateCostModel(napi_env env, napi_callback_info) {
+    CalibrationWork* w = new CalibrationWork();
+    napi_value promise, name;
+    napi_create_promise(env, &w->deferred, &promise);
+    napi_create_string_utf8(env, "epcalculator.calibrate", NAPI_AUTO_LENGTH, &name);
+    napi_create_async_work(env, nullptr, name, execute_calibration, complete_calibration, w, &w->work);
+    napi_queue_async_work(env, w->work);
+    return promise;
+}
+
+void finalize_cancel_token(napi_env, void* data, void*) {
+    ep_cancel_token_destroy(static_cast<EPCancelToken*>(data));
+}
+
+// createCancelToken() -> opaque token for options.cancelToken
+napi_value CreateCancelToken(napi_env env, napi_callback_info) {
+    napi_value token;
+    napi_create_external(env, ep_cancel_token_create(), finalize_cancel_token, nullptr, &token);
+    return token;
+}
+
+// cancel(token): every call using the token stops at its next check
+napi_value Cancel(napi_env env, napi_callback_info info) {
+    size_t argc = 1;
+    napi_value argv[1];
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    napi_valuetype type = napi_undefined;
+    if (argc >= 1) napi_typeof(env, argv[0], &type);
+    if (type != napi_external) return throw_type_error(env, "cancel(token): token must come from createCancelToken()");
+    void* raw;
+    napi_get_value_external(env, argv[0], &raw);
+    ep_cancel_token_cancel(static_cast<EPCancelToken*>(raw));
+    return nullptr;
+}
+
+napi_value Init(napi_env env, napi_value exports) {
+    napi_property_descriptor properties[] = {
+        {"exponents", nullptr, Exponents, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exponentsCustom", nullptr, ExponentsCustom, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exponentsBatch", nullptr, ExponentsBatch, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exponentsCustomBatch", nullptr, ExponentsCustomBatch, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"createCancelToken", nullptr, CreateCancelToken, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"cancel", nullptr, Cancel, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"estimateCost", nullptr, EstimateCost, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"estimateCustomCost", nullptr, EstimateCustomCost, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"costModel", nullptr, CostModel, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"calibrateCostModel", nullptr, CalibrateCostModel, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exponentsProgressive", nullptr, ExponentsProgressive, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"exponentsCustomProgressive", nullptr, ExponentsCustomProgressive, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"createSession", nullptr, CreateSession, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"sessionMovePoint", nullptr, SessionMovePoint, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"sessionSetProbability", nullptr, SessionSetProbability, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"sessionAddPoint", nullptr, SessionAddPoint, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"sessionRemovePoint", nullptr, SessionRemovePoint, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"sessionSolve", nullptr, SessionSolve, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+    napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties);
+
+    napi_value fields;
+    napi_create_uint32(env, RESULT_FIELDS, &fields);
+    napi_set_named_property(env, exports, "RESULT_FIELDS", fields);
+    return exports;
+}
+
+} // namespace
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Init)
@@ -0,0 +1,358 @@
+// batch.cpp
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "functions.h"
+#include "exponents.h"
+
+// The engine state (constellation, Q, PI, D, ...) is thread_local, so each worker owns one setup at a
+// time. Points are sorted so that those sharing a setup are contiguous, and every run of equal setups
+// is cut into chunks of similar predicted time (ep_estimate_cost). The chunks are dealt most expensive
+// first to the least loaded worker queue; a worker runs its own queue from the front and, once empty,
+// steals from the back of the most loaded one, preferring a chunk of the setup it already holds. A
+// worker skips setMod/setQ (and keeps PI) whenever consecutive chunks share its setup.
+
+struct EPCancelToken {
+    std::atomic<bool> cancelled{false};
+};
+
+namespace {
+
+// points order[begin..end) share one setup
+struct BatchChunk {
+    size_t begin;
+    size_t end;
+    double cost;
+};
+
+// Chunk indices queued for one worker, most expensive first
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<size_t> chunks;
+    double remaining = 0.0; // predicted cost of the queued chunks
+};
+
+// chunks per worker: enough to even the queues out by stealing, few enough to rarely repeat a setup
+const int CHUNKS_PER_THREAD = 4;
+
+const char* modulation_name(int modulation) {
+    switch (modulation) {
+        case EP_MOD_PSK: return "PSK";
+        case EP_MOD_QAM: return "QAM";
+        default: return "PAM";
+    }
+}
+
+const char* distribution_name(int distribution) {
+    return distribution == EP_DIST_MAXWELL_BOLTZMANN ? "maxwell-boltzmann" : "uniform";
+}
+
+// the shaping parameter only matters for Maxwell-Boltzmann
+double shaping_key(const EPParams& p) {
+    return p.distribution == EP_DIST_MAXWELL_BOLTZMANN ? p.shaping_param : 0.0;
+}
+
+// Predicted time of one point (cost_model.cpp)
+double point_cost(const EPParams& p) {
+    EPCostEstimate estimate;
+    ep_estimate_cost(&p, &estimate);
+    return estimate.time_ms;
+}
+
+double point_cost(const EPCustomParams& p) {
+    EPCostEstimate estimate;
+    ep_estimate_custom_cost(&p, &estimate);
+    return estimate.time_ms;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+auto setup_key(const EPParams& p) {
+    return std::make_tuple(p.M, p.modulation, p.distribution, shaping_key(p), p.N);
+}
+
+auto setup_key(const EPCustomParams& p) {
+    return std::make_tuple(p.real_parts, p.imag_parts, p.probabilities, p.num_points, p.N);
+}
+
+void store(EPResult& out, size_t index, const double* results, int status, bool converged, int mode) {
+    out.Pe = results[0];
+    out.E0 = results[1];
+    out.rho = results[2];
+    out.mutual_information = results[3];
+    out.cutoff_rate = results[4];
+    out.critical_rate = results[5];
+    out.status = status;
+    out.converged = converged;
+    out.evaluation_mode = mode;
+    out.index = index;
+}
+
+template <typename P>
+void run_batch(const P* params, size_t count, EPResult* results, const EPBatchOptions* options) {
+    const double failed[6] = {-1.0, -1.0, 0.0, 0.0, 0.0, 0.0};
+
+    std::mutex callback_mutex;
+    auto finish = [&](size_t k, const double* point, int status, bool converged = false, int mode = EP_EVAL_DENSE) {
+        store(results[k], k, point, status, converged, mode);
+        if (options && options->on_result) {
+            std::lock_guard<std::mutex> lock(callback_mutex);
+            options->on_result(k, &results[k], options->user_data);
+        }
+    };
+
+    vector<size_t> order;
+    order.reserve(count);
+    for (size_t k = 0; k < count; k++) {
+        if (validPoint(params[k])) {
+            order.push_back(k);
+        } else {
+            finish(k, failed, EP_STATUS_INVALID_PARAMS);
+        }
+    }
+    if (order.empty()) {
+        if (options && options->stats) {
+            options->stats->wall_ms = 0.0;
+            options->stats->threads = 0;
+        }
+        return;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return setup_key(params[a]) < setup_key(params[b]);
+    });
+
+    int threads = options ? options->threads : 0;
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // the costs are estimated in the evaluation mode the workers will run in (worker 0 is this thread
+    // and applies the options again when it starts)
+    applyCallOptions(options, std::chrono::steady_clock::now());
+    double total_cost = 0.0;
+    for (size_t k: order) total_cost += point_cost(params[k]);
+    const double grain = total_cost / (threads * CHUNKS_PER_THREAD);
+
+    // runs of equal setups, cut into pieces of about grain each
+    vector<BatchChunk> chunks;
+    for (size_t begin = 0; begin < order.size();) {
+        size_t end = begin;
+        double run_cost = 0.0;
+        while (end < order.size() && setup_key(params[order[end]]) == setup_key(params[order[begin]])) {
+            run_cost += point_cost(params[order[end]]);
+            end++;
+        }
+        const size_t pieces = std::min(end - begin, static_cast<size_t>(std::ceil(run_cost / grain)));
+        for (size_t piece = 0; piece < pieces; piece++) {
+            BatchChunk chunk = {begin + (end - begin) * piece / pieces, begin + (end - begin) * (piece + 1) / pieces, 0.0};
+            for (size_t k = chunk.begin; k < chunk.end; k++) chunk.cost += point_cost(params[order[k]]);
+            chunks.push_back(chunk);
+        }
+        begin = end;
+    }
+    threads = static_cast<int>(std::min<size_t>(threads, chunks.size()));
+
+    // longest processing time first: pieces of one run have equal cost and stay adjacent in a queue
+    vector<size_t> by_cost(chunks.size());
+    for (size_t c = 0; c < chunks.size(); c++) by_cost[c] = c;
+    std::stable_sort(by_cost.begin(), by_cost.end(), [&](size_t a, size_t b) { return chunks[a].cost > chunks[b].cost; });
+    vector<WorkerQueue> queues(threads);
+    for (size_t c: by_cost) {
+        WorkerQueue& least = *std::min_element(queues.begin(), queues.end(), [](const WorkerQueue& a, const WorkerQueue& b) {
+            return a.remaining < b.remaining;
+        });
+        least.chunks.push_back(c);
+        least.remaining += chunks[c].cost;
+    }
+
+    // Next chunk for worker t: its own front, else the back of the most loaded queue, preferring a
+    // chunk with the setup held by the worker. Nothing is queued after the start, so false means done.
+    auto take = [&](int t, const P* held, size_t& c, bool& stolen) {
+        {
+            std::lock_guard<std::mutex> lock(queues[t].mutex);
+            if (!queues[t].chunks.empty()) {
+                c = queues[t].chunks.front();
+                queues[t].chunks.pop_front();
+                queues[t].remaining -= chunks[c].cost;
+                stolen = false;
+                return true;
+            }
+        }
+        for (;;) {
+            int victim = -1;
+            double most = 0.0;
+            for (int v = 0; v < threads; v++) {
+                std::lock_guard<std::mutex> lock(queues[v].mutex);
+                if (!queues[v].chunks.empty() && (victim < 0 || queues[v].remaining > most)) {
+                    victim = v;
+                    most = queues[v].remaining;
+                }
+            }
+            if (victim < 0) return false;
+
+            std::lock_guard<std::mutex> lock(queues[victim].mutex);
+            std::deque<size_t>& q = queues[victim].chunks;
+            if (q.empty()) continue; // emptied in the meantime
+            auto pick = std::prev(q.end());
+            if (held) {
+                for (auto it = q.rbegin(); it != q.rend(); ++it) {
+                    if (setup_key(params[order[chunks[*it].begin]]) == setup_key(*held)) {
+                        pick = std::prev(it.base());
+                        break;
+                    }
+                }
+            }
+            c = *pick;
+            q.erase(pick);
+            queues[victim].remaining -= chunks[c].cost;
+            stolen = true;
+            return true;
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    vector<EPThreadStats> stats(threads, EPThreadStats());
+    auto worker = [&](int t) {
+        applyCallOptions(options, start);
+        EPThreadStats& st = stats[t];
+        const P* held = nullptr; // params of the setup currently in this thread's engine state
+        bool pi_ready = false;
+        size_t c;
+        bool stolen;
+        while (take(t, held, c, stolen)) {
+            const BatchChunk chunk = chunks[c];
+            const auto chunk_start = std::chrono::steady_clock::now();
+            st.chunks++;
+            st.stolen += stolen;
+            if (solverStopRequested()) {
+                for (size_t k = chunk.begin; k < chunk.end; k++) finish(order[k], failed, EP_STATUS_CANCELLED);
+                continue;
+            }
+            const P& first = params[order[chunk.begin]];
+            if (!held || setup_key(*held) != setup_key(first)) {
+                held = nullptr;
+                pi_ready = false;
+                st.setups++;
+                try {
+                    setupPoint(first);
+                } catch (const std::exception&) {
+                    for (size_t k = chunk.begin; k < chunk.end; k++) finish(order[k], failed, EP_STATUS_FAILED);
+                    st.busy_ms += elapsed_ms(chunk_start);
+                    continue;
+                }
+                held = &first;
+            }
+            for (size_t k = chunk.begin; k < chunk.end; k++) {
+                if (solverStopRequested()) {
+                    finish(order[k], failed, EP_STATUS_CANCELLED);
+                    continue;
+                }
+                const P& p = params[order[k]];
+                double point[6] = {-1.0, -1.0, 0.0, 0.0, 0.0, 0.0};
+                try {
+                    const int status = exponents_point(p.SNR, p.R, p.N, p.n, p.threshold, pi_ready, point);
+                    finish(order[k], point, status, getSolverConverged(), getEvaluationMode());
+                    st.points++;
+                } catch (const std::exception&) {
+                    finish(order[k], failed, EP_STATUS_FAILED);
+                }
+            }
+            st.busy_ms += elapsed_ms(chunk_start);
+        }
+        resetCallOptions();
+    };
+
+    vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto &t: pool) t.join();
+
+    if (options && options->stats) {
+        EPBatchStats& out = *options->stats;
+        out.wall_ms = elapsed_ms(start);
+        out.threads = threads;
+        for (int t = 0; out.per_thread && t < threads && t < out.per_thread_capacity; t++) {
+            stats[t].utilisation = out.wall_ms > 0 ? stats[t].busy_ms / out.wall_ms : 0.0;
+            out.per_thread[t] = stats[t];
+        }
+    }
+}
+
+} // namespace
+
+bool validPoint(const EPParams& p) {
+    return p.M >= 1 && p.N >= 1 && p.modulation >= EP_MOD_PAM && p.modulation <= EP_MOD_QAM &&
+           (p.distribution == EP_DIST_UNIFORM || p.distribution == EP_DIST_MAXWELL_BOLTZMANN);
+}
+
+bool validPoint(const EPCustomParams& p) {
+    return p.real_parts && p.imag_parts && p.probabilities && p.num_points >= 1 && p.N >= 1;
+}
+
+void setupPoint(const EPParams& p) {
+    setMod(p.M, modulation_name(p.modulation));
+    setQ(distribution_name(p.distribution), p.shaping_param);
+    normalizeX_for_Q();
+}
+
+void setupPoint(const EPCustomParams& p) {
+    setCustomConstellation(p.real_parts, p.imag_parts, p.probabilities, p.num_points);
+}
+
+void applyCallOptions(const EPBatchOptions* options, std::chrono::steady_clock::time_point start) {
+    const std::atomic<bool>* cancel = (options && options->cancel) ? &options->cancel->cancelled : nullptr;
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (options && options->timeout_ms > 0) {
+        deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(options->timeout_ms));
+    }
+    setSolverStop(cancel, deadline);
+    setMemoryBudget(options ? options->memory_budget : 0);
+    setTiledEvaluation(options && options->tiled ? 1 : -1, options ? options->kernel_threads : 0);
+    setGlobalGridQuadrature(options && options->global_grid ? 1 : -1);
+    const bool fast_gauss = options && options->fast_gauss_tolerance > 0 && options->fast_gauss_tolerance < 1;
+    setFastGaussTolerance(fast_gauss ? options->fast_gauss_tolerance : -1.0);
+}
+
+void resetCallOptions() {
+    setSolverStop(nullptr, std::chrono::steady_clock::time_point::max());
+    setMemoryBudget(0);
+    setTiledEvaluation(-1, 0);
+    setGlobalGridQuadrature(-1);
+    setFastGaussTolerance(-1.0);
+}
+
+extern "C" {
+
+    void exponents_batch(const EPParams* params, size_t count, EPResult* results, const EPBatchOptions* options) {
+        run_batch(params, count, results, options);
+    }
+
+    void exponents_custom_batch(const EPCustomParams* params, size_t count, EPResult* results, const EPBatchOptions* options) {
+        run_batch(params, count, results, options);
+    }
+
+    EPCancelToken* ep_cancel_token_create(void) {
+        return new EPCancelToken();
+    }
+
+    void ep_cancel_token_cancel(EPCancelToken* token) {
+        token->cancelled = true;
+    }
+
+    int ep_cancel_token_is_cancelled(const EPCancelToken* token) {
+        return token->cancelled;
+    }
+
+    void ep_cancel_token_destroy(EPCancelToken* token) {
+        delete token;
+    }
+
+}
@@ -0,0 +1,27 @@
+{
+  "targets": [
+    {
+      "target_name": "epcalculator",
+      "sources": [
+        "addon.cpp",
+        "batch.cpp",
+        "cost_model.cpp",
+        "exponents.cpp",
+        "fast_gauss.cpp",
+        "functions.cpp",
+        "hermite.cpp",
+        "progressive.cpp",
+        "session.cpp"
+      ],
+      "include_dirs": ["../eigen-3.4.0"],
+      "cflags": ["-pthread", "-O2"],
+      "cflags_cc": ["-std=c++17", "-fexceptions"],
+      "cflags_cc!": ["-fno-exceptions", "-fno-rtti"],
+      "ldflags": ["-pthread"],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17"
+      }
+    }
+  ]
+}
@@ -0,0 +1,280 @@
+// cost_model.cpp
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "functions.h"
+#include "exponents.h"
+
+// The time of a point depends on the mode its E0 evaluations run in (quadratureModeFor, under the
+// calling thread's settings):
+//   dense:  overhead + setup_ns_per_cell * cells + evaluations * eval_ns_per_cell * cells
+//   tiled:  overhead + evaluations * tiled_ns_per_cell * cells (streaming, and fast Gauss, which falls
+//           back to the tiled kernel whenever the transform would not beat it)
+//   grid:   overhead + evaluations * grid_ns_per_cell * M G^2
+// with cells = M^2 N^2 and G the global grid points per axis. The coefficients are measured once per
+// process on this machine by running the engine itself on a 16-QAM constellation in each mode, and
+// the fixed overhead on a tiny 4-QAM one; the peak memory follows from the buffer sizes of the mode
+// (quadraturePeakBytes, tiledPeakBytes, globalGridPeakBytes). Points on the low-SNR series build no
+// quadrature at all and cost only the overhead.
+
+namespace {
+
+// calibration setup: large enough for the per-cell terms to dominate, small enough to take ~0.1 s
+const int CALIBRATION_M = 16;
+const int CALIBRATION_N = 12;
+const int CALIBRATION_SMALL_M = 4;
+const int CALIBRATION_SMALL_N = 4;
+const double CALIBRATION_SNR = 5.0;
+const int CALIBRATION_REPEATS = 3;
+
+// rho of the timed evaluations, and the one the global grid of an estimate is sized at: the solver
+// evaluates E0 over [0, 1]
+const double CALIBRATION_RHO = 0.5;
+
+std::mutex model_mutex;
+std::once_flag model_once;
+EPCostModel model = {};
+
+// Standard constellations as setupPoint builds them, for the low-SNR series decision
+struct StandardSetup {
+    int M, modulation, distribution;
+    double shaping_param;
+    std::vector<std::complex<double>> X;
+    std::vector<double> Q;
+};
+
+const size_t SETUP_CACHE_SIZE = 32;
+std::mutex setups_mutex;
+std::vector<StandardSetup> setups;
+
+double cells(int M, int N) {
+    return static_cast<double>(M) * M * N * N;
+}
+
+double ms_since(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+void setup_qam(int M, int N, double SNR) {
+    setMod(M, "QAM");
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setR(0.5);
+    setN(N);
+    setSNR(SNR);
+}
+
+// fastest of CALIBRATION_REPEATS E_0_co calls (the first one also pays for page faults)
+double time_evaluation() {
+    double best = 0.0, grad_rho, e0;
+    for (int k = 0; k < CALIBRATION_REPEATS; k++) {
+        const auto t = std::chrono::steady_clock::now();
+        E_0_co(0.5, CALIBRATION_RHO, grad_rho, e0);
+        const double ms = ms_since(t);
+        if (k == 0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+// Global grid points of the constellation set up in this thread
+double grid_cells(double SNR) {
+    const auto points = getX();
+    double lo_re = 0, hi_re = 0, lo_im = 0, hi_im = 0;
+    for (const auto& x: points) {
+        lo_re = std::min(lo_re, x.real());
+        hi_re = std::max(hi_re, x.real());
+        lo_im = std::min(lo_im, x.imag());
+        hi_im = std::max(hi_im, x.imag());
+    }
+    const double scale = std::sqrt(SNR);
+    return static_cast<double>(points.size()) * globalGridAxisPoints(scale * (hi_re - lo_re), CALIBRATION_RHO) *
+           globalGridAxisPoints(scale * (hi_im - lo_im), CALIBRATION_RHO);
+}
+
+// Runs on its own thread so that the caller's engine state (thread_local) is left alone
+EPCostModel measure() {
+    EPCostModel m = {};
+    const auto start = std::chrono::steady_clock::now();
+    std::thread([&m]() {
+        // each mode explicitly, whatever the process defaults
+        setMemoryBudget(std::numeric_limits<size_t>::max());
+        setTiledEvaluation(0, 1);
+        setGlobalGridQuadrature(0);
+        setFastGaussTolerance(0.0);
+
+        const double c = cells(CALIBRATION_M, CALIBRATION_N);
+        setup_qam(CALIBRATION_M, CALIBRATION_N, CALIBRATION_SNR);
+
+        auto t = std::chrono::steady_clock::now();
+        setPI();
+        setW();
+        const double setup_ms = ms_since(t);
+        const double eval_ms = time_evaluation();
+
+        // a full solve tells how many evaluations (gradient steps plus I, R0 and R_crit) a point takes
+        bool pi_ready = true;
+        double results[6];
+        t = std::chrono::steady_clock::now();
+        exponents_point(CALIBRATION_SNR, 0.5, CALIBRATION_N, 100, 1e-6, pi_ready, results);
+        const double solve_ms = ms_since(t);
+
+        m.setup_ns_per_cell = 1e6 * setup_ms / c;
+        m.eval_ns_per_cell = 1e6 * eval_ms / c;
+        m.evaluations = std::max(1.0, (solve_ms - setup_ms) / eval_ms);
+
+        setTiledEvaluation(1, 1);
+        setPI();
+        setW();
+        m.tiled_ns_per_cell = 1e6 * time_evaluation() / c;
+
+        setTiledEvaluation(0, 1);
+        setGlobalGridQuadrature(1);
+        setPI();
+        setW();
+        m.grid_ns_per_cell = 1e6 * time_evaluation() / grid_cells(CALIBRATION_SNR);
+        setGlobalGridQuadrature(0);
+
+        // whatever a tiny point takes beyond its per-cell terms is fixed cost (Hermite tables, solver
+        // bookkeeping, output)
+        setup_qam(CALIBRATION_SMALL_M, CALIBRATION_SMALL_N, CALIBRATION_SNR);
+        pi_ready = false;
+        t = std::chrono::steady_clock::now();
+        exponents_point(CALIBRATION_SNR, 0.5, CALIBRATION_SMALL_N, 100, 1e-6, pi_ready, results);
+        const double small_ms = ms_since(t);
+        const double small_cells = cells(CALIBRATION_SMALL_M, CALIBRATION_SMALL_N);
+        m.overhead_ms = std::max(0.0, small_ms - 1e-6 * small_cells * (m.setup_ns_per_cell + m.evaluations * m.eval_ns_per_cell));
+    }).join();
+    m.calibration_ms = ms_since(start);
+    return m;
+}
+
+EPCostModel current_model() {
+    std::call_once(model_once, []() {
+        const EPCostModel m = measure();
+        std::lock_guard<std::mutex> lock(model_mutex);
+        model = m;
+    });
+    std::lock_guard<std::mutex> lock(model_mutex);
+    return model;
+}
+
+// Widths along the real and imaginary axes of the normalized constellation setX builds (uniform Q);
+// Maxwell-Boltzmann shaping spreads the outer points further, which this slightly underestimates
+void widths(const EPParams& p, double& width_re, double& width_im) {
+    const double L = std::round(std::sqrt(static_cast<double>(p.M)));
+    width_re = width_im = 0.0;
+    if (p.M < 2) return;
+    if (p.modulation == EP_MOD_PSK) {
+        width_re = 2.0;
+        width_im = p.M > 2 ? 2.0 : 0.0;
+    } else if (p.modulation == EP_MOD_QAM && L * L == p.M) {
+        width_re = width_im = 2.0 * std::sqrt(1.5 * (L - 1.0) / (L + 1.0));
+    } else { // PAM, and QAM of a non-square M, which setX builds as PAM
+        width_re = 2.0 * std::sqrt(3.0 * (p.M - 1.0) / (p.M + 1.0));
+    }
+}
+
+void widths(const EPCustomParams& p, double& width_re, double& width_im) {
+    const auto re = std::minmax_element(p.real_parts, p.real_parts + p.num_points);
+    const auto im = std::minmax_element(p.imag_parts, p.imag_parts + p.num_points);
+    width_re = *re.second - *re.first;
+    width_im = *im.second - *im.first;
+}
+
+// Whether exponents_point will take the low-SNR series (useLowSNRSeries) for this point. A standard
+// constellation is built once per setup on its own thread, so that the caller's engine state
+// (thread_local) is left alone.
+bool low_snr_series(const EPParams& p) {
+    const double shaping = p.distribution == EP_DIST_MAXWELL_BOLTZMANN ? p.shaping_param : 0.0;
+    std::lock_guard<std::mutex> lock(setups_mutex);
+    auto it = std::find_if(setups.begin(), setups.end(), [&](const StandardSetup& s) {
+        return s.M == p.M && s.modulation == p.modulation && s.distribution == p.distribution && s.shaping_param == shaping;
+    });
+    if (it == setups.end()) {
+        StandardSetup setup = {p.M, p.modulation, p.distribution, shaping, {}, {}};
+        std::thread([&setup, &p]() {
+            setupPoint(p);
+            setup.X = getX();
+            setup.Q = getQ();
+        }).join();
+        if (setups.size() >= SETUP_CACHE_SIZE) setups.erase(setups.begin());
+        setups.push_back(std::move(setup));
+        it = setups.end() - 1;
+    }
+    return lowSNRSeriesFor(it->X.data(), it->Q.data(), p.M, p.SNR);
+}
+
+bool low_snr_series(const EPCustomParams& p) {
+    std::vector<std::complex<double>> X(p.num_points);
+    for (int i = 0; i < p.num_points; i++) X[i] = std::complex<double>(p.real_parts[i], p.imag_parts[i]);
+    return lowSNRSeriesFor(X.data(), p.probabilities, p.num_points, p.SNR);
+}
+
+void estimate(int M, int N, double SNR, double width_re, double width_im, bool series, EPCostEstimate* out) {
+    const EPCostModel m = current_model();
+    const double c = cells(M, N);
+    out->evaluation_mode = series ? EP_EVAL_LOW_SNR_SERIES : quadratureModeFor(M, N);
+    out->evaluations = m.evaluations;
+    out->streaming_peak_bytes = static_cast<double>(tiledPeakBytes(M, N)); // factor tables of one tile
+    switch (out->evaluation_mode) {
+        case EP_EVAL_LOW_SNR_SERIES:
+            out->time_ms = m.overhead_ms;
+            out->peak_bytes = 0.0;
+            break;
+        case EP_EVAL_DENSE:
+            out->time_ms = m.overhead_ms + 1e-6 * c * (m.setup_ns_per_cell + m.evaluations * m.eval_ns_per_cell);
+            out->peak_bytes = static_cast<double>(quadraturePeakBytes(M, N));
+            break;
+        case EP_EVAL_GLOBAL_GRID: {
+            const int rows = globalGridAxisPoints(std::sqrt(SNR) * width_re, CALIBRATION_RHO);
+            const int cols = globalGridAxisPoints(std::sqrt(SNR) * width_im, CALIBRATION_RHO);
+            out->time_ms = m.overhead_ms + 1e-6 * M * rows * cols * m.evaluations * m.grid_ns_per_cell;
+            out->peak_bytes = static_cast<double>(globalGridPeakBytes(M, rows, cols));
+            break;
+        }
+        default: // tiled, streaming and fast Gauss
+            out->time_ms = m.overhead_ms + 1e-6 * c * m.evaluations * m.tiled_ns_per_cell;
+            out->peak_bytes = out->streaming_peak_bytes;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+    void ep_calibrate_cost_model(EPCostModel* out) {
+        const EPCostModel m = measure();
+        std::call_once(model_once, []() {}); // a later first estimate must not calibrate again
+        std::lock_guard<std::mutex> lock(model_mutex);
+        model = m;
+        if (out) *out = m;
+    }
+
+    void ep_get_cost_model(EPCostModel* out) {
+        *out = current_model();
+    }
+
+    int ep_estimate_cost(const EPParams* params, EPCostEstimate* out) {
+        *out = EPCostEstimate();
+        if (!validPoint(*params)) return EP_STATUS_INVALID_PARAMS;
+        double width_re, width_im;
+        widths(*params, width_re, width_im);
+        estimate(params->M, params->N, params->SNR, width_re, width_im, low_snr_series(*params), out);
+        return EP_STATUS_OK;
+    }
+
+    int ep_estimate_custom_cost(const EPCustomParams* params, EPCostEstimate* out) {
+        *out = EPCostEstimate();
+        if (!validPoint(*params)) return EP_STATUS_INVALID_PARAMS;
+        double width_re, width_im;
+        widths(*params, width_re, width_im);
+        estimate(params->num_points, params->N, params->SNR, width_re, width_im, low_snr_series(*params), out);
+        return EP_STATUS_OK;
+    }
+
+}
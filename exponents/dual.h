@@ -0,0 +1,139 @@
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <array>
+#include <cmath>
+
+// Forward-mode automatic differentiation.
+// Dual<T, N> carries a value and N partial derivatives of type T in fixed-size storage, so no
+// operation allocates. Gradients with more variables than N are taken in chunks of N seeded variables
+// (one pass each). T may itself be a Dual, so Dual<Dual<double, 1>, 1> seeded on the same variable
+// twice yields exact second derivatives.
+
+template <typename T, int N>
+struct Dual {
+    T v;
+    std::array<T, N> d;
+
+    Dual() : v(0.0) { d.fill(T(0.0)); }
+    Dual(double c) : v(c) { d.fill(T(0.0)); }
+
+    // variable number index (0 <= index < N); index < 0 or >= N gives a constant
+    static Dual variable(const T &value, int index) {
+        Dual x;
+        x.v = value;
+        if (index >= 0 && index < N) x.d[index] = T(1.0);
+        return x;
+    }
+};
+
+// value() strips every derivative level; for double it is the identity
+inline double value(double x) { return x; }
+
+template <typename T, int N>
+inline double value(const Dual<T, N> &x) { return value(x.v); }
+
+// out.d = ca * a.d + cb * b.d
+template <typename T, int N>
+inline void dual_combine(Dual<T, N> &out, const T &ca, const Dual<T, N> &a, const T &cb, const Dual<T, N> &b) {
+    for (int k = 0; k < N; k++) out.d[k] = ca * a.d[k] + cb * b.d[k];
+}
+
+template <typename T, int N>
+inline Dual<T, N> dual_chain(const Dual<T, N> &a, const T &value, const T &derivative) {
+    Dual<T, N> out;
+    out.v = value;
+    for (int k = 0; k < N; k++) out.d[k] = derivative * a.d[k];
+    return out;
+}
+
+template <typename T, int N>
+inline Dual<T, N> operator+(const Dual<T, N> &a, const Dual<T, N> &b) {
+    Dual<T, N> out;
+    out.v = a.v + b.v;
+    dual_combine(out, T(1.0), a, T(1.0), b);
+    return out;
+}
+
+template <typename T, int N>
+inline Dual<T, N> operator-(const Dual<T, N> &a, const Dual<T, N> &b) {
+    Dual<T, N> out;
+    out.v = a.v - b.v;
+    dual_combine(out, T(1.0), a, T(-1.0), b);
+    return out;
+}
+
+template <typename T, int N>
+inline Dual<T, N> operator*(const Dual<T, N> &a, const Dual<T, N> &b) {
+    Dual<T, N> out;
+    out.v = a.v * b.v;
+    dual_combine(out, b.v, a, a.v, b);
+    return out;
+}
+
+template <typename T, int N>
+inline Dual<T, N> operator/(const Dual<T, N> &a, const Dual<T, N> &b) {
+    Dual<T, N> out;
+    const T inv = T(1.0) / b.v;
+    out.v = a.v * inv;
+    dual_combine(out, inv, a, T(-1.0) * out.v * inv, b);
+    return out;
+}
+
+template <typename T, int N>
+inline Dual<T, N> operator-(const Dual<T, N> &a) { return dual_chain(a, T(-1.0) * a.v, T(-1.0)); }
+
+template <typename T, int N>
+inline Dual<T, N> operator+(const Dual<T, N> &a, double c) { return dual_chain(a, a.v + c, T(1.0)); }
+
+template <typename T, int N>
+inline Dual<T, N> operator+(double c, const Dual<T, N> &a) { return a + c; }
+
+template <typename T, int N>
+inline Dual<T, N> operator-(const Dual<T, N> &a, double c) { return dual_chain(a, a.v - c, T(1.0)); }
+
+template <typename T, int N>
+inline Dual<T, N> operator-(double c, const Dual<T, N> &a) { return dual_chain(a, c - a.v, T(-1.0)); }
+
+template <typename T, int N>
+inline Dual<T, N> operator*(const Dual<T, N> &a, double c) { return dual_chain(a, a.v * c, T(c)); }
+
+template <typename T, int N>
+inline Dual<T, N> operator*(double c, const Dual<T, N> &a) { return a * c; }
+
+template <typename T, int N>
+inline Dual<T, N> operator/(const Dual<T, N> &a, double c) { return a * (1.0 / c); }
+
+template <typename T, int N>
+inline Dual<T, N> operator/(double c, const Dual<T, N> &a) {
+    const T inv = T(1.0) / a.v;
+    return dual_chain(a, c * inv, T(-c) * inv * inv);
+}
+
+template <typename T, int N>
+inline Dual<T, N> &operator+=(Dual<T, N> &a, const Dual<T, N> &b) { return a = a + b; }
+
+template <typename T, int N>
+inline Dual<T, N> &operator*=(Dual<T, N> &a, const Dual<T, N> &b) { return a = a * b; }
+
+template <typename T, int N>
+inline Dual<T, N> exp(const Dual<T, N> &a) {
+    using std::exp;
+    const T e = exp(a.v);
+    return dual_chain(a, e, e);
+}
+
+template <typename T, int N>
+inline Dual<T, N> log(const Dual<T, N> &a) {
+    using std::log;
+    return dual_chain(a, log(a.v), T(1.0) / a.v);
+}
+
+template <typename T, int N>
+inline Dual<T, N> sqrt(const Dual<T, N> &a) {
+    using std::sqrt;
+    const T r = sqrt(a.v);
+    return dual_chain(a, r, T(0.5) / r);
+}
+
+#endif // DUAL_H
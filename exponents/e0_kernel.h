@@ -0,0 +1,96 @@
+#ifndef E0_KERNEL_H
+#define E0_KERNEL_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "dual.h"
+
+// Gallager E0(rho) in bits for the AWGN channel, templated on the scalar type: the dense quadrature
+// of E_0_co and of every derivative of it (E_0_co_derivatives, E_0_co_gradient, E_0_co_curvature,
+// E_0_cost). For each transmitted symbol a the n*n Gauss-Hermite nodes z_k are shifted around
+// sqrt(SNR) x_a; with s = 1/(1+rho) and D_ik = |sqrt(SNR) x_a + z_k - sqrt(SNR) x_i|^2,
+//   f_ak = sum_i Q_i exp(b_i - s D_ik) / exp(c_a - s D_ak),
+//   E0   = -log2( 1/pi * sum_a Q_a sum_k w_k f_ak^rho ),
+// where b and c are per-symbol tilts (Tilt::numerator(i), Tilt::denominator(a); zero for E_0_co).
+// Columns::relative(a, k, d) fills d[i] = D_ik - D_ak, either from D_mat or rebuilt from SNR and X,
+// so a Dual scalar differentiates with respect to rho, a tilt, SNR, Q or the points alike. The inner
+// sum is shifted by its largest exponent (a plain double, so derivatives are unaffected), which keeps
+// every SNR finite without a separate log-space path; with S = double it is native arithmetic.
+template <typename S, typename Vector, typename Tilt, typename Columns>
+S E_0_co(const S &rho, const Vector &Q, const Tilt &tilt, const Columns &columns, const std::vector<double> &weights) {
+    using std::exp;
+    using std::log;
+
+    const int M = static_cast<int>(Q.size());
+    const int nodes = static_cast<int>(weights.size());
+    const S s = 1.0 / (1.0 + rho);
+
+    std::vector<typename Columns::value_type> d(M);
+    std::vector<S> e(M);
+    S m(0.0);
+    for (int a = 0; a < M; a++) {
+        S inner(0.0);
+        for (int k = 0; k < nodes; k++) {
+            columns.relative(a, k, d.data());
+            double e_max = -INFINITY;
+            for (int i = 0; i < M; i++) {
+                e[i] = tilt.numerator(i) - tilt.denominator(a) - s * d[i];
+                e_max = std::max(e_max, value(e[i]));
+            }
+            S sum(0.0);
+            for (int i = 0; i < M; i++) {
+                sum += Q[i] * exp(e[i] - e_max);
+            }
+            inner += weights[k] * exp(rho * (log(sum) + e_max));
+        }
+        m += Q[a] * inner;
+    }
+    return -log(m / M_PI) / std::log(2.0);
+}
+
+// No tilt (E_0_co itself)
+struct NoTilt {
+    double numerator(int) const { return 0.0; }
+    double denominator(int) const { return 0.0; }
+};
+
+// Tilts b and c held per symbol
+template <typename S>
+struct SymbolTilt {
+    std::vector<S> b, c;
+    const S &numerator(int i) const { return b[i]; }
+    const S &denominator(int a) const { return c[a]; }
+};
+
+// Columns of a dense distance matrix (column-major, M rows, column a*nodes + k as setW fills D_mat)
+struct MatrixColumns {
+    typedef double value_type;
+    const double *D;
+    int M, nodes;
+
+    void relative(int a, int k, double *d) const {
+        const double *column = D + static_cast<size_t>(a * nodes + k) * M;
+        for (int i = 0; i < M; i++) d[i] = column[i] - column[a];
+    }
+};
+
+// Columns rebuilt from the points: with d = sqrt(SNR)(x_a - x_i), D_ik - D_ak = |d|^2 + 2 Re(d conj(z_k)),
+// node k = k1*n + k2 at z = roots[k1] + i roots[k2]
+template <typename S>
+struct PointColumns {
+    typedef S value_type;
+    std::vector<S> x_re, x_im; // sqrt(SNR) x_i
+    std::vector<double> roots;
+
+    void relative(int a, int k, S *d) const {
+        const int n = static_cast<int>(roots.size());
+        const double z_re = roots[k / n], z_im = roots[k % n];
+        for (int i = 0; i < static_cast<int>(x_re.size()); i++) {
+            const S dr = x_re[a] - x_re[i], di = x_im[a] - x_im[i];
+            d[i] = dr * dr + di * di + 2.0 * (dr * z_re + di * z_im);
+        }
+    }
+};
+
+#endif // E0_KERNEL_H
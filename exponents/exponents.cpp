@@ -1,67 +1,218 @@
 // exponents.cpp
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include "functions.h"
+#include "exponents.h"
 #include <iostream>
 #include <sstream>
 
-extern "C" {
+// The entry points below that index the dense D and PI matrices hold a DenseQuadratureScope for the
+// whole call, so tiled, global-grid and fast Gauss evaluation never leave them empty. When the
+// matrices would exceed the memory budget they return their count outputs as -1 (invalid) instead.
+static double* invalid_results(double* results, int count) {
+    std::fill(results, results + count, -1.0);
+    return results;
+}
 
-    // Custom constellation version
-    double* exponents_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, double n, double threshold, double* results) {
-        // Worker point assignment log - now handled in JavaScript layer
-        // std::ostringstream oss;
-        // oss << "[WORKER] CUSTOM: pts=" << num_points << " SNR=" << SNR << " N=" << N << "\n";
-        // std::cout << oss.str() << std::flush;
+// Runs optimize_input_distribution() on the constellation already set up and fills
+// results = {Pe, exponent, rho, I(X;Y), R0, R_crit, iterations, kkt_gap, scale}
+static double* optimized_distribution_results(double R, double rho_fixed, double N, double n, double threshold,
+                                              int max_iterations, double* q_out, double* results) {
+    DenseQuadratureScope dense;
+    setR(R);
+    setN(static_cast<int>(N));
+    if (!denseQuadratureSelected()) {
+        vector<double> Q = getQ();
+        for (size_t i = 0; i < Q.size(); i++) q_out[i] = Q[i];
+        return invalid_results(results, 9);
+    }
+    setPI();
+    setW();
 
-        int it = 20;
-        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
-        setR(R);
-        setSNR(SNR);
-        setN(static_cast<int>(N));
+    double rho = rho_fixed, kkt_gap, scale;
+    int iterations;
+    double exponent = optimize_input_distribution(rho_fixed, rho, max_iterations, threshold, iterations, kkt_gap, scale);
+
+    vector<double> Q = getQ();
+    for (size_t i = 0; i < Q.size(); i++) q_out[i] = Q[i];
 
-        // matrices
+    double grad_rho, e0;
+    E_0_co(R, 0, grad_rho, e0);
+    results[3] = grad_rho;  // I(X;Y) = E0'(0)
+    E_0_co(R, 1, grad_rho, e0);
+    results[4] = e0;        // R0 = E0(1)
+    results[5] = grad_rho;  // R_crit = E0'(1)
+
+    exponent = std::max(exponent, 0.0);
+    results[0] = (n * exponent > 1000) ? 0.0 : pow(2.0, -n * exponent);
+    results[1] = exponent;
+    results[2] = rho;
+    results[6] = iterations;
+    results[7] = kkt_gap;
+    results[8] = scale;
+    return results;
+}
+
+// Extends the results of exponents()/exponents_custom() for the channel still set up with
+// results[6] = dispersion V (bits^2) and results[7] = normal-approximation Pe at blocklength n
+static double* normal_approximation_results(double R, double n, double* results) {
+    if (results[1] < 0) { // invalid exponent marker
+        results[6] = -1.0;
+        results[7] = -1.0;
+        return results;
+    }
+    DenseQuadratureScope dense;
+    if (!denseQuadratureSelected()) {
+        results[6] = -1.0;
+        results[7] = -1.0;
+        return results;
+    }
+    // the exponent came from the series or a kernel without the matrices, the dispersion needs them
+    if (useLowSNRSeries() || getEvaluationMode() != EP_EVAL_DENSE) {
         setPI();
         setW();
+    }
+    double mutual_information;
+    const double dispersion = channel_dispersion(mutual_information);
+    results[6] = dispersion;
+    results[7] = normal_approximation(mutual_information, dispersion, R, n);
+    return results;
+}
 
-        double rho_gd, rho_interpolated;
-        double r;
-        double e0 = GD_iid(r, rho_gd, rho_interpolated, it, static_cast<int>(N), threshold);
-
-        // Check for invalid results
-        if (!std::isfinite(e0) || e0 < -0.5) {
-            std::cerr << "ERROR: Invalid error exponent E0 = " << e0
-                      << " (SNR=" << SNR << ", N=" << N << ")\n";
-            results[0] = -1.0;
-            results[1] = -1.0;
-            results[2] = rho_gd;
-            return results;
-        }
+// RCU saddlepoint approximation for the channel already set up, at each of the count blocklengths
+// n_values[k]; results = {rho_hat, E(R) = E0(rho_hat) - rho_hat*R, E0'(rho_hat), E0''(rho_hat)}
+static double* rcu_saddlepoint_results(double R, double N, const double* n_values, int count, double* pe_out, double* results) {
+    DenseQuadratureScope dense;
+    setN(static_cast<int>(N));
+    if (!denseQuadratureSelected()) {
+        invalid_results(pe_out, count);
+        return invalid_results(results, 4);
+    }
+    setPI();
+    setW();
 
-        // Clamp tiny negative values to 0
-        if (e0 < 0 && e0 > -0.5) {
-            std::cout << "INFO: Clamping tiny negative E0=" << e0 << " to 0 (floating point noise)\n";
-            e0 = 0.0;
-        }
+    double rho_hat, d1, d2;
+    const double e0 = rcu_saddlepoint_point(R, rho_hat, d1, d2);
+    for (int k = 0; k < count; k++) {
+        pe_out[k] = rcu_saddlepoint(n_values[k], R, rho_hat, e0, d1, d2);
+    }
+    results[0] = rho_hat;
+    results[1] = e0 - rho_hat * R;
+    results[2] = d1;
+    results[3] = d2;
+    return results;
+}
+
+// I(X;Y), R0 and R_crit of the constellation already set up at each of the count SNRs.
+// PI does not depend on the SNR and is built once; each point costs E0 at rho = 0 and rho = 1 only.
+static void channel_rates_curve(const double* snr_values, int count, double N, double* mi_out, double* r0_out, double* rcrit_out) {
+    DenseQuadratureScope dense;
+    setN(static_cast<int>(N));
+    if (!denseQuadratureSelected()) {
+        invalid_results(mi_out, count);
+        invalid_results(r0_out, count);
+        invalid_results(rcrit_out, count);
+        return;
+    }
+    setPI();
+    for (int k = 0; k < count; k++) {
+        setSNR(snr_values[k]);
+        channel_rates(mi_out[k], r0_out[k], rcrit_out[k]);
+    }
+}
 
-        // Compute error probability
-        double exponent = -n * e0;
-        if (exponent < -1000) {
-            results[0] = 0.0;
-            std::cout << "INFO: Error probability Pe < 1e-300 (underflow), setting to 0\n";
-        } else if (exponent > 0) {
-            std::cerr << "ERROR: Positive exponent in Pe calculation\n";
-            results[0] = 1.0;
-        } else {
-            results[0] = pow(2.0, exponent);
+// Solver part of exponents()/exponents_custom(), shared with the batch entry points (see exponents.h)
+int exponents_point(double SNR, double R, double N, double n, double threshold, bool& pi_ready, double* results, bool w_ready) {
+    int it = 20;
+    setR(R);
+    setSNR(SNR);
+    setN(static_cast<int>(N));
+
+    // matrices (not needed when the low-SNR series is accurate enough)
+    if (!useLowSNRSeries()) {
+        if (!pi_ready) {
+            setPI();
+            pi_ready = true;
         }
+        if (!w_ready) setW();
+    }
 
-        results[1] = e0;
+    double rho_gd, rho_interpolated;
+    double r;
+    double e0 = GD_iid(r, rho_gd, rho_interpolated, it, static_cast<int>(N), threshold);
+
+    // Check for invalid results
+    // Only treat significantly negative values (< -0.5) as errors
+    // Small negative values near 0 are floating point noise and should be clamped to 0
+    if (!std::isfinite(e0) || e0 < -0.5) {
+        std::cerr << "ERROR: Invalid error exponent E0 = " << e0
+                  << " (SNR=" << SNR << ", N=" << N << ")\n";
+        // Return special marker for invalid computation
+        results[0] = -1.0; // Marker: invalid Pe
+        results[1] = -1.0; // Marker: invalid E0
         results[2] = rho_gd;
-        results[3] = getMutualInformation();  // I(X;Y) = E0'(0)
-        results[4] = getCutoffRate();         // R0 = E0(1)
-        results[5] = getCriticalRate();       // R_crit = E0'(1)
+        return EP_STATUS_INVALID_EXPONENT;
+    }
+
+    // Clamp tiny negative values to 0 (floating point precision issues)
+    if (e0 < 0 && e0 > -0.5) {
+        std::cout << "INFO: Clamping tiny negative E0=" << e0 << " to 0 (floating point noise)\n";
+        e0 = 0.0;
+    }
+
+    // Compute error probability Pe = 2^(-n*e0)
+    // Check for underflow: if n*e0 > 1000, Pe < 2^(-1000) ≈ 1e-301 (near underflow)
+    double exponent = -n * e0;
+    if (exponent < -1000) {
+        // Severe underflow - Pe is effectively 0
+        results[0] = 0.0;  // Pe ≈ 0
+        std::cout << "INFO: Error probability Pe < 1e-300 (underflow), setting to 0\n";
+    } else if (exponent > 0) {
+        // This shouldn't happen (would mean E0 < 0)
+        std::cerr << "ERROR: Positive exponent in Pe calculation\n";
+        results[0] = 1.0;  // Safeguard
+    } else {
+        results[0] = pow(2.0, exponent);
+    }
+
+    results[1] = e0;                      // Error exponent
+    results[2] = rho_gd;                  // Optimal rho
+    results[3] = getMutualInformation();  // I(X;Y) = E0'(0)
+    results[4] = getCutoffRate();         // R0 = E0(1)
+    results[5] = getCriticalRate();       // R_crit = E0'(1)
+
+    return (!getSolverConverged() && solverStopRequested()) ? EP_STATUS_STOPPED : EP_STATUS_OK;
+}
+
+extern "C" {
+
+    void ep_set_memory_budget(size_t bytes) {
+        setDefaultMemoryBudget(bytes);
+    }
+
+    void ep_set_tiled_evaluation(int enabled, int kernel_threads) {
+        setDefaultTiledEvaluation(enabled != 0, kernel_threads);
+    }
+
+    void ep_set_global_grid_quadrature(int enabled) {
+        setDefaultGlobalGridQuadrature(enabled != 0);
+    }
+
+    void ep_set_fast_gauss_tolerance(double tolerance) {
+        setDefaultFastGaussTolerance(tolerance);
+    }
+
+    // Custom constellation version
+    double* exponents_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, double n, double threshold, double* results) {
+        // Worker point assignment log - now handled in JavaScript layer
+        // std::ostringstream oss;
+        // oss << "[WORKER] CUSTOM: pts=" << num_points << " SNR=" << SNR << " N=" << N << "\n";
+        // std::cout << oss.str() << std::flush;
 
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        bool pi_ready = false;
+        exponents_point(SNR, R, N, n, threshold, pi_ready, results);
         return results;
     }
 
@@ -71,62 +222,242 @@ extern "C" {
         // oss << "[WORKER] STANDARD: M=" << M << " " << typeM << " SNR=" << SNR << " N=" << N << "\n";
         // std::cout << oss.str() << std::flush;
 
-        int it = 20;
         setMod(static_cast<int>(M), typeM);
         setQ(std::string(distribution), shaping_param); // matrix Q with distribution
         normalizeX_for_Q(); // Renormalize X based on Q distribution
+        bool pi_ready = false;
+        exponents_point(SNR, R, N, n, threshold, pi_ready, results);
+        return results;
+    }
+
+    // exponents() plus the normal approximation; results must hold 8 doubles:
+    // {Pe, E0, rho, I(X;Y), R0, R_crit, V, Pe_normal}
+    double* exponents_normal(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results) {
+        exponents(M, typeM, SNR, R, N, n, threshold, distribution, shaping_param, results);
+        return normal_approximation_results(R, n, results);
+    }
+
+    // Same for a custom constellation
+    double* exponents_custom_normal(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, double n, double threshold, double* results) {
+        exponents_custom(real_parts, imag_parts, probabilities, num_points, SNR, R, N, n, threshold, results);
+        return normal_approximation_results(R, n, results);
+    }
+
+    // Saddlepoint approximation of the RCU bound at count blocklengths (pe_out holds count doubles).
+    // results must hold 4 doubles: {rho_hat, E(R), E0'(rho_hat), E0''(rho_hat)}
+    double* rcu_bound(double M, const char* typeM, double SNR, double R, double N, const char* distribution, double shaping_param, const double* n_values, int count, double* pe_out, double* results) {
+        setMod(static_cast<int>(M), typeM);
+        setQ(std::string(distribution), shaping_param);
+        normalizeX_for_Q();
         setR(R);
         setSNR(SNR);
-        setN(static_cast<int>(N));
+        return rcu_saddlepoint_results(R, N, n_values, count, pe_out, results);
+    }
+
+    // Same for a custom constellation
+    double* rcu_bound_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, const double* n_values, int count, double* pe_out, double* results) {
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setR(R);
+        setSNR(SNR);
+        return rcu_saddlepoint_results(R, N, n_values, count, pe_out, results);
+    }
+
+    // I(X;Y), cutoff rate R0 and critical rate R_crit (bits) at count SNRs; each output holds count doubles
+    void capacity_curve(double M, const char* typeM, const double* snr_values, int count, double N, const char* distribution, double shaping_param, double* mi_out, double* r0_out, double* rcrit_out) {
+        setMod(static_cast<int>(M), typeM);
+        setQ(std::string(distribution), shaping_param);
+        normalizeX_for_Q();
+        channel_rates_curve(snr_values, count, N, mi_out, r0_out, rcrit_out);
+    }
+
+    // Same for a custom constellation
+    void capacity_curve_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, const double* snr_values, int count, double N, double* mi_out, double* r0_out, double* rcrit_out) {
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        channel_rates_curve(snr_values, count, N, mi_out, r0_out, rcrit_out);
+    }
+
+    // Monte Carlo E0(rho) and E0'(rho) without the quadrature matrices (threads <= 0: all cores).
+    // results must hold 4 doubles: {E0, E0', 95% half-width of E0, 95% half-width of E0'}, all -1
+    // for samples < 1
+    double* e0_monte_carlo(double M, const char* typeM, double SNR, double rho, const char* distribution, double shaping_param, double samples, double seed, int threads, double* results) {
+        if (!(samples >= 1)) return invalid_results(results, 4);
+        setMod(static_cast<int>(M), typeM);
+        setQ(std::string(distribution), shaping_param);
+        normalizeX_for_Q();
+        setSNR(SNR);
+        results[0] = E_0_monte_carlo(rho, static_cast<long long>(samples), static_cast<uint64_t>(seed), threads, results[1], results[2], results[3]);
+        return results;
+    }
+
+    // Same for a custom constellation
+    double* e0_monte_carlo_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double samples, double seed, int threads, double* results) {
+        if (!(samples >= 1)) return invalid_results(results, 4);
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setSNR(SNR);
+        results[0] = E_0_monte_carlo(rho, static_cast<long long>(samples), static_cast<uint64_t>(seed), threads, results[1], results[2], results[3]);
+        return results;
+    }
 
-        // matrices
+    // Input distribution optimization for a standard constellation: maximizes E(R) over Q when rho <= 0,
+    // or E0(rho) - rho*R at the given rho otherwise, at constant average power.
+    // q_out must hold M doubles; results must hold 9 doubles
+    double* optimize_distribution(double M, const char* typeM, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* q_out, double* results) {
+        setMod(static_cast<int>(M), typeM);
+        setQ("uniform");
+        normalizeX_for_Q();
+        setSNR(SNR);
+        return optimized_distribution_results(R, rho, N, n, threshold, max_iterations, q_out, results);
+    }
+
+    // Same for a custom constellation, starting from the given probabilities
+    double* optimize_distribution_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* q_out, double* results) {
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setSNR(SNR);
+        return optimized_distribution_results(R, rho, N, n, threshold, max_iterations, q_out, results);
+    }
+
+    // Maxwell-Boltzmann shaping optimization: finds the beta in [beta_lo, beta_hi] maximizing
+    // E(R) (objective "exponent") or I(X;Y) (objective "mutual-information"), starting from beta_start.
+    // q_out must hold M doubles; results = {Pe, E(R), rho, I(X;Y), R0, R_crit, beta, evaluations}
+    double* optimize_shaping(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* objective, double beta_lo, double beta_hi, double beta_start, double* q_out, double* results) {
+        int it = 20;
+        setMod(static_cast<int>(M), typeM);
+        setR(R);
+        setSNR(SNR);
+        setN(static_cast<int>(N));
         setPI();
-        setW();
+
+        double beta;
+        int evaluations;
+        optimize_shaping_parameter(std::string(objective), beta_lo, beta_hi, beta_start, threshold, 50, beta, evaluations);
+
+        vector<double> Q = getQ();
+        for (size_t i = 0; i < Q.size(); i++) q_out[i] = Q[i];
 
         double rho_gd, rho_interpolated;
         double r;
-        double e0 = GD_iid(r, rho_gd, rho_interpolated, it, static_cast<int>(N), threshold);
-
-        // Check for invalid results
-        // Only treat significantly negative values (< -0.5) as errors
-        // Small negative values near 0 are floating point noise and should be clamped to 0
-        if (!std::isfinite(e0) || e0 < -0.5) {
-            std::cerr << "ERROR: Invalid error exponent E0 = " << e0
-                      << " (SNR=" << SNR << ", N=" << N << ")\n";
-            // Return special marker for invalid computation
-            results[0] = -1.0; // Marker: invalid Pe
-            results[1] = -1.0; // Marker: invalid E0
-            results[2] = rho_gd;
-            return results;
+        double e0 = std::max(GD_iid(r, rho_gd, rho_interpolated, it, static_cast<int>(N), threshold), 0.0);
+
+        results[0] = (n * e0 > 1000) ? 0.0 : pow(2.0, -n * e0);
+        results[1] = e0;
+        results[2] = rho_gd;
+        results[3] = getMutualInformation();
+        results[4] = getCutoffRate();
+        results[5] = getCriticalRate();
+        results[6] = beta;
+        results[7] = evaluations;
+        return results;
+    }
+
+    // Gradient of E0(rho) with respect to each point of a custom constellation.
+    // grad_real/grad_imag must hold num_points doubles; results = {E0}
+    double* e0_constellation_gradient(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double N, double* grad_real, double* grad_imag, double* results) {
+        DenseQuadratureScope dense;
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setSNR(SNR);
+        setN(static_cast<int>(N));
+        if (!denseQuadratureSelected()) {
+            std::fill(grad_real, grad_real + num_points, 0.0);
+            std::fill(grad_imag, grad_imag + num_points, 0.0);
+            return invalid_results(results, 1);
+        }
+        setPI();
+        setW();
+
+        vector<complex<double>> grad;
+        results[0] = gradient_E0_constellation(rho, grad);
+        for (int i = 0; i < num_points; i++) {
+            grad_real[i] = grad[i].real();
+            grad_imag[i] = grad[i].imag();
+        }
+        return results;
+    }
+
+    // Cost-constrained random-coding exponent (input cost |x|^2 - E_Q|X|^2 tilted by r).
+    // results = {Pe, exponent, rho, r}
+    double* exponents_cost_constrained(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results) {
+        DenseQuadratureScope dense;
+        setMod(static_cast<int>(M), typeM);
+        setQ(std::string(distribution), shaping_param);
+        normalizeX_for_Q();
+        setR(R);
+        setSNR(SNR);
+        setN(static_cast<int>(N));
+        if (!denseQuadratureSelected()) return invalid_results(results, 4);
+        setPI();
+        setW();
+
+        double r, rho;
+        double exponent = std::max(E_cost_constrained(r, rho, 50, threshold), 0.0);
+
+        results[0] = (n * exponent > 1000) ? 0.0 : pow(2.0, -n * exponent);
+        results[1] = exponent;
+        results[2] = rho;
+        results[3] = r;
+        return results;
+    }
+
+    // Exact derivatives of E0(rho) for a custom constellation (forward-mode automatic differentiation).
+    // grad_Q/grad_real/grad_imag must hold num_points doubles (partials wrt Q_i, Re x_i, Im x_i);
+    // results = {E0, dE0/drho, d2E0/drho2, dE0/dSNR}
+    double* e0_derivatives_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double N, double* grad_Q, double* grad_real, double* grad_imag, double* results) {
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setSNR(SNR);
+        setN(static_cast<int>(N));
+
+        vector<double> d_Q;
+        vector<complex<double>> d_X;
+        results[0] = E_0_co_gradient(rho, results[1], results[3], d_Q, d_X);
+        double d_rho;
+        E_0_co_curvature(rho, d_rho, results[2]);
+        for (int i = 0; i < num_points; i++) {
+            grad_Q[i] = d_Q[i];
+            grad_real[i] = d_X[i].real();
+            grad_imag[i] = d_X[i].imag();
         }
+        return results;
+    }
 
-        // Clamp tiny negative values to 0 (floating point precision issues)
-        if (e0 < 0 && e0 > -0.5) {
-            std::cout << "INFO: Clamping tiny negative E0=" << e0 << " to 0 (floating point noise)\n";
-            e0 = 0.0;
+    // Constellation geometry optimization: moves the points of a custom constellation to maximize
+    // E(R) (rho <= 0) or E0(rho) - rho*R (rho > 0) at constant average power.
+    // real_out/imag_out must hold num_points doubles;
+    // results = {Pe, exponent, rho, I(X;Y), R0, R_crit, iterations, gradient norm}
+    double* optimize_constellation(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* real_out, double* imag_out, double* results) {
+        DenseQuadratureScope dense;
+        setCustomConstellation(real_parts, imag_parts, probabilities, num_points);
+        setR(R);
+        setSNR(SNR);
+        setN(static_cast<int>(N));
+        if (!denseQuadratureSelected()) {
+            std::copy(real_parts, real_parts + num_points, real_out);
+            std::copy(imag_parts, imag_parts + num_points, imag_out);
+            return invalid_results(results, 8);
         }
+        setPI();
+        setW();
+
+        double rho_opt = rho, grad_norm;
+        int iterations;
+        double exponent = std::max(optimize_constellation_geometry(rho, rho_opt, max_iterations, threshold, iterations, grad_norm), 0.0);
 
-        // Compute error probability Pe = 2^(-n*e0)
-        // Check for underflow: if n*e0 > 1000, Pe < 2^(-1000) ≈ 1e-301 (near underflow)
-        double exponent = -n * e0;
-        if (exponent < -1000) {
-            // Severe underflow - Pe is effectively 0
-            results[0] = 0.0;  // Pe ≈ 0
-            std::cout << "INFO: Error probability Pe < 1e-300 (underflow), setting to 0\n";
-        } else if (exponent > 0) {
-            // This shouldn't happen (would mean E0 < 0)
-            std::cerr << "ERROR: Positive exponent in Pe calculation\n";
-            results[0] = 1.0;  // Safeguard
-        } else {
-            results[0] = pow(2.0, exponent);
+        vector<complex<double>> X_opt = getX();
+        for (int i = 0; i < num_points; i++) {
+            real_out[i] = X_opt[i].real();
+            imag_out[i] = X_opt[i].imag();
         }
 
-        results[1] = e0;                      // Error exponent
-        results[2] = rho_gd;                  // Optimal rho
-        results[3] = getMutualInformation();  // I(X;Y) = E0'(0)
-        results[4] = getCutoffRate();         // R0 = E0(1)
-        results[5] = getCriticalRate();       // R_crit = E0'(1)
+        double grad_rho, e0;
+        E_0_co(R, 0, grad_rho, e0);
+        results[3] = grad_rho;  // I(X;Y) = E0'(0)
+        E_0_co(R, 1, grad_rho, e0);
+        results[4] = e0;        // R0 = E0(1)
+        results[5] = grad_rho;  // R_crit = E0'(1)
 
+        results[0] = (n * exponent > 1000) ? 0.0 : pow(2.0, -n * exponent);
+        results[1] = exponent;
+        results[2] = rho_opt;
+        results[6] = iterations;
+        results[7] = grad_norm;
         return results;
     }
 }
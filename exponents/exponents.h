@@ -0,0 +1,282 @@
+#ifndef EXPONENTS_H
+#define EXPONENTS_H
+
+#include <stddef.h>
+
+// C interface of libfunctions for callers that evaluate many points per call.
+// The single-point entry points (exponents(), exponents_custom(), ...) are defined in exponents.cpp
+// and take their arguments as plain doubles and C strings.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum EPModulation {
+    EP_MOD_PAM = 0,
+    EP_MOD_PSK = 1,
+    EP_MOD_QAM = 2
+} EPModulation;
+
+typedef enum EPDistribution {
+    EP_DIST_UNIFORM = 0,
+    EP_DIST_MAXWELL_BOLTZMANN = 1
+} EPDistribution;
+
+typedef enum EPStatus {
+    EP_STATUS_OK = 0,
+    EP_STATUS_INVALID_PARAMS = 1,  // rejected before any computation
+    EP_STATUS_INVALID_EXPONENT = 2, // non-finite or significantly negative E0 (Pe = E0 = -1)
+    EP_STATUS_FAILED = 3,           // exception inside the engine
+    EP_STATUS_CANCELLED = 4,        // cancelled or past the deadline before the point started (Pe = E0 = -1)
+    EP_STATUS_STOPPED = 5           // cancelled or past the deadline while solving: last iterate, converged = 0
+} EPStatus;
+
+// How the E0 kernel ran for a point
+typedef enum EPEvaluationMode {
+    EP_EVAL_DENSE = 0,          // D and PI matrices in memory
+    EP_EVAL_STREAMING = 1,      // over the memory budget: tiled kernel, no D or PI matrices
+    EP_EVAL_LOW_SNR_SERIES = 2, // second-order SNR expansion, no quadrature
+    EP_EVAL_TILED = 3,          // within budget, tiled kernel requested: columns generated per symbol from factorized tables
+    EP_EVAL_GLOBAL_GRID = 4,    // one lattice of received points shared by all symbols (no per-symbol grids)
+    EP_EVAL_FAST_GAUSS = 5      // inner symbol sums from a fast Gauss transform (large constellations)
+} EPEvaluationMode;
+
+// Cancellation flag shared between the host and the worker threads (opaque, safe to set from any thread)
+typedef struct EPCancelToken EPCancelToken;
+
+// One point of exponents(): modulation is an EPModulation, distribution an EPDistribution
+// (shaping_param is the Maxwell-Boltzmann beta), N the number of quadrature nodes per dimension
+typedef struct EPParams {
+    int M;
+    int modulation;
+    int distribution;
+    int N;
+    double shaping_param;
+    double SNR;
+    double R;
+    double n;
+    double threshold;
+} EPParams;
+
+// One point of exponents_custom(); points sharing the same three arrays share their setup
+typedef struct EPCustomParams {
+    const double* real_parts;
+    const double* imag_parts;
+    const double* probabilities;
+    int num_points;
+    int N;
+    double SNR;
+    double R;
+    double n;
+    double threshold;
+} EPCustomParams;
+
+// Same fields as the results array of exponents(), plus an EPStatus and the index of the point
+typedef struct EPResult {
+    double Pe;
+    double E0;
+    double rho;
+    double mutual_information;  // I(X;Y) = E0'(0)
+    double cutoff_rate;         // R0 = E0(1)
+    double critical_rate;       // R_crit = E0'(1)
+    int status;
+    int converged;              // 0 when the solver stopped early or ran out of iterations
+    int evaluation_mode;        // EPEvaluationMode
+    size_t index;               // position in params
+} EPResult;
+
+// Receives each point as soon as it is solved (result points into the results array, which is
+// already filled for that index). Called from the worker threads in completion order, but never
+// concurrently, so the callback needs no locking of its own.
+typedef void (*EPResultCallback)(size_t index, const EPResult* result, void* user_data);
+
+// Counters of one batch worker
+typedef struct EPThreadStats {
+    double busy_ms;             // time spent setting up and solving its chunks
+    double utilisation;         // busy_ms / wall_ms of the batch
+    size_t points;              // points solved
+    size_t chunks;              // chunks run, including stolen ones
+    size_t stolen;              // chunks taken from another worker's queue
+    size_t setups;              // constellation setups (a chunk sharing the held setup needs none)
+} EPThreadStats;
+
+// Filled when the batch returns; per_thread may be NULL, otherwise it receives
+// min(threads, per_thread_capacity) entries
+typedef struct EPBatchStats {
+    double wall_ms;
+    int threads;                // workers used
+    EPThreadStats* per_thread;
+    int per_thread_capacity;
+} EPBatchStats;
+
+// options may be NULL for the defaults
+typedef struct EPBatchOptions {
+    int threads;                // worker threads, <= 0: all cores
+    EPResultCallback on_result; // optional
+    void* user_data;            // passed to on_result
+    EPCancelToken* cancel;      // optional; checked between points and between E0 evaluations
+    double timeout_ms;          // deadline relative to the call, <= 0: none
+    EPBatchStats* stats;        // optional
+    size_t memory_budget;       // bytes per worker for the quadrature matrices, 0: ep_set_memory_budget's
+    int tiled;                  // 1: tiled kernel for every point, 0: ep_set_tiled_evaluation's
+    int kernel_threads;         // threads per E0 evaluation of each worker, 0: ep_set_tiled_evaluation's
+    int global_grid;            // 1: shared y-grid quadrature for every point, 0: ep_set_global_grid_quadrature's
+    double fast_gauss_tolerance; // in (0, 1): fast Gauss transform at this tolerance, else ep_set_fast_gauss_tolerance's
+} EPBatchOptions;
+
+// Evaluates count points into results[0..count). Points with the same constellation, distribution
+// and N share setMod/setQ/setPI; the groups are cut into chunks of similar predicted cost and run by
+// a pool of worker threads that steal chunks from each other's queues, most expensive first.
+void exponents_batch(const EPParams* params, size_t count, EPResult* results, const EPBatchOptions* options);
+void exponents_custom_batch(const EPCustomParams* params, size_t count, EPResult* results, const EPBatchOptions* options);
+
+// Predicted cost of one point on one thread, in the evaluation mode it would run in under the calling
+// thread's settings (ep_set_memory_budget, ep_set_tiled_evaluation, ep_set_global_grid_quadrature,
+// ep_set_fast_gauss_tolerance; a batch applies its options first)
+typedef struct EPCostEstimate {
+    double time_ms;             // setup and solve
+    double peak_bytes;          // quadrature buffers of that mode and E_0_co temporaries
+    double streaming_peak_bytes; // the same with the tiled kernel (EP_EVAL_STREAMING / EP_EVAL_TILED)
+    double evaluations;         // E_0_co calls
+    int evaluation_mode;        // EPEvaluationMode the estimate is for
+} EPCostEstimate;
+
+// Coefficients of the cost model, measured on this machine. With cells = M^2 N^2 (M G^2 on a global
+// grid of G x G points):
+//   dense:  time_ms = overhead_ms + cells * (setup_ns_per_cell + evaluations * eval_ns_per_cell) / 1e6
+//   tiled:  time_ms = overhead_ms + cells * evaluations * tiled_ns_per_cell / 1e6 (also streaming, and
+//           fast Gauss, which never runs slower than the tiled kernel it falls back to)
+//   grid:   time_ms = overhead_ms + cells * evaluations * grid_ns_per_cell / 1e6
+//   low-SNR series: time_ms = overhead_ms, with no quadrature buffers (peak_bytes = 0)
+typedef struct EPCostModel {
+    double setup_ns_per_cell;   // setPI + setW
+    double eval_ns_per_cell;    // one dense E_0_co call
+    double tiled_ns_per_cell;   // one E_0_co_tiled call on one thread
+    double grid_ns_per_cell;    // one E_0_co_global_grid call
+    double evaluations;         // E_0_co calls per solve
+    double overhead_ms;         // fixed cost of a point
+    double calibration_ms;      // time the microbenchmark took
+} EPCostModel;
+
+// The model is calibrated by a ~0.1 s microbenchmark on first use; ep_calibrate_cost_model runs it
+// now (e.g. at startup, or again after the machine load changed). out may be NULL.
+void ep_calibrate_cost_model(EPCostModel* out);
+void ep_get_cost_model(EPCostModel* out);
+
+// Return EP_STATUS_OK or EP_STATUS_INVALID_PARAMS (estimate zeroed)
+int ep_estimate_cost(const EPParams* params, EPCostEstimate* estimate);
+int ep_estimate_custom_cost(const EPCustomParams* params, EPCostEstimate* estimate);
+
+// Process-wide memory budget (bytes, 0: none) of the quadrature matrices for every call without its
+// own, including exponents() and exponents_custom(); points over it run in EP_EVAL_STREAMING mode.
+// The entry points built on the dense matrices (capacity_curve, the dispersion of exponents_normal,
+// rcu_bound, optimize_distribution, optimize_constellation, e0_constellation_gradient and
+// exponents_cost_constrained) return -1 outputs over it; the tiled, global-grid and fast Gauss modes
+// below do not apply to them.
+void ep_set_memory_budget(size_t bytes);
+
+// Process-wide default of the tiled kernel (enabled != 0: every point runs in EP_EVAL_TILED mode
+// rather than dense) and of the threads each E0 evaluation splits its tiles over (<= 0: all cores;
+// the initial default is 1). Worker threads of a batch multiply with kernel_threads.
+void ep_set_tiled_evaluation(int enabled, int kernel_threads);
+
+// Process-wide default of the quadrature: enabled != 0 integrates over one lattice of received points
+// shared by all symbols (EP_EVAL_GLOBAL_GRID), spaced from its error bound to within 1e-7 bits
+// whatever N; 0 keeps the N x N Gauss-Hermite grid around each symbol
+void ep_set_global_grid_quadrature(int enabled);
+
+// Process-wide default of the fast Gauss transform (0, or 1 and more: off). With a tolerance in (0, 1),
+// points whose constellation has 64 or more symbols evaluate the inner sums
+// sum_i Q_i exp(-s |y - x_i|^2) to that absolute error by an improved fast Gauss transform
+// (EP_EVAL_FAST_GAUSS), which pays off for large irregular custom constellations.
+void ep_set_fast_gauss_tolerance(double tolerance);
+
+// Custom constellation edited between solves, e.g. by dragging points in an editor. The session keeps
+// the dense distance matrix of its last solve, so moving a point recomputes only its O(M N^2)
+// distances instead of all O(M^2 N^2) of them. Adding or removing one also computes no other
+// distance, but copies the rest of the matrix into its new shape (an O(M^2 N^2) memcpy). Each solve
+// starts from the previous optimal rho. The probabilities are normalized to sum to one at every solve. Calls on one session
+// must not overlap; different sessions are independent.
+typedef struct EPSession EPSession;
+
+// NULL when num_points < 1 or an array is NULL
+EPSession* ep_session_create(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points);
+void ep_session_destroy(EPSession* session);
+int ep_session_size(const EPSession* session);
+
+// Return EP_STATUS_OK, or EP_STATUS_INVALID_PARAMS for an index out of range, a negative probability
+// or removing the last point
+int ep_session_move_point(EPSession* session, int index, double real, double imag);
+int ep_session_set_probability(EPSession* session, int index, double probability);
+int ep_session_add_point(EPSession* session, double real, double imag, double probability);
+int ep_session_remove_point(EPSession* session, int index);
+
+// One point as in exponents_custom_batch (options may be NULL; threads, on_result and stats are
+// ignored); returns result->status
+int ep_session_solve(EPSession* session, double SNR, double R, int N, double n, double threshold,
+                     const EPBatchOptions* options, EPResult* result);
+
+// One level of a progressive evaluation: the point solved with N quadrature nodes per dimension
+typedef struct EPProgressiveResult {
+    EPResult result;
+    int N;
+    int level;                  // 0 for the coarse solve
+    double error_estimate;      // |E0 - E0 at the previous, coarser N| (bits), < 0: no valid coarser solve
+    int final;                  // 1 for the last level: the tolerance or params N was reached, or the call stopped
+} EPProgressiveResult;
+
+// Receives each level as soon as it is solved, from the calling thread
+typedef void (*EPProgressiveCallback)(const EPProgressiveResult* level, void* user_data);
+
+// options may be NULL for the defaults
+typedef struct EPProgressiveOptions {
+    int initial_N;              // N of the coarse solve, <= 0: 5
+    double growth;              // N of the next level = growth * N (at least N + 2), <= 1: 2
+    double tolerance;           // stop once error_estimate <= tolerance, <= 0: only at params N
+    EPProgressiveCallback on_level; // optional
+    void* user_data;            // passed to on_level
+} EPProgressiveOptions;
+
+// Solves one point at increasing N up to params->N, each level warm-started from the optimal rho
+// of the one before, and reports every level through options->on_level. The coarse level's error
+// estimate comes from a pilot solve at initial_N - 2 nodes, which is not reported. call carries the
+// cancel token, deadline and evaluation settings as for a batch (may be NULL; threads, on_result
+// and stats are ignored). Fills result with the last level and returns its status.
+int exponents_progressive(const EPParams* params, const EPProgressiveOptions* options, const EPBatchOptions* call,
+                          EPProgressiveResult* result);
+int exponents_custom_progressive(const EPCustomParams* params, const EPProgressiveOptions* options,
+                                 const EPBatchOptions* call, EPProgressiveResult* result);
+
+EPCancelToken* ep_cancel_token_create(void);
+void ep_cancel_token_cancel(EPCancelToken* token);
+int ep_cancel_token_is_cancelled(const EPCancelToken* token);
+void ep_cancel_token_destroy(EPCancelToken* token);
+
+#ifdef __cplusplus
+}
+
+#include <chrono>
+
+// GD_iid at (SNR, R) for the constellation already set up in this thread; fills
+// results = {Pe, E0, rho, I(X;Y), R0, R_crit} and returns EP_STATUS_OK, EP_STATUS_INVALID_EXPONENT or
+// EP_STATUS_STOPPED (see setSolverStop). pi_ready tells whether PI_mat already matches the
+// constellation size and N; it is set once built. w_ready skips setW when D_mat already matches the
+// constellation, SNR and N (see exchangeQuadrature).
+int exponents_point(double SNR, double R, double N, double n, double threshold, bool& pi_ready, double* results,
+                    bool w_ready = false);
+
+// Whether a point can be set up, and its setup (setMod/setQ/normalizeX_for_Q or
+// setCustomConstellation) in the calling thread, as the batch workers do it (batch.cpp)
+bool validPoint(const EPParams& p);
+bool validPoint(const EPCustomParams& p);
+void setupPoint(const EPParams& p);
+void setupPoint(const EPCustomParams& p);
+
+// Cancel token, deadline (timeout_ms after start) and evaluation settings of options (may be NULL)
+// for the calling thread, as every batch worker applies them; resetCallOptions restores the process
+// defaults
+void applyCallOptions(const EPBatchOptions* options, std::chrono::steady_clock::time_point start);
+void resetCallOptions();
+#endif
+
+#endif // EXPONENTS_H
@@ -0,0 +1,174 @@
+// fast_gauss.cpp
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "fast_gauss.h"
+
+namespace {
+
+// clusters of at most this fraction of h keep the Taylor order low (about 17 terms per axis at 1e-8)
+const double CLUSTER_RADIUS = 0.25;
+const int MAX_ORDER = 40;
+const int MAX_GRID_CELLS = 1024; // per axis
+
+int clamp_index(double v, int count) {
+    return std::max(0, std::min(count - 1, static_cast<int>(std::floor(v))));
+}
+
+// sum_(a+b<order) C_(a,b) u_re^a u_im^b, Horner in both variables
+double taylor(const double* C, int order, std::complex<double> u) {
+    double poly = 0.0;
+    for (int a = order - 1; a >= 0; a--) {
+        const size_t row_start = static_cast<size_t>(a) * order - static_cast<size_t>(a) * (a - 1) / 2;
+        double inner = 0.0;
+        for (int b = order - 1 - a; b >= 0; b--) inner = inner * u.imag() + C[row_start + b];
+        poly = poly * u.real() + inner;
+    }
+    return poly;
+}
+
+} // namespace
+
+FastGaussTransform::FastGaussTransform(const std::vector<std::complex<double>>& sources, const std::vector<double>& weights,
+                                       double h_, double tolerance) : h(h_) {
+    const int M = static_cast<int>(sources.size());
+
+    // farthest-point clustering: add the source farthest from every center until all are within
+    // CLUSTER_RADIUS * h of theirs
+    std::vector<int> center_of(M, 0), seeds = {0};
+    std::vector<double> dist(M);
+    for (int i = 0; i < M; i++) dist[i] = std::abs(sources[i] - sources[0]);
+    double r_x = 0.0;
+    while (true) {
+        const int far = static_cast<int>(std::max_element(dist.begin(), dist.end()) - dist.begin());
+        r_x = dist[far];
+        if (r_x <= CLUSTER_RADIUS * h) break;
+        const int c = static_cast<int>(seeds.size());
+        seeds.push_back(far);
+        for (int i = 0; i < M; i++) {
+            const double d = std::abs(sources[i] - sources[far]);
+            if (d < dist[i]) {
+                dist[i] = d;
+                center_of[i] = c;
+            }
+        }
+    }
+
+    // a source beyond r_y of a center contributes less than exp(-(r_y - r_x)^2 / h^2) = tolerance per
+    // unit weight; the Taylor remainder within r_y is below (2^p / p!) (r_x r_y / h^2)^p
+    r_y = r_x + h * std::sqrt(std::log(1.0 / tolerance));
+    p = 1;
+    for (double bound = 2.0 * r_x * r_y / (h * h); bound > tolerance && p < MAX_ORDER; p++) {
+        bound *= 2.0 * r_x * r_y / (h * h * (p + 1));
+    }
+
+    std::vector<std::vector<int>> members(seeds.size());
+    for (int i = 0; i < M; i++) members[center_of[i]].push_back(i);
+
+    // C_(a,b) = 2^(a+b) / (a! b!) sum_i q_i exp(-|v_i|^2) v_i,re^a v_i,im^b, v_i = (x_i - c) / h, and
+    // the same with q_i times v_i,re, v_i,im and |v_i|^2 for distance()
+    std::vector<double> scale(p), pw_re(p), pw_im(p);
+    scale[0] = 1.0;
+    for (int a = 1; a < p; a++) scale[a] = scale[a - 1] * 2.0 / a;
+    for (size_t c = 0; c < seeds.size(); c++) {
+        const std::complex<double> center = sources[seeds[c]];
+        const bool single = members[c].size() == 1;
+        const int order = single ? 1 : p;
+        const size_t terms = order * (order + 1) / 2;
+        centers.push_back(center);
+        info.push_back({order, coeffs.size()});
+        coeffs.resize(coeffs.size() + MOMENTS * terms, 0.0);
+        double* C = &coeffs[info.back().offset];
+
+        for (int i: members[c]) {
+            const std::complex<double> v = (sources[i] - center) / h;
+            const double e = weights[i] * std::exp(-std::norm(v));
+            const double moment[MOMENTS] = {1.0, v.real(), v.imag(), std::norm(v)};
+            pw_re[0] = pw_im[0] = 1.0;
+            for (int a = 1; a < order; a++) {
+                pw_re[a] = pw_re[a - 1] * v.real();
+                pw_im[a] = pw_im[a - 1] * v.imag();
+            }
+            for (int a = 0, k = 0; a < order; a++) {
+                for (int b = 0; a + b < order; b++, k++) {
+                    for (int m = 0; m < MOMENTS; m++) C[m * terms + k] += e * moment[m] * pw_re[a] * pw_im[b];
+                }
+            }
+        }
+        for (int a = 0, k = 0; a < order; a++) {
+            for (int b = 0; a + b < order; b++, k++) {
+                for (int m = 0; m < MOMENTS; m++) C[m * terms + k] *= scale[a] * scale[b];
+            }
+        }
+    }
+
+    double lo_re = std::numeric_limits<double>::infinity(), lo_im = lo_re, hi_re = -lo_re, hi_im = -lo_re;
+    for (const auto& c: centers) {
+        lo_re = std::min(lo_re, c.real());
+        hi_re = std::max(hi_re, c.real());
+        lo_im = std::min(lo_im, c.imag());
+        hi_im = std::max(hi_im, c.imag());
+    }
+    cell = std::max({r_y, (hi_re - lo_re) / MAX_GRID_CELLS, (hi_im - lo_im) / MAX_GRID_CELLS});
+    grid_re = lo_re;
+    grid_im = lo_im;
+    grid_cols = static_cast<int>((hi_re - lo_re) / cell) + 1;
+    grid_rows = static_cast<int>((hi_im - lo_im) / cell) + 1;
+    buckets.assign(static_cast<size_t>(grid_cols) * grid_rows, {});
+    for (int c = 0; c < clusters(); c++) {
+        const int col = clamp_index((centers[c].real() - grid_re) / cell, grid_cols);
+        const int row = clamp_index((centers[c].imag() - grid_im) / cell, grid_rows);
+        buckets[static_cast<size_t>(row) * grid_cols + col].push_back(c);
+    }
+}
+
+// visit(k, u) for every cluster k whose center lies within r_y of y, with u = (y - center) / h
+template <typename Visit>
+void FastGaussTransform::for_clusters_near(std::complex<double> y, Visit visit) const {
+    const double fx = (y.real() - grid_re) / cell, fy = (y.imag() - grid_im) / cell;
+    // cells further than one from the grid hold no cluster within r_y
+    if (fx < -1.0 || fy < -1.0 || fx >= grid_cols + 1.0 || fy >= grid_rows + 1.0) return;
+    const int col = static_cast<int>(std::floor(fx)), row = static_cast<int>(std::floor(fy));
+    for (int r = std::max(0, row - 1); r <= std::min(grid_rows - 1, row + 1); r++) {
+        for (int c = std::max(0, col - 1); c <= std::min(grid_cols - 1, col + 1); c++) {
+            for (int k: buckets[static_cast<size_t>(r) * grid_cols + c]) {
+                const std::complex<double> u = (y - centers[k]) / h;
+                if (std::norm(u) * h * h <= r_y * r_y) visit(k, u);
+            }
+        }
+    }
+}
+
+double FastGaussTransform::operator()(std::complex<double> y) const {
+    double G = 0.0;
+    for_clusters_near(y, [&](int k, std::complex<double> u) {
+        G += std::exp(-std::norm(u)) * taylor(&coeffs[info[k].offset], info[k].order, u);
+    });
+    return G;
+}
+
+// With u = (y - c) / h, |y - x_i|^2 / h^2 = |u|^2 - 2 (u_re v_i,re + u_im v_i,im) + |v_i|^2, so each
+// cluster contributes its four expansions combined by the same powers of u
+double FastGaussTransform::distance(std::complex<double> y, double& G) const {
+    double GD = 0.0;
+    G = 0.0;
+    for_clusters_near(y, [&](int k, std::complex<double> u) {
+        const int order = info[k].order;
+        const size_t terms = order * (order + 1) / 2;
+        const double* C = &coeffs[info[k].offset];
+        const double g = taylor(C, order, u);
+        const double e = std::exp(-std::norm(u));
+        G += e * g;
+        GD += e * (std::norm(u) * g - 2.0 * (u.real() * taylor(C + terms, order, u) + u.imag() * taylor(C + 2 * terms, order, u)) +
+                   taylor(C + 3 * terms, order, u));
+    });
+    return h * h * GD;
+}
+
+double FastGaussTransform::work(std::complex<double> y) const {
+    double terms = 0.0;
+    for_clusters_near(y, [&](int k, std::complex<double>) {
+        terms += info[k].order * (info[k].order + 1) / 2;
+    });
+    return terms;
+}
@@ -0,0 +1,58 @@
+#ifndef FAST_GAUSS_H
+#define FAST_GAUSS_H
+
+#include <complex>
+#include <vector>
+
+// Improved fast Gauss transform (Yang, Duraiswami and Davis; error bounds of Raykar et al.) in the
+// plane:
+//   G(y) = sum_i q_i exp(-|y - x_i|^2 / h^2)
+// to within tolerance * sum_i q_i at every target y. The sources are grouped by farthest-point
+// clustering into clusters of radius r_x <= h / 4; each cluster keeps the Taylor coefficients of
+// exp(2 (y - c).(x - c) / h^2) up to total degree p, and a target only visits the clusters whose
+// center lies within r_y = r_x + h sqrt(log(1 / tolerance)), found through a bucket grid of cell
+// r_y. Building is O(M p^2), an evaluation O(p^2) per nearby cluster instead of O(M) exponentials.
+class FastGaussTransform {
+public:
+    FastGaussTransform(const std::vector<std::complex<double>>& sources, const std::vector<double>& weights,
+                       double h, double tolerance);
+
+    double operator()(std::complex<double> y) const;
+
+    // sum_i q_i |y - x_i|^2 exp(-|y - x_i|^2 / h^2), with G(y) in G (about four times the work)
+    double distance(std::complex<double> y, double& G) const;
+
+    // Coefficients operator() visits for target y, to weigh the transform against direct summation
+    double work(std::complex<double> y) const;
+
+    int clusters() const { return static_cast<int>(centers.size()); }
+    int order() const { return p; }
+
+private:
+    template <typename Visit>
+    void for_clusters_near(std::complex<double> y, Visit visit) const;
+
+    // expansions per cluster: of q_i, and of q_i times v_i,re, v_i,im and |v_i|^2 (v_i = (x_i - c) / h)
+    static const int MOMENTS = 4;
+
+    struct Cluster {
+        int order;                  // 1 for a single source at the center
+        size_t offset;              // first coefficient in coeffs, MOMENTS blocks of order*(order+1)/2
+    };
+
+    double h;
+    double r_y;
+    int p;
+    std::vector<std::complex<double>> centers;
+    std::vector<Cluster> info;
+    std::vector<double> coeffs;     // C_(a,b), a + b < order, row by row in a, one block per moment
+
+    // bucket grid over the centers, cells of at least r_y so that a target's 3 x 3 cells hold every
+    // cluster within r_y
+    double cell;
+    double grid_re, grid_im;        // lower-left corner
+    int grid_cols, grid_rows;
+    std::vector<std::vector<int>> buckets;
+};
+
+#endif // FAST_GAUSS_H
@@ -18,7 +18,14 @@
 #include <unsupported/Eigen/MatrixFunctions>
 #include <unordered_map>
 #include <limits>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <cstdint>
 #include "hermite.h"
+#include "e0_kernel.h"
+#include "fast_gauss.h"
+#include "exponents.h"
 // #include "database.h" // Commented out to avoid MySQL dependency
 
 using namespace std;
@@ -33,7 +40,6 @@ using namespace Eigen;
 #define PI M_PI
 #define eu std::exp(1.0)
 const complex<double> I(0.0, 1.0);
-#define vms vector<chrono::microseconds>
 
 bool is_db_connected = false;
 // MYSQL* conn; // database reference - commented out
@@ -70,28 +76,41 @@ bool disconnect_from_db(){
     }
 }
 */
-double SNR = 1; // positive
+thread_local double SNR = 1; // positive
 // vector<complex<double>> X = {1,1,1,1};
 // vector<complex<double>> X = {1,2};
-int sizeX = pow(2, 6);
-vector<double> Qq;
+thread_local int sizeX = pow(2, 6);
+thread_local vector<double> Qq;
 
 // Global variables for distribution type and shaping parameter
-static string current_distribution = "uniform";
-static double current_beta = 0.0;
-
-// Flag to force consistent computation method during optimization
-// This ensures all E0 evaluations in one GD_co run use the same method (regular or log-space)
-// preventing discontinuities at the transition boundary
-static bool force_log_space_mode = false;
+static thread_local string current_distribution = "uniform";
+static thread_local double current_beta = 0.0;
 
 // Global variables to store mutual information, cutoff rate, and critical rate from interpolation
 // These are computed during GD_co and exposed via getter functions
-static double g_mutual_information = 0.0;  // E0'(0) = I(X;Y)
-static double g_cutoff_rate = 0.0;         // E0(1) = R0
-static double g_critical_rate = 0.0;       // E0'(1) = R_crit
-
-vector<complex<double>> X;
+static thread_local double g_mutual_information = 0.0;  // E0'(0) = I(X;Y)
+static thread_local double g_cutoff_rate = 0.0;         // E0(1) = R0
+static thread_local double g_critical_rate = 0.0;       // E0'(1) = R_crit
+
+// Low-SNR series fast path: when the truncation error of the second-order expansion of E0 in SNR
+// is below low_snr_tolerance (bits), E_0_co evaluates the series instead of the quadrature
+static double low_snr_tolerance = 1e-9;
+static thread_local bool low_snr_mode = false;
+
+// Cooperative stop for the solver: GD_co checks the flag and the deadline between E_0_co evaluations
+// and, when either is hit, returns its last evaluated iterate with solver_converged = false
+static thread_local const std::atomic<bool>* solver_cancel = nullptr;
+static thread_local std::chrono::steady_clock::time_point solver_deadline = std::chrono::steady_clock::time_point::max();
+static thread_local bool solver_converged = true;
+
+// Optimum of a nearby problem (e.g. the previous solve of an edited constellation) and the cubic fit
+// of initial_guess there: GD_co shifts its own fit by the error the fit made on that problem, which
+// changes little between nearby problems (warm_start_rho < 0: none)
+static thread_local double warm_start_rho = -1.0;
+static thread_local double warm_start_guess = -1.0;
+static thread_local double last_initial_guess = -1.0;
+
+thread_local vector<complex<double>> X;
 //vector<complex<double>> X;
 // complex<double> I1 (0,2 * PI * 1 / 4), I2 (0,2 * PI * 2 / 4), I3 (0,2 * PI * 3 / 4);
 // vector<complex<double>> X = {1,exp(I1), exp(I2), exp(I3)};
@@ -100,65 +119,125 @@ vector<complex<double>> X;
                              complex<double> (-1/sqrt(2), 1/sqrt(2) ),
                              complex<double> ( 1/sqrt(2), 1/sqrt(2) )   };*/
 
-double R;
-unordered_map<int, vector<double>> all_hweights;
-unordered_map<int, vector<double>> all_roots;
-unordered_map<int, vector<double>> all_multhweights;
+thread_local double R;
+thread_local unordered_map<int, vector<double>> all_hweights;
+thread_local unordered_map<int, vector<double>> all_roots;
+thread_local unordered_map<int, vector<double>> all_multhweights;
 
-int n = 15; // todo: warning: temporary
+thread_local int n = 15; // todo: warning: temporary
 void setN(int n_) { n = n_; }
 
 // -- MATRIX DEFINITIONS --
-VectorXd Q_mat;
-MatrixXd PI_mat;
-MatrixXd W_mat;
-VectorXcd X_mat(sizeX);
-MatrixXd D_mat;
-VectorXd A_mat; // alphas
-
-double low = n; // todo: warning: temporary: before was 17.0
-
-vms e0_times;// = {std::chrono::microseconds(1), std::chrono::microseconds(2), std::chrono::microseconds(3)};
-vms NAG_cc_times;
-vms NAG_iid_times;
-vms NAG_times;
-vms GD_cc_times;
-vms NAG_co_times;
-vms GD_iid_times;
-vms GD_co_times;
-vms GD_ccomp_times;
-vms gradient_e0_co_times;
-vms fa_times;
-vms gradient_f_times;
-vms gradient_f_co_times;
-vms fa_co_times;
-vms e02_times;
-vms E_0_co_times;
-vms gradient_e0_times;
-vms compute_hweights_times;
-vms mult_newhweights_times;
-
-
-unordered_map<string, vector<chrono::microseconds>> get_times() {
-    return
-            {{"e0_times",               e0_times},// = {std::chrono::microseconds(1), std::chrono::microseconds(2), std::chrono::microseconds(3)};{NAG_cc_times, "NAG_cc_times",
-             {"NAG_iid_times",          NAG_iid_times},
-             {"NAG_times",              NAG_times},
-             {"GD_cc_times",            GD_cc_times},
-             {"NAG_co_times",           NAG_co_times},
-             {"GD_iid_times",           GD_iid_times},
-             {"GD_co_times",            GD_co_times},
-             {"GD_ccomp_times",         GD_ccomp_times},
-             {"gradient_e0_co_times",   gradient_e0_co_times},
-             {"fa_times",               fa_times},
-             {"gradient_f_times",       gradient_f_times},
-             {"gradient_f_co_times",    gradient_f_co_times},
-             {"fa_co_times",            fa_co_times},
-             {"e02_times",              e02_times},
-             {"E_0_co_times",           E_0_co_times},
-             {"gradient_e0_times",      gradient_e0_times},
-             {"compute_hweights_times", compute_hweights_times},
-             {"mult_newhweights_times", mult_newhweights_times}};
+thread_local VectorXd Q_mat;
+thread_local MatrixXd PI_mat;
+thread_local MatrixXd W_mat;
+thread_local VectorXcd X_mat(sizeX);
+thread_local MatrixXd D_mat;
+thread_local VectorXd A_mat; // alphas
+
+thread_local double low = n; // todo: warning: temporary: before was 17.0
+
+// Memory budget of the quadrature matrices (0: the process default, which is 0 for none). Over
+// budget, setPI/setW keep only the node weights and positions and E_0_co runs the tiled kernel
+// (E_0_co_tiled), so neither D_mat nor PI_mat is ever allocated. The tiled kernel can also be
+// requested for points within budget (setTiledEvaluation), since it never leaves the cache and needs
+// far fewer exponentials.
+static const double QUADRATURE_MATRICES_AT_PEAK = 4.0; // D_mat, PI_mat and two E_0_co temporaries
+static std::atomic<size_t> default_memory_budget(0);
+static std::atomic<bool> default_tiled(false);
+static std::atomic<int> default_kernel_threads(1);
+static thread_local size_t memory_budget = 0;
+static thread_local int tiled_evaluation = -1; // -1: default_tiled
+static thread_local int kernel_threads = 0;    // 0: default_kernel_threads
+static std::atomic<bool> default_global_grid(false);
+static thread_local int global_grid = -1;      // -1: default_global_grid
+static const int FAST_GAUSS_MIN_POINTS = 64;   // below this the exact tiled kernel is faster
+static const double FAST_GAUSS_TERM_COST = 4.0;
+static std::atomic<double> default_fast_gauss_tolerance(0.0);
+static thread_local double fast_gauss_tolerance = -1.0; // < 0: default_fast_gauss_tolerance
+static thread_local int quadrature_mode = EP_EVAL_DENSE; // chosen by setPI/setW
+static thread_local VectorXd stream_weights; // PI(a, a*n*n + k) = stream_weights(k) for every a
+static thread_local VectorXcd stream_nodes;  // quadrature node z_k of column a*n*n + k
+
+size_t quadraturePeakBytes(int M, int n_) {
+    return static_cast<size_t>(QUADRATURE_MATRICES_AT_PEAK * M * M * n_ * n_ * sizeof(double));
+}
+
+// Per-thread buffers of E_0_co_tiled: the two M x n factor tables and one n x n tile
+size_t tiledPeakBytes(int M, int n_) {
+    return (2 * static_cast<size_t>(M) * n_ + static_cast<size_t>(n_) * n_) * sizeof(double);
+}
+
+void setMemoryBudget(size_t bytes) {
+    memory_budget = bytes;
+}
+
+void setDefaultMemoryBudget(size_t bytes) {
+    default_memory_budget = bytes;
+}
+
+void setTiledEvaluation(int tiled, int threads) {
+    tiled_evaluation = tiled;
+    kernel_threads = threads;
+}
+
+void setDefaultTiledEvaluation(bool tiled, int threads) {
+    default_tiled = tiled;
+    default_kernel_threads = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+void setGlobalGridQuadrature(int enabled) {
+    global_grid = enabled;
+}
+
+void setDefaultGlobalGridQuadrature(bool enabled) {
+    default_global_grid = enabled;
+}
+
+// A tolerance of 1 or more bounds nothing (sum Q = 1) and leaves no cutoff radius beyond the cluster
+// radius (NaN beyond 1), so it turns the transform off instead
+void setFastGaussTolerance(double tolerance) {
+    fast_gauss_tolerance = tolerance < 1 ? tolerance : 0.0;
+}
+
+void setDefaultFastGaussTolerance(double tolerance) {
+    default_fast_gauss_tolerance = tolerance > 0 && tolerance < 1 ? tolerance : 0.0;
+}
+
+static double fast_gauss_tolerance_in_use() {
+    return fast_gauss_tolerance >= 0 ? fast_gauss_tolerance : default_fast_gauss_tolerance.load();
+}
+
+static bool over_memory_budget(int M, int n_) {
+    const size_t budget = memory_budget > 0 ? memory_budget : default_memory_budget.load();
+    return budget > 0 && quadraturePeakBytes(M, n_) > budget;
+}
+
+// Depth of the live DenseQuadratureScope objects of the thread: while positive, setPI/setW build D_mat
+// and PI_mat for the consumers that index them, unless the memory budget forbids it
+static thread_local int dense_scope_depth = 0;
+
+void enterDenseQuadrature() { ++dense_scope_depth; }
+
+void leaveDenseQuadrature() { --dense_scope_depth; }
+
+int quadratureModeFor(int M, int n_) {
+    if (dense_scope_depth > 0) return over_memory_budget(M, n_) ? EP_EVAL_STREAMING : EP_EVAL_DENSE;
+    const bool grid = global_grid >= 0 ? global_grid > 0 : default_global_grid.load();
+    if (grid && n_ >= 2) return EP_EVAL_GLOBAL_GRID;
+    if (fast_gauss_tolerance_in_use() > 0 && M >= FAST_GAUSS_MIN_POINTS) return EP_EVAL_FAST_GAUSS;
+    if (over_memory_budget(M, n_)) return EP_EVAL_STREAMING;
+    const bool tiled = tiled_evaluation >= 0 ? tiled_evaluation > 0 : default_tiled.load();
+    return tiled ? EP_EVAL_TILED : EP_EVAL_DENSE;
+}
+
+static int select_quadrature_mode() {
+    return quadratureModeFor(sizeX, n);
+}
+
+int getEvaluationMode() {
+    if (low_snr_mode) return EP_EVAL_LOW_SNR_SERIES;
+    return quadrature_mode;
 }
 
 double abs_sq(std::complex<double> a) { return pow(real(a), 2) + pow(imag(a), 2); }
@@ -192,10 +271,8 @@ void setQ(string distribution = "uniform", double shaping_param = 0.0) {
 
     if (distribution == "maxwell-boltzmann" || distribution == "boltzmann") {
         // Maxwell-Boltzmann / Boltzmann distribution: Q(i) ∝ exp(-beta * |X(i)|²)
-        // Don't compute Q_mat here - let normalizeX_for_Q() do it via fixed-point iteration
+        // Don't compute Q_mat here - let normalizeX_for_Q() solve for the scale
         // This ensures Q and X maintain the correct relationship
-        std::cout << "INFO: Maxwell-Boltzmann distribution requested with beta=" << shaping_param
-                  << " (Q will be computed via fixed-point iteration)\n";
     } else {
         // Uniform distribution (default)
         for (int i = 0; i < sizeX; i++) {
@@ -211,15 +288,22 @@ void setPI() {
     vector<double> hweights = Hweights(n - 1); // todo change n
     vector<double> windows;
 
-    PI_mat = MatrixXd::Zero(sizeX, n * n * sizeX);
-    //for(auto h: hweights){  cout << "weights: " << h << endl; }
-
     for (int i = 0; i < n; i++) {
         for (int j = 0; j < n; j++) {
             windows.push_back(hweights[j] * hweights[i]); // windows is size n*n
         }
     }
 
+    quadrature_mode = select_quadrature_mode();
+    if (quadrature_mode != EP_EVAL_DENSE) {
+        PI_mat.resize(0, 0);
+        stream_weights = Map<VectorXd>(windows.data(), windows.size());
+        return;
+    }
+
+    PI_mat = MatrixXd::Zero(sizeX, n * n * sizeX);
+    //for(auto h: hweights){  cout << "weights: " << h << endl; }
+
     //for(auto w: windows){  cout << "windows: " << w << endl; }
 
     for (int i = 0; i < sizeX; i++) {
@@ -235,6 +319,7 @@ void setPI() {
 }
 
 void setW() {
+    low_snr_mode = false; // E_0_co must use the quadrature matrices built here
     //W_mat = MatrixXd::Zero(sizeX, n*n*sizeX);
     vector<double> roots = Hroots(n);
     vector<complex<double>> complexroots; // n*n
@@ -243,6 +328,13 @@ void setW() {
             complexroots.push_back(complex<double>(roots[i], roots[j]));
         }
     }
+
+    quadrature_mode = select_quadrature_mode();
+    if (quadrature_mode != EP_EVAL_DENSE) {
+        D_mat.resize(0, 0);
+        stream_nodes = Map<VectorXcd>(complexroots.data(), complexroots.size());
+        return;
+    }
     /*
     cout << endl << "X: " << endl;
     for(auto x: X_mat){
@@ -267,10 +359,14 @@ void setW() {
     // cout << endl << "Y: " << endl << Y << endl;
 
     //MatrixXd D_mat(sizeX, n*n*sizeX);
-    D_mat = MatrixXd::Zero(sizeX, n * n * sizeX);
-    for (int i = 0; i < sizeX; i++) {
-        for (int j = 0; j < n * n * sizeX; j++) {
-            D_mat(i, j) = abs_sq(Y(j) - sqrt(SNR) * X_mat(i));
+    D_mat.resize(sizeX, n * n * sizeX);
+    const VectorXcd X_scaled = sqrt(SNR) * X_mat;
+    double *D = D_mat.data();
+    for (int j = 0; j < n * n * sizeX; j++) {
+        const double y_re = Y(j).real(), y_im = Y(j).imag();
+        for (int i = 0; i < sizeX; i++) { // column-major: one contiguous column per output point
+            const double d_re = y_re - X_scaled(i).real(), d_im = y_im - X_scaled(i).imag();
+            D[j * sizeX + i] = d_re * d_re + d_im * d_im;
         }
     }
     //cout << endl << "D: " << endl << D_mat << endl;
@@ -285,6 +381,92 @@ void setW() {
     //std::cout << "Y[0]: " << Y(0) << "\n"; // Should be X_mat[0] + complexroots[0]
 }
 
+struct QuadratureCache {
+    MatrixXd D_cached, PI_cached;
+    double snr = 0.0;
+    int n = 0;              // 0: empty
+    bool pi_valid = false;  // PI matches the symbol count of D
+};
+
+QuadratureCache* createQuadratureCache() {
+    return new QuadratureCache();
+}
+
+void destroyQuadratureCache(QuadratureCache* cache) {
+    delete cache;
+}
+
+int quadratureCacheState(const QuadratureCache* cache, int M, double snr, int n_) {
+    if (cache->n != n_ || cache->snr != snr || cache->D_cached.rows() != M) return 0;
+    return cache->pi_valid ? 2 : 1;
+}
+
+void exchangeQuadrature(QuadratureCache* cache, double snr, int n_) {
+    D_mat.swap(cache->D_cached);
+    PI_mat.swap(cache->PI_cached);
+    cache->snr = snr;
+    cache->n = n_;
+    cache->pi_valid = cache->PI_cached.rows() == cache->D_cached.rows() && cache->PI_cached.cols() == cache->D_cached.cols();
+    quadrature_mode = EP_EVAL_DENSE;
+}
+
+// Row index and the n*n columns of symbol index of D, as setW fills them
+static void fill_symbol_distances(QuadratureCache* cache, const vector<complex<double>>& points, int index) {
+    const int M = static_cast<int>(points.size()), nn = cache->n * cache->n;
+    const vector<double> roots = Hroots(cache->n);
+    const double scale = sqrt(cache->snr);
+    MatrixXd& D = cache->D_cached;
+    auto distance = [&](int a, int k, int i) { // |sqrt(SNR) x_a + z_k - sqrt(SNR) x_i|^2
+        const complex<double> y = scale * points[a] + complex<double>(roots[k / cache->n], roots[k % cache->n]);
+        return norm(y - scale * points[i]);
+    };
+    for (int a = 0; a < M; a++) {
+        for (int k = 0; k < nn; k++) D(index, a * nn + k) = distance(a, k, index);
+    }
+    for (int k = 0; k < nn; k++) {
+        for (int i = 0; i < M; i++) D(i, index * nn + k) = distance(index, k, i);
+    }
+}
+
+void quadratureCacheMoveSymbol(QuadratureCache* cache, const vector<complex<double>>& points, int index) {
+    if (cache->n == 0) return;
+    fill_symbol_distances(cache, points, index);
+}
+
+void quadratureCacheAppendSymbol(QuadratureCache* cache, const vector<complex<double>>& points) {
+    if (cache->n == 0) return;
+    const int M = static_cast<int>(points.size());
+    cache->D_cached.conservativeResize(M, static_cast<Index>(M) * cache->n * cache->n);
+    cache->pi_valid = false;
+    fill_symbol_distances(cache, points, M - 1);
+}
+
+void quadratureCacheRemoveSymbol(QuadratureCache* cache, int index) {
+    if (cache->n == 0) return;
+    const int M = static_cast<int>(cache->D_cached.rows()), nn = cache->n * cache->n;
+    vector<int> rows, cols;
+    for (int i = 0; i < M; i++) {
+        if (i == index) continue;
+        rows.push_back(i);
+        for (int k = 0; k < nn; k++) cols.push_back(i * nn + k);
+    }
+    cache->D_cached = cache->D_cached(rows, cols).eval();
+    cache->pi_valid = false;
+}
+
+bool denseQuadratureSelected() {
+    return select_quadrature_mode() == EP_EVAL_DENSE;
+}
+
+void setWarmStart(double rho, double guess) {
+    warm_start_rho = rho;
+    warm_start_guess = guess;
+}
+
+double getInitialGuess() {
+    return last_initial_guess;
+}
+
 void setX(int npoints, string xmode) {
     sizeX = npoints;
     X.resize(npoints);
@@ -359,6 +541,88 @@ void setX(int npoints, string xmode) {
     */
 }
 
+// -- MAXWELL-BOLTZMANN NORMALIZATION --
+// Memoized (pattern, beta) -> (X, Q), so shaped sweeps solve the scale equation once
+struct MBCacheEntry {
+    VectorXcd pattern;
+    double beta;
+    VectorXcd X;
+    VectorXd Q;
+};
+
+static const size_t MB_CACHE_SIZE = 32;
+static thread_local vector<MBCacheEntry> mb_cache;
+
+// phi(u) = u + log E_t[e] and phi'(u) = 1 - beta * t * Var_t[e] / E_t[e] for t = exp(u), where E_t is
+// the mean of the energies e under Q_i ∝ exp(-beta * t * e_i)
+static double mb_scale_equation(const vector<double> &energy, double e_min, double beta, double u, double &dphi) {
+    double t = std::exp(u), w_sum = 0.0, m1 = 0.0, m2 = 0.0;
+    for (double e: energy) {
+        double w = std::exp(-beta * t * (e - e_min));
+        w_sum += w;
+        m1 += w * e;
+        m2 += w * e * e;
+    }
+    m1 /= w_sum;
+    m2 /= w_sum;
+    dphi = 1.0 - beta * t * (m2 - m1 * m1) / m1;
+    return u + std::log(m1);
+}
+
+// Solves t * E_t[e] = 1 for t = s² with Newton steps on phi(u), safeguarded by false position
+// (Illinois variant) on the bracket [1/max(e), 1/min(e)], where phi changes sign.
+static double mb_solve_scale(const vector<double> &energy, double beta, int &iterations) {
+    const double e_min = *std::min_element(energy.begin(), energy.end());
+    const double e_max = *std::max_element(energy.begin(), energy.end());
+    iterations = 0;
+    if (e_max <= 0) return 1.0;
+    if (e_max - e_min <= 1e-15 * e_max) return 1.0 / e_max; // constant energy (PSK)
+
+    double dphi;
+    double u_lo = -std::log(e_max), u_hi;
+    double phi_lo = mb_scale_equation(energy, e_min, beta, u_lo, dphi), phi_hi;
+    if (e_min > 0) {
+        u_hi = -std::log(e_min);
+        phi_hi = mb_scale_equation(energy, e_min, beta, u_hi, dphi);
+    } else {
+        // a point at the origin leaves the bracket open above: expand it
+        u_hi = u_lo;
+        do {
+            u_hi += 1.0;
+            phi_hi = mb_scale_equation(energy, e_min, beta, u_hi, dphi);
+        } while (phi_hi < 0 && u_hi < u_lo + 60.0);
+    }
+    if (phi_lo >= 0) return std::exp(u_lo);
+    if (phi_hi <= 0) return std::exp(u_hi);
+
+    // start from the uniform-Q fixed point, which is exact for beta = 0
+    double mean = 0.0;
+    for (double e: energy) mean += e;
+    double u = std::min(std::max(-std::log(mean / energy.size()), u_lo), u_hi);
+    int side = 0;
+    for (iterations = 1; iterations <= 100; iterations++) {
+        double phi = mb_scale_equation(energy, e_min, beta, u, dphi);
+        if (std::abs(phi) < 1e-15) break;
+        if (phi < 0) {
+            u_lo = u; phi_lo = phi;
+            if (side == -1) phi_hi *= 0.5;
+            side = -1;
+        } else {
+            u_hi = u; phi_hi = phi;
+            if (side == 1) phi_lo *= 0.5;
+            side = 1;
+        }
+        if (u_hi - u_lo < 1e-15 * std::max(1.0, std::abs(u))) break;
+
+        double u_next = (dphi > 0) ? u - phi / dphi : u;
+        if (!(u_next > u_lo && u_next < u_hi)) {
+            u_next = (u_lo * phi_hi - u_hi * phi_lo) / (phi_hi - phi_lo);
+        }
+        u = u_next;
+    }
+    return std::exp(u);
+}
+
 void normalizeX_for_Q() {
     if (current_distribution == "uniform") {
         // Uniform distribution: Simple normalization (old behavior)
@@ -386,91 +650,32 @@ void normalizeX_for_Q() {
                       << "), X normalization skipped\n";
         }
     } else if (current_distribution == "maxwell-boltzmann" || current_distribution == "boltzmann") {
-        // Maxwell-Boltzmann: Fixed-point iteration to find s such that:
+        // Maxwell-Boltzmann: find s such that
         //   Q_i ∝ exp(-beta * |s*p_i|²)  AND  E[|X|²] = 1
         // where p is the unnormalized pattern and X = s*p
-
-        // Convergence criteria: use both absolute and relative tolerances
-        // to handle all beta values robustly
-        double abs_tolerance = 1e-14;  // Absolute tolerance (relaxed from 1e-15)
-        double rel_tolerance = 1e-12;  // Relative tolerance
-        int max_iterations = 1000;
         double beta = current_beta;
 
+        for (auto &entry: mb_cache) {
+            if (entry.beta == beta && entry.pattern.size() == X_mat.size() && entry.pattern == X_mat) {
+                X_mat = entry.X;
+                Q_mat = entry.Q;
+                for (int i = 0; i < sizeX; i++) X[i] = X_mat(i);
+                return;
+            }
+        }
+
         // Store unnormalized pattern energies |p_i|²
         vector<double> pattern_energy(sizeX);
         for (int i = 0; i < sizeX; i++) {
-            complex<double> p_i = X_mat(i);
-            pattern_energy[i] = std::abs(p_i) * std::abs(p_i);  // |p_i|²
+            pattern_energy[i] = abs_sq(X_mat(i));  // |p_i|²
         }
 
-        // Fixed-point iteration: s_new = 1 / sqrt(E[|p|²])
-        double s = 1.0;  // Initial scaling factor
-        double s_prev = 0.0;  // Track previous value for stagnation detection
-        int converged_iter = -1;
-
-        for (int iter = 0; iter < max_iterations; iter++) {
-            // Compute unnormalized Q: Q_i ∝ exp(-beta * s² * |p_i|²)
-            vector<double> unnorm_Q(sizeX);
-            double Q_sum = 0.0;
-            for (int i = 0; i < sizeX; i++) {
-                unnorm_Q[i] = std::exp(-beta * s * s * pattern_energy[i]);
-                Q_sum += unnorm_Q[i];
-            }
-
-            // Normalize Q to make it a probability distribution
-            vector<double> Q(sizeX);
-            for (int i = 0; i < sizeX; i++) {
-                Q[i] = unnorm_Q[i] / Q_sum;
-            }
-
-            // Compute expected energy: E[|p|²] = Σ Q_i * |p_i|²
-            double expected_energy = 0.0;
-            for (int i = 0; i < sizeX; i++) {
-                expected_energy += Q[i] * pattern_energy[i];
-            }
-
-            // Update scaling factor: s_new = 1 / sqrt(E[|p|²])
-            double s_new = 1.0 / std::sqrt(expected_energy);
-
-            // Check convergence with multiple criteria
-            double delta_s = std::abs(s_new - s);
-            double rel_delta = (s > 1e-10) ? (delta_s / s) : delta_s;
+        int iterations = 0;
+        double s = std::sqrt(mb_solve_scale(pattern_energy, beta, iterations));
 
-            // Check for stagnation (no progress between iterations)
-            bool stagnated = (s_prev > 0) && (s == s_prev);
-
-            if (iter < 10 || iter % 50 == 0) {
-                std::cout << "  Iter " << iter << ": s=" << s
-                          << ", E[|p|²]=" << expected_energy
-                          << ", |Δs|=" << delta_s << "\n";
-            }
-
-            // Convergence achieved if:
-            // 1. Absolute change is tiny (below absolute tolerance), OR
-            // 2. Relative change is tiny (below relative tolerance), OR
-            // 3. Algorithm has stagnated (no change between iterations)
-            bool converged = (delta_s < abs_tolerance) ||
-                           (rel_delta < rel_tolerance) ||
-                           stagnated;
-
-            if (converged) {
-                s = s_new;
-                converged_iter = iter;
-                std::cout << "INFO: Fixed-point iteration converged after " << iter
-                          << " iterations, final s=" << s
-                          << " (|Δs|=" << delta_s << ", rel=" << rel_delta << ")\n";
-                break;
-            }
-
-            s_prev = s;
-            s = s_new;
-        }
-
-        if (converged_iter < 0) {
-            std::cerr << "WARNING: Fixed-point iteration did not converge after "
-                      << max_iterations << " iterations\n";
-        }
+        MBCacheEntry entry;
+        entry.pattern = X_mat;
+        entry.beta = beta;
 
         // Apply final scaling factor to constellation
         for (int i = 0; i < sizeX; i++) {
@@ -479,30 +684,18 @@ void normalizeX_for_Q() {
         }
 
         // Compute and set final Q_mat based on scaled constellation
+        // (shifted by the minimum energy so that large beta cannot underflow every weight)
+        double min_energy = *std::min_element(pattern_energy.begin(), pattern_energy.end()) * s * s;
         Q_mat = VectorXd::Zero(sizeX);
-        double Q_sum = 0.0;
-        for (int i = 0; i < sizeX; i++) {
-            double energy = std::abs(X_mat(i)) * std::abs(X_mat(i));  // |X_i|²
-            Q_mat(i) = std::exp(-beta * energy);
-            Q_sum += Q_mat(i);
-        }
-
-        // Normalize Q_mat
-        if (Q_sum > 1e-14) {
-            for (int i = 0; i < sizeX; i++) {
-                Q_mat(i) /= Q_sum;
-            }
-        }
-
-        // Verification: compute final average energy
-        double final_avg_energy = 0.0;
         for (int i = 0; i < sizeX; i++) {
-            double x_squared = std::abs(X_mat(i)) * std::abs(X_mat(i));
-            final_avg_energy += Q_mat(i) * x_squared;
+            Q_mat(i) = std::exp(-beta * (abs_sq(X_mat(i)) - min_energy));
         }
+        Q_mat /= Q_mat.sum();
 
-        std::cout << "INFO: Final E[|X|²] = " << final_avg_energy
-                  << " (error from 1.0: " << std::abs(final_avg_energy - 1.0) << ")\n";
+        entry.X = X_mat;
+        entry.Q = Q_mat;
+        if (mb_cache.size() >= MB_CACHE_SIZE) mb_cache.erase(mb_cache.begin());
+        mb_cache.push_back(entry);
     }
 }
 
@@ -548,15 +741,6 @@ void setCustomConstellation(const double* real_parts, const double* imag_parts,
     cout << "INFO: Custom constellation set with " << num_points << " points" << endl;
 }
 
-std::chrono::microseconds sum_(vector<std::chrono::microseconds> vector1) {
-    std:
-    chrono::microseconds s = (std::chrono::microseconds) 0;
-    for (auto x: vector1) {
-        s += x;
-    }
-    return s;
-}
-
 string complextostr(complex<double> x) {
     return to_string(real(x)) + "+I*" + to_string(imag(x));
 }
@@ -633,8 +817,6 @@ void test() {
 
 double fa(complex<double> x, complex<double> y, vector<double> alphas, double rho, int xind) {
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
     double f = 0;
     double h = H(alphas[xind], x, y, rho);
     int xindex = 0;
@@ -643,17 +825,12 @@ double fa(complex<double> x, complex<double> y, vector<double> alphas, double rh
         xindex++;
     }
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    fa_times.push_back(duration_XX);
 
     return f;
 }
 
 double fa_co(complex<double> x, complex<double> y, double r, double rho) {
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
     double f = 0;
     double h = H_co(r, x, y, rho);
     int a = 0;
@@ -661,66 +838,11 @@ double fa_co(complex<double> x, complex<double> y, double r, double rho) {
         f += Q(a) * G_co(r, xhat, y, rho) / h; // todo check Q()
         a++;
     }
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    fa_co_times.push_back(duration_XX);
 
     return f;
 }
 
 
-double E_0(double rho, vector<double> alphas, int n) {
-
-    auto start_e0 = std::chrono::high_resolution_clock::now();
-
-    /*
-    cout << Q_mat.rows() << endl;
-    cout << Q_mat.cols() << endl;
-    cout << PI_mat.rows() << endl;
-    cout << PI_mat.cols() << endl;
-    cout << W_mat.rows() << endl;
-    cout << W_mat.cols() << endl;
-    */
-    rho = 0; // todo temp
-
-    MatrixXd W_firstpower = W_mat.array().pow(-(rho) / (1 + rho));
-    MatrixXd W_secondpower = W_mat.array().pow(1 / (1 + rho));
-    //MatrixXcd QW2 = ;
-    //MatrixXcd QW2_transpose = QW2.transpose();
-
-    //cout << endl << PI_mat << endl;
-
-    cout << "Wf" << endl << W_firstpower << endl;
-    cout << "Ws" << endl << W_secondpower << endl;
-    cout << "test" << endl << (PI_mat.cwiseProduct(W_firstpower)) << endl;
-    cout << "last" << endl << (Q_mat.array().transpose().pow(rho).matrix() * W_secondpower).transpose() << endl;
-
-    VectorXd ones(n * n * sizeX);
-    for (int i = 0; i < n * n * sizeX; i++) { ones(i) = 1; }
-
-    double E0 = Q_mat.transpose() * // 1 x 32
-                (PI_mat.cwiseProduct(W_firstpower)) * // 32 x 544
-                ones;  // 1 x 32 x 32 x 544
-    //(Q_mat.array().transpose() * W_secondpower).pow(rho).transpose();
-
-    //MatrixXd ED = (D_mat*-0.5).array().exp();
-    //MatrixXd Wpow = W_mat.array().pow(0.5);
-
-
-    auto stop_e0 = std::chrono::high_resolution_clock::now();
-    auto duration_e0 = std::chrono::duration_cast<std::chrono::microseconds>(stop_e0 - start_e0);
-
-    //cout << endl << ED << endl;
-
-    //double E0 = 0;
-
-    e0_times.push_back(duration_e0);
-
-    // todo change
-    E0 = 0;
-    return E0;
-}
-
 void printrowscols(MatrixXd m, string s) {
     //cout << s << " " << m.rows() << " " << m.cols() << endl;
 }
@@ -776,83 +898,33 @@ double E_0_2_co() {
     return -log2(sum);
 }
 
-double E_0_co(double r, double rho, double &grad_rho, double &grad_2_rho, double &E0, int n, vector<double> hweights,
-              vector<double> multhweights, vector<double> roots) {
-    // computes second der
-    Eigen::VectorXd logqg2 = (Q_mat.transpose() * ((-1.0 / (1.0 + rho)) * D_mat.array()).exp().matrix()).array().log();
-    Eigen::VectorXd qg2rho = (rho * logqg2.array()).exp();
-    Eigen::MatrixXd pig1_mat = PI_mat.array() * ((rho / (1.0 + rho)) * D_mat.array()).exp();
+// D_mat and the n*n node weights of PI_mat (PI(a, a*n*n + k) = w_k) as the E_0_co template reads them
+static MatrixColumns dense_columns() {
+    const int M = static_cast<int>(D_mat.rows());
+    return {D_mat.data(), M, static_cast<int>(D_mat.cols() / M)};
+}
 
-    const int sizeX = Q_mat.size();
-    const double s = 1.0 / (1.0 + rho);
-    const double s_prime = -1.0 / pow(1.0 + rho, 2);
-    const double s_double_prime = 2.0 / pow(1.0 + rho, 3);
-
-    // Common terms -----------------------------------------------------------
-    const MatrixXd ln_W = W_mat.array().log();
-    const MatrixXd exp_slnW = (s * ln_W).array().exp();
-    const MatrixXd exp_neg_srho_lnW = (-s * rho * ln_W).array().exp();
-
-    // Frequently used terms ---------------------------------------------------
-    const RowVectorXd QT_exp_slnW = Q_mat.transpose() * exp_slnW;
-    const RowVectorXd QT_sprime_lnW_exp_slnW = Q_mat.transpose() *
-                                               (s_prime * ln_W.array() * exp_slnW.array()).matrix();
-    const RowVectorXd ratio_term = QT_sprime_lnW_exp_slnW.array() / QT_exp_slnW.array();
-
-    // Compute values ----------------------------------------------------------
-    // Value1
-    MatrixXd term1 = (-s_prime * rho * ln_W - s * ln_W).array().square();
-    RowVectorXd val1 = (Q_mat.transpose() * (PI_mat.array() * exp_neg_srho_lnW.array() * term1.array()).matrix())
-                       * QT_exp_slnW.array().pow(rho).matrix().transpose();
-    double value1 = val1.value();
-
-    // Value2
-    MatrixXd term2 = (-s_double_prime * rho * ln_W - 2.0 * s_prime * ln_W);
-    RowVectorXd val2 = (Q_mat.transpose() * (PI_mat.array() * exp_neg_srho_lnW.array() * term2.array()).matrix())
-                       * QT_exp_slnW.array().pow(rho).matrix().transpose();
-    double value2 = val2.value();
-
-    // Value3 - Corrected
-    MatrixXd term3 = (-s_prime * rho * ln_W - s * ln_W);
-    MatrixXd val3_left_part = (PI_mat.array() * exp_neg_srho_lnW.array() * term3.array());
-    RowVectorXd val3_left = Q_mat.transpose() * val3_left_part;
-    RowVectorXd val3_right = QT_exp_slnW.array().pow(rho) *
-                             (QT_exp_slnW.array().log() + rho * ratio_term.array());
-    double value3 = 2.0 * val3_left.cwiseProduct(val3_right).sum();
-
-    // Value4
-    RowVectorXd squared_term = (QT_exp_slnW.array().log() + rho * ratio_term.array()).square();
-    RowVectorXd val4 = (Q_mat.transpose() * (PI_mat.array() * exp_neg_srho_lnW.array()).matrix())
-                       * (QT_exp_slnW.array().pow(rho) * squared_term.array()).matrix().transpose();
-    double value4 = val4.value();
-
-    // Value5
-    MatrixXd s_prime_sq_lnW_sq = s_prime * s_prime * ln_W.array().square();
-    MatrixXd inner_term = s_double_prime * ln_W + s_prime_sq_lnW_sq;
-    RowVectorXd term5 = 2.0 * ratio_term.array() +
-                        rho * (Q_mat.transpose() * (inner_term.array() * exp_slnW.array()).matrix()).array() /
-                        QT_exp_slnW.array() -
-                        rho * ratio_term.array().square();
-
-    RowVectorXd val5 = (Q_mat.transpose() * (PI_mat.array() * exp_neg_srho_lnW.array()).matrix())
-                       * (QT_exp_slnW.array().pow(rho) * term5.array()).matrix().transpose();
-    double value5 = val5.value();
-
-    double m = (Q_mat.transpose() * pig1_mat * qg2rho).sum();
-    double mp = (Q_mat.transpose() * pig1_mat * (qg2rho.array() * logqg2.array()).matrix()).sum()
-                - (1.0 / (1.0 + rho)) *
-                  (Q_mat.transpose() * (pig1_mat.array() * (-D_mat.array())).matrix() * qg2rho).sum();
-    double m2p = value1 + value2 + value3 + value4 + value5;
-
-
-    double F0 = m / PI;
-    double Fder0 = mp / PI;
-    double F2der0 = m2p / PI;
-
-    grad_rho = -(Fder0) / (std::log(2) * F0);
-    grad_2_rho = -(1.0 / std::log(2)) * ((F2der0 / F0) - std::pow(Fder0 / F0, 2));
-    E0 = -log2(F0);
+static vector<double> dense_weights() {
+    vector<double> weights(D_mat.cols() / D_mat.rows());
+    for (size_t k = 0; k < weights.size(); k++) weights[k] = PI_mat(0, k);
+    return weights;
+}
 
+// E0(rho) with its first and second rho-derivatives, all in bits, from one pass of the dense
+// quadrature with a nested dual number. Requires setPI()/setW().
+double E_0_co_derivatives(double rho, double &d1, double &d2) {
+    typedef Dual<double, 1> AD1;
+    typedef Dual<AD1, 1> AD2;
+    const AD2 e0 = E_0_co(AD2::variable(AD1::variable(rho, 0), 0), Q_mat, NoTilt(), dense_columns(), dense_weights());
+    d1 = e0.v.d[0];
+    d2 = e0.d[0].d[0];
+    return e0.v.v;
+}
+
+double E_0_co(double, double rho, double &grad_rho, double &grad_2_rho, double &E0, int, vector<double>,
+              vector<double>, vector<double>) {
+    // computes second der, on the quadrature built by setPI()/setW()
+    E0 = E_0_co_derivatives(rho, grad_rho, grad_2_rho);
     return E0;
 }
 
@@ -866,490 +938,622 @@ inline double log_sum_exp(const Eigen::VectorXd& log_values) {
     return max_val + std::log((log_values.array() - max_val).exp().sum());
 }
 
-// Log-space version of E_0_co for high SNR (overflow-safe)
-double E_0_co_log_space(double r, double rho, double &grad_rho, double &E0) {
-    std::cout << "INFO: Using log-space computation (high SNR mode)\n";
-
-    const int sizeX = Q_mat.size();  // Q_mat is a VectorXd
-    const int cols = D_mat.cols();    // n*n*sizeX
+// -- TILTED EXPONENT KERNEL --
+// Shared by the alpha-parameterized (E_0, gradient_e0) and cost-constrained (gradient_e0_co,
+// E_0_cost) exponents. With s = 1/(1+rho) and per-symbol tilts b (numerator) and c (denominator),
+//   f_j = sum_i Q_i exp(b_i - s D_ij) / exp(c_a - s D_aj),   j in the block of symbol a,
+//   T   = 1/pi sum_a Q_a sum_{j in a} w_j f_j^rho,            E0 = -log2(T).
+// alpha version: b_i = -rho alpha_i, c_a = alpha_a; cost version: b_i = -r rho cost_i, c_a = r cost_a
+// (b = c = 0 gives E_0_co). Everything is evaluated in the log domain with column max shifts, so
+// no SNR needs a separate log-space path. Requires setPI()/setW().
+struct TiltedTerms {
+    double log_T;      // natural log of T
+    VectorXd t;        // normalized column weights w_j Q_a f_j^rho / (pi T), summing to 1
+    VectorXd log_f;    // log f_j
+    MatrixXd P;        // posterior weights Q_i exp(b_i - s D_ij) / sum_i(...), columns sum to 1
+    VectorXi symbol;   // a(j), the transmitted symbol of column j
+};
+
+static void E_0_tilted(double rho, const VectorXd &b, const VectorXd &c, TiltedTerms &out) {
+    const int M = Q_mat.size();
+    const int cols = D_mat.cols();
+    const int block = cols / M;
     const double s = 1.0 / (1.0 + rho);
 
-    // Compute in log-space to avoid overflow
-    // logqg2 = log(Q^T * exp(-s * D))
-    // Result is a vector of size cols (n*n*sizeX)
-    // For each column j, compute log(sum_i Q_i * exp(-s * D_ij))
-    Eigen::VectorXd logqg2(cols);
-    for (int j = 0; j < cols; j++) {
-        // log(sum_i Q_i * exp(-s * D_ij)) = log_sum_exp(log(Q_i) - s * D_ij)
-        Eigen::VectorXd log_terms = Q_mat.array().log() - s * D_mat.col(j).array();
-        logqg2(j) = log_sum_exp(log_terms);
-    }
-
-    // Detect degenerate channel (SNR≈0): all symbols indistinguishable
-    // Check if logqg2 variance is very small (all columns give same posterior)
-    double logqg2_mean = logqg2.mean();
-    double logqg2_variance = (logqg2.array() - logqg2_mean).square().mean();
-
-    if (logqg2_variance < 1e-20 || !std::isfinite(logqg2_mean)) {
-        // Degenerate channel - capacity is effectively zero
-        std::cout << "INFO: Degenerate channel detected (SNR≈0), returning E0=0\n";
-        E0 = 0.0;
-        grad_rho = 0.0;
-        return 0.0;
-    }
+    MatrixXd exponent = (-s * D_mat).colwise() + b;
+    const RowVectorXd e_max = exponent.colwise().maxCoeff();
+    out.P = ((exponent.rowwise() - e_max).array().exp().colwise() * Q_mat.array()).matrix();
+    const RowVectorXd sums = out.P.colwise().sum();
+    out.P.array().rowwise() /= sums.array();
 
-    // Check if we can proceed without further overflow
-    // Since we're already using log-space for the logqg2 computation,
-    // we can be more lenient with the threshold (close to 700)
-    double max_qg2_arg = std::abs(rho * logqg2.maxCoeff());
-    double max_pig_arg = std::abs((rho / (1.0 + rho)) * D_mat.maxCoeff());
+    out.log_f.resize(cols);
+    out.symbol.resize(cols);
+    VectorXd log_t(cols);
+    for (int a = 0; a < M; a++) {
+        for (int j = a * block; j < (a + 1) * block; j++) {
+            out.symbol(j) = a;
+            out.log_f(j) = std::log(sums(j)) + e_max(j) - c(a) + s * D_mat(a, j);
+            log_t(j) = std::log(Q_mat(a) * PI_mat(a, j) / PI) + rho * out.log_f(j);
+        }
+    }
+    out.log_T = log_sum_exp(log_t);
+    out.t = (log_t.array() - out.log_T).exp();
+}
 
-    if (max_pig_arg < 690 && max_qg2_arg < 690) {
-        // Safe to exponentiate now (with some headroom before 700)
-        Eigen::VectorXd qg2rho = (rho * logqg2.array()).exp();
-        Eigen::MatrixXd pig1_mat = PI_mat.array() * ((rho / (1.0 + rho)) * D_mat.array()).exp();
+// Derivative of log T with respect to rho, given the tilt derivatives db/drho and dc/drho:
+//   d/drho (rho log f_j) = log f_j + rho (sum_i P_ij (db_i + D_ij s^2) - dc_a - D_aj s^2)
+static double E_0_tilted_drho(double rho, const TiltedTerms &k, const VectorXd &db, const VectorXd &dc) {
+    const double s2 = 1.0 / ((1.0 + rho) * (1.0 + rho));
+    const VectorXd inner = k.P.transpose() * db + s2 * (k.P.array() * D_mat.array()).colwise().sum().transpose().matrix();
+    double out = 0;
+    for (int j = 0; j < k.t.size(); j++) {
+        const int a = k.symbol(j);
+        out += k.t(j) * (k.log_f(j) + rho * (inner(j) - dc(a) - s2 * D_mat(a, j)));
+    }
+    return out;
+}
 
-        // Use same computation as original E_0_co
-        double m = (Q_mat.transpose() * pig1_mat * qg2rho).sum();
-        double mp = (Q_mat.transpose() * pig1_mat * (qg2rho.array() * logqg2.array()).matrix()).sum()
-                    - (1.0 / (1.0 + rho)) *
-                      (Q_mat.transpose() * (pig1_mat.array() * (-D_mat.array())).matrix() * qg2rho).sum();
+// cost(x) = |x|^2 - E_Q|X|^2 for every symbol, computed once per evaluation instead of per node
+static VectorXd symbol_costs() {
+    VectorXd costs = X_mat.cwiseAbs2();
+    return costs.array() - Q_mat.dot(costs);
+}
+
+// Alpha-parameterized E0(rho) in bits (alphas[i] tilts symbol i).
+double E_0(double rho, vector<double> alphas, int) {
+    const VectorXd alpha = Map<const VectorXd>(alphas.data(), alphas.size());
+    TiltedTerms k;
+    E_0_tilted(rho, -rho * alpha, alpha, k);
+    return -k.log_T / std::log(2);
+}
+
+// Cost-constrained E0(rho, r) in bits with its partial derivatives (bits) wrt r and rho: the dense
+// quadrature with tilts b_i = -r rho cost_i and c_a = r cost_a, differentiated in both at once.
+double E_0_cost(double r, double rho, double &grad_r, double &grad_rho) {
+    typedef Dual<double, 2> AD; // rho, r
+    const VectorXd costs = symbol_costs();
+    const AD rho_ad = AD::variable(rho, 0), r_ad = AD::variable(r, 1);
+    SymbolTilt<AD> tilt;
+    for (int i = 0; i < costs.size(); i++) {
+        tilt.b.push_back(-rho_ad * r_ad * costs(i));
+        tilt.c.push_back(r_ad * costs(i));
+    }
+    const AD e0 = E_0_co(rho_ad, Q_mat, tilt, dense_columns(), dense_weights());
+    grad_rho = e0.d[0];
+    grad_r = e0.d[1];
+    return e0.v;
+}
+
+// Channel dispersion V = Var(i(X;Y)) in bits^2 for the current Q, with i(x;y) = log W(y|x)/sum_i Q_i W(y|x_i).
+// The tilted kernel at rho = 0 with no tilt gives log f_j = -i(x_a; y_j) for every quadrature column and
+// t_j = Q_a w_j/pi, so this costs one pass over D. Also returns I(X;Y) = E[i] in bits. Requires setPI()/setW().
+double channel_dispersion(double &mutual_information) {
+    TiltedTerms k;
+    const VectorXd zero = VectorXd::Zero(Q_mat.size());
+    E_0_tilted(0, zero, zero, k);
+    const double mean = -k.t.dot(k.log_f);
+    const double second = k.t.dot(k.log_f.cwiseAbs2());
+    mutual_information = mean / std::log(2);
+    return std::max(second - mean * mean, 0.0) / (std::log(2) * std::log(2));
+}
+
+// Normal approximation of the error probability at blocklength n:
+//   Pe ~ Q((n(I - R) + log2(n)/2) / sqrt(n V)),  I in bits, V in bits^2.
+double normal_approximation(double mutual_information, double dispersion, double R, double n) {
+    const double shift = n * (mutual_information - R) + 0.5 * log2(n);
+    if (!(dispersion > 0)) return (shift > 0) ? 0.0 : 1.0;
+    return 0.5 * std::erfc(shift / std::sqrt(2.0 * n * dispersion));
+}
+
+// log Q(x) for the standard normal tail: erfc while Q(x) is far from underflowing, the asymptotic
+// series beyond (its first omitted term, 105/x^8, is below 2e-10 there)
+static double log_gaussian_tail(double x) {
+    if (x < 30.0) return std::log(0.5 * std::erfc(x / std::sqrt(2.0)));
+    const double x2 = x * x;
+    return -0.5 * x2 - std::log(x * std::sqrt(2.0 * PI)) + std::log1p(-1.0 / x2 + 3.0 / (x2 * x2) - 15.0 / (x2 * x2 * x2));
+}
+
+// Saddlepoint of the random-coding union (RCU) bound: rho_hat = argmax_{0<=rho<=1} E0(rho) - rho*R, found
+// by safeguarded Newton on E0'(rho) = R. Returns E0(rho_hat) and E0', E0'' there (bits). The channel
+// characterization does not depend on the blocklength, so rcu_saddlepoint() can then be evaluated for
+// any number of blocklengths. Requires setPI()/setW().
+double rcu_saddlepoint_point(double R, double &rho_hat, double &d1, double &d2) {
+    double e0 = E_0_co_derivatives(0, d1, d2);
+    if (d1 <= R) {
+        rho_hat = 0;
+        return e0;
+    }
+    double e1 = E_0_co_derivatives(1, d1, d2);
+    if (d1 >= R) {
+        rho_hat = 1;
+        return e1;
+    }
+    double lo = 0, hi = 1;
+    rho_hat = 0.5;
+    for (int it = 0; it < 50; it++) {
+        e0 = E_0_co_derivatives(rho_hat, d1, d2);
+        const double g = d1 - R;
+        if (std::abs(g) < 1e-12) break;
+        if (g > 0) lo = rho_hat; else hi = rho_hat;
+        double next = rho_hat - g / d2;
+        if (!(next > lo && next < hi)) next = 0.5 * (lo + hi);
+        if (std::abs(next - rho_hat) < 1e-14) break;
+        rho_hat = next;
+    }
+    return e0;
+}
 
-        double F0 = m / PI;
-        double Fder0 = mp / PI;
+// RCU saddlepoint approximation of the error probability at blocklength n from the output of
+// rcu_saddlepoint_point(). Under the rho_hat-tilted measure the log of (M-1) P[i(Xbar;Y) >= i(X;Y)] is
+// taken Gaussian, U ~ N(mu, sigma^2) with mu = n(R - E0'), sigma^2 = n V, V = -E0'' (nats), and
+//   Pe ~ exp(-n(E0 - rho_hat R)) E[exp(-rho_hat U) min(1, exp(U))].
+// For R_crit < R < I (mu = 0) this is exp(-n(E0 - rho R)) (psi_rho + psi_{1-rho}) with
+// psi_a = exp(n a^2 V/2) Q(a sqrt(nV)); it stays continuous below R_crit (rho_hat = 1) and above I (rho_hat = 0).
+double rcu_saddlepoint(double n, double R, double rho_hat, double e0, double d1, double d2) {
+    const double ln2 = std::log(2);
+    const double variance = std::max(-d2 * ln2, 0.0) * n;
+    const double mu = n * (R - d1) * ln2;
+    const double base = -n * (e0 - rho_hat * R) * ln2;
+
+    if (!(variance > 0)) { // deterministic U
+        const double value = (mu > 0) ? -rho_hat * mu : (1.0 - rho_hat) * mu;
+        return std::min(1.0, std::exp(base + value));
+    }
+    const double sigma = std::sqrt(variance);
+    const double a = rho_hat, b = 1.0 - rho_hat;
+    const double upper = -a * mu + 0.5 * a * a * variance + log_gaussian_tail((a * variance - mu) / sigma);
+    const double lower = b * mu + 0.5 * b * b * variance + log_gaussian_tail((mu + b * variance) / sigma);
+    const double top = std::max(upper, lower);
+    return std::min(1.0, std::exp(base + top + std::log(std::exp(upper - top) + std::exp(lower - top))));
+}
+
+// -- LOW-SNR SERIES --
+// For Y = sqrt(SNR)*X + Z, Z ~ CN(0,1), expanding Gallager's E0 around SNR = 0 gives (in nats)
+//   E0(rho) = c1(rho)*SNR + c2(rho)*SNR^2 + O(SNR^3)
+//   c1 = rho*s*P2,   c2 = s^3/2 * (rho^2*(P2^2 - P4) - rho*(P2^2 + |tau|^2)),   s = 1/(1+rho)
+// where P2 = E|X-mu|^2, P4 = E|X-mu|^4 and tau = E(X-mu)^2 are moments of the centered constellation
+// (E0 is invariant to translations of X). The ratio of consecutive terms is used to estimate the
+// truncation error of the series.
+struct LowSNRMoments {
+    double P2;
+    double P4;
+    double tau2; // |E (X-mu)^2|^2
+};
+
+static LowSNRMoments low_snr_moments(const complex<double>* X, const double* Q, int M) {
+    double Q_sum = 0.0;
+    complex<double> mu = 0.0;
+    for (int i = 0; i < M; i++) {
+        Q_sum += Q[i];
+        mu += Q[i] * X[i];
+    }
+    mu /= Q_sum;
+
+    LowSNRMoments m = {0.0, 0.0, 0.0};
+    complex<double> tau = 0.0;
+    for (int i = 0; i < M; i++) {
+        complex<double> x = X[i] - mu;
+        double p = abs_sq(x);
+        m.P2 += Q[i] * p;
+        m.P4 += Q[i] * p * p;
+        tau += Q[i] * x * x;
+    }
+    m.P2 /= Q_sum;
+    m.P4 /= Q_sum;
+    tau /= Q_sum;
+    m.tau2 = abs_sq(tau);
+    return m;
+}
+
+static LowSNRMoments low_snr_moments() {
+    return low_snr_moments(X_mat.data(), Q_mat.data(), Q_mat.size());
+}
+
+// |c2(rho)/c1(rho)|, well defined at rho = 0
+static double low_snr_term_ratio(const LowSNRMoments &m, double rho) {
+    const double s = 1.0 / (1.0 + rho);
+    return s * s * std::abs(rho * (m.P2 * m.P2 - m.P4) - (m.P2 * m.P2 + m.tau2)) / (2.0 * m.P2);
+}
 
-        // std::cout << "DEBUG hybrid log-space: m=" << m << ", PI=" << PI << ", F0=" << F0 << "\n";
+// Estimated truncation error (bits) of the series for E0(rho) and for E0'(rho)
+static double low_snr_truncation_error(const LowSNRMoments &m, double rho, double snr) {
+    const double s = 1.0 / (1.0 + rho);
+    const double ratio = low_snr_term_ratio(m, rho) * snr;
+    // the first-order coefficient and its derivative bound the magnitude of the expansion
+    const double c1 = std::max(rho * s * m.P2, s * s * m.P2);
+    return c1 * snr * ratio * ratio / (1.0 - ratio) / std::log(2);
+}
 
-        if (!std::isfinite(F0) || F0 <= 0) {
-            std::cerr << "ERROR: Invalid F0 in log-space computation: F0=" << F0 << "\n";
-            E0 = -1.0;
-            grad_rho = 0.0;
-            return -1.0;
-        }
+void setLowSNRTolerance(double tol) {
+    low_snr_tolerance = tol;
+}
 
-        grad_rho = -(Fder0) / (std::log(2) * F0);
-        E0 = -std::log2(F0);
+static bool low_snr_series_accurate(const LowSNRMoments &m, double snr) {
+    if (snr < 0 || low_snr_tolerance <= 0) return false;
+    if (!(m.P2 > 0)) return true; // single-point constellation: E0 is identically zero
+    // E0 at rho=1 (cutoff rate) and E0' at rho=0 (mutual information) bracket the solver's range
+    for (double rho: {0.0, 1.0}) {
+        if (low_snr_term_ratio(m, rho) * snr >= 0.5 || low_snr_truncation_error(m, rho, snr) > low_snr_tolerance)
+            return false;
+    }
+    return true;
+}
 
-        if (!std::isfinite(E0) || !std::isfinite(grad_rho)) {
-            std::cerr << "ERROR: Non-finite result in log-space: E0=" << E0 << ", grad=" << grad_rho << "\n";
-            E0 = -1.0;
-            grad_rho = 0.0;
-            return -1.0;
-        }
+bool useLowSNRSeries() {
+    low_snr_mode = low_snr_series_accurate(low_snr_moments(), SNR);
+    return low_snr_mode;
+}
 
-        // Clamp negative E0 to 0 (can't have negative error exponent)
-        // This can happen at very low SNR where channel capacity approaches 0,
-        // OR at very high SNR where numerical issues cause incorrect results
-        // NOTE: We do NOT zero grad_rho here! The gradient was computed correctly
-        // and represents valid derivative information. Specifically, grad_rho at rho=0
-        // is the mutual information I(X;Y), which should remain valid even when E0
-        // needs clamping due to numerical precision issues at high SNR.
-        if (E0 < 0) {
-            { std::ostringstream oss; oss << "WARNING: Negative E0=" << E0 << " (SNR=" << SNR << ", rho=" << rho << ") - clamping to 0.\n"; std::cerr << oss.str() << std::flush; }
-            E0 = 0.0;
-            // grad_rho intentionally NOT zeroed - it contains valid derivative info
-        }
+bool lowSNRSeriesFor(const complex<double>* X, const double* Q, int M, double snr) {
+    return low_snr_series_accurate(low_snr_moments(X, Q, M), snr);
+}
 
-        return E0;
-    } else {
-        // Extreme SNR case - compute E0 in pure log-space without exponentiating
-        { std::ostringstream oss; oss << "INFO: Extreme overflow detected (max_pig_arg=" << max_pig_arg << ", max_qg2_arg=" << max_qg2_arg << "), using pure log-space E0 computation\n"; std::cout << oss.str() << std::flush; }
+double E_0_co_low_snr(double r, double rho, double &grad_rho, double &E0) {
+    LowSNRMoments m = low_snr_moments();
+    if (!(m.P2 > 0)) {
+        E0 = 0.0;
+        grad_rho = 0.0;
+        return 0.0;
+    }
 
-        // Compute log_m (already done above in logqg2 computation)
-        // log_m = log(sum_j [ (sum_i Q_i * pig1[i,j]) * qg2rho[j] ])
-        Eigen::VectorXd log_m_components(cols);
-        Eigen::MatrixXd log_pig1_mat = PI_mat.array().log() + (rho / (1.0 + rho)) * D_mat.array();
+    const double s = 1.0 / (1.0 + rho);
+    const double g = rho * rho * (m.P2 * m.P2 - m.P4) - rho * (m.P2 * m.P2 + m.tau2);
+    const double g_prime = 2.0 * rho * (m.P2 * m.P2 - m.P4) - (m.P2 * m.P2 + m.tau2);
 
-        for (int j = 0; j < cols; j++) {
-            Eigen::VectorXd inner_log_terms = Q_mat.array().log() + log_pig1_mat.col(j).array();
-            double log_inner_sum = log_sum_exp(inner_log_terms);
-            log_m_components(j) = log_inner_sum + rho * logqg2(j);
-        }
-        double log_m = log_sum_exp(log_m_components);
+    const double c1 = rho * s * m.P2;
+    const double c1_prime = s * s * m.P2;
+    const double c2 = 0.5 * s * s * s * g;
+    const double c2_prime = 0.5 * (s * s * s * g_prime - 3.0 * s * s * s * s * g);
 
-        // Compute E0 = -log2(F0) = -log2(m/PI) = -log2(m) + log2(PI)
-        double log2_m = log_m / std::log(2);
-        double log2_PI = std::log(PI) / std::log(2);
-        E0 = -log2_m + log2_PI;
+    E0 = (c1 * SNR + c2 * SNR * SNR) / std::log(2);
+    grad_rho = (c1_prime * SNR + c2_prime * SNR * SNR) / std::log(2);
+    return E0;
+}
 
-        // std::cout << "DEBUG pure log-space: log_m=" << log_m << ", log2_m=" << log2_m
-        //           << ", log2_PI=" << log2_PI << ", E0=" << E0 << "\n";
+// Exponents per E_0_co_tiled call (M * M*n*n) below which splitting the tiles over kernel threads
+// costs more than it saves
+static const double KERNEL_PARALLEL_MIN_CELLS = 1 << 20;
 
-        // Compute gradient numerically using finite differences
-        // This is more robust than analytical gradient in extreme overflow case
-        double delta_rho = 1e-6;
-        double rho_plus = rho + delta_rho;
-        double s_plus = 1.0 / (1.0 + rho_plus);
+// m and mp of a set of columns, relative to the largest log term seen so far
+struct TileSums {
+    double log_max = -std::numeric_limits<double>::infinity();
+    double sum_m = 0.0;
+    double sum_mp = 0.0;
 
-        // Recompute logqg2 for rho_plus (it depends on s = 1/(1+rho))
-        Eigen::VectorXd logqg2_plus(cols);
-        for (int j = 0; j < cols; j++) {
-            Eigen::VectorXd log_terms_plus = Q_mat.array().log() - s_plus * D_mat.col(j).array();
-            logqg2_plus(j) = log_sum_exp(log_terms_plus);
+    void add(double log_term, double factor) {
+        if (log_term > log_max) {
+            const double rescale = std::exp(log_max - log_term);
+            sum_m = sum_m * rescale + 1.0;
+            sum_mp = sum_mp * rescale + factor;
+            log_max = log_term;
+        } else {
+            const double t = std::exp(log_term - log_max);
+            sum_m += t;
+            sum_mp += t * factor;
         }
+    }
 
-        // Compute E0 at rho + delta
-        Eigen::VectorXd log_m_components_plus(cols);
-        Eigen::MatrixXd log_pig1_mat_plus = PI_mat.array().log() + (rho_plus / (1.0 + rho_plus)) * D_mat.array();
+    void merge(const TileSums &other) {
+        if (other.sum_m == 0.0) return;
+        if (other.log_max > log_max) {
+            const double rescale = std::exp(log_max - other.log_max);
+            sum_m = sum_m * rescale + other.sum_m;
+            sum_mp = sum_mp * rescale + other.sum_mp;
+            log_max = other.log_max;
+        } else {
+            const double t = std::exp(other.log_max - log_max);
+            sum_m += t * other.sum_m;
+            sum_mp += t * other.sum_mp;
+        }
+    }
+};
+
+// d/drho of log(w_k qg2^rho exp(rho s |z_k|^2)), the factor of its term in mp: with ds/drho = -s^2
+// and d log qg2/ds = -<D>, the mean of D_ik under the weights of qg2, it is
+//   log qg2 + s |z_k|^2 - rho s^2 (|z_k|^2 - <D>) = log qg2 + s^2 (|z_k|^2 + rho <D>)
+static inline double tile_factor(double rho, double s, double logqg2, double z_D, double mean_D) {
+    return logqg2 + s * s * (z_D + rho * mean_D);
+}
+
+// Everything a tile is generated from; plain locals, so kernel threads never touch the caller's
+// thread_local engine state
+struct TileInputs {
+    int M, n;
+    double rho, s;
+    VectorXd x_re, x_im, Q, log_Q; // sqrt(SNR) x_i
+    VectorXd roots;                // 1D nodes: z_k = roots(k / n) + j roots(k % n)
+    VectorXd z_D, log_w;           // |z_k|^2 and log w_k, k < n*n
+};
+
+// The n*n columns of symbol a. Because |d + z|^2 = (Re d + Re z)^2 + (Im d + Im z)^2 on the tensor
+// grid, with d = sqrt(SNR)(x_a - x_i),
+//   qg2(k1*n + k2) = sum_i [Q_i exp(-s (Re d_i + roots(k1))^2)] [exp(-s (Im d_i + roots(k2))^2)]
+//                  = (ER^T EI)(k1, k2)
+// so the two M x n tables take 2*M*n exponentials and the M*n*n products are one matrix product; the
+// same tables weighted by the squared offsets give sum_i Q_i D_ik exp(-s D_ik) = (DR^T EI + ER^T DI).
+// Every factor is at most 1, and the i = a factors alone bound qg2 below by Q_a exp(-s |z|^2).
+struct TileBuffers {
+    MatrixXd ER, EI, DR, DI, G, GD;
+
+    TileBuffers(int M, int n) : ER(M, n), EI(M, n), DR(M, n), DI(M, n), G(n, n), GD(n, n) {}
+};
+
+static void e0_tile(const TileInputs &in, int a, TileBuffers &b, TileSums &sums) {
+    if (!(in.Q(a) > 0)) return;
+    const VectorXd d_re = in.x_re(a) - in.x_re.array();
+    const VectorXd d_im = in.x_im(a) - in.x_im.array();
+    for (int k = 0; k < in.n; k++) {
+        const ArrayXd re2 = (d_re.array() + in.roots(k)).square(), im2 = (d_im.array() + in.roots(k)).square();
+        b.ER.col(k) = in.Q.array() * (-in.s * re2).exp();
+        b.EI.col(k) = (-in.s * im2).exp();
+        b.DR.col(k) = b.ER.col(k).array() * re2;
+        b.DI.col(k) = b.EI.col(k).array() * im2;
+    }
+    b.G.noalias() = b.ER.transpose() * b.EI;
+    b.GD.noalias() = b.DR.transpose() * b.EI;
+    b.GD.noalias() += b.ER.transpose() * b.DI;
+
+    for (int k1 = 0; k1 < in.n; k1++) {
+        for (int k2 = 0; k2 < in.n; k2++) {
+            const int k = k1 * in.n + k2;
+            const double logqg2 = std::log(b.G(k1, k2));
+            const double log_term = in.log_Q(a) + in.log_w(k) + in.rho * in.s * in.z_D(k) + in.rho * logqg2;
+            sums.add(log_term, tile_factor(in.rho, in.s, logqg2, in.z_D(k), b.GD(k1, k2) / b.G(k1, k2)));
+        }
+    }
+}
+
+// E_0_co without D_mat and PI_mat. Only row a of PI is nonzero in the columns of symbol a, so
+//   m  = sum_{a,k} Q_a w_k exp(rho*s*|z_k|^2) qg2(j)^rho,  j = a*n*n + k
+//   mp = sum_{a,k} (same term) (log qg2(j) + s^2 (|z_k|^2 + rho <D>(j)))
+// with qg2(j) = sum_i Q_i exp(-s*|sqrt(SNR)(x_a - x_i) + z_k|^2) and <D>(j) the mean distance under
+// those weights (tile_factor). Each tile is the n*n columns of one
+// symbol, built from factorized exponential tables (e0_tile) that fit in L1/L2, so nothing of size
+// M*M*n*n ever goes through memory and the exponentials drop from M*M*n*n to 2*M*M*n. The terms are
+// accumulated relative to a running maximum, which also makes this overflow-free at any SNR. Symbols
+// are dealt round-robin to the kernel threads (setTiledEvaluation) when the work is large enough, and
+// the per-thread sums are merged in thread order.
+double E_0_co_tiled(double r, double rho, double &grad_rho, double &E0) {
+    TileInputs in;
+    in.M = Q_mat.size();
+    in.n = static_cast<int>(std::lround(std::sqrt(static_cast<double>(stream_nodes.size()))));
+    in.rho = rho;
+    in.s = 1.0 / (1.0 + rho);
+    in.x_re = sqrt(SNR) * X_mat.real();
+    in.x_im = sqrt(SNR) * X_mat.imag();
+    in.Q = Q_mat;
+    in.log_Q = Q_mat.array().log();
+    in.roots.resize(in.n);
+    for (int k = 0; k < in.n; k++) in.roots(k) = stream_nodes(k).imag(); // stream_nodes(k) = roots(0) + j roots(k) for k < n
+    in.z_D = stream_nodes.array().abs2();
+    in.log_w = stream_weights.array().log();
+
+    int threads = kernel_threads > 0 ? kernel_threads : default_kernel_threads.load();
+    if (static_cast<double>(in.M) * in.M * in.n * in.n < KERNEL_PARALLEL_MIN_CELLS) threads = 1;
+    threads = std::max(1, std::min(threads, in.M));
+
+    vector<TileSums> sums(threads);
+    auto run = [&](int t) {
+        TileBuffers buffers(in.M, in.n);
+        for (int a = t; a < in.M; a += threads) e0_tile(in, a, buffers, sums[t]);
+    };
+    vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(run, t);
+    run(0);
+    for (auto &t: pool) t.join();
+    for (int t = 1; t < threads; t++) sums[0].merge(sums[t]);
+
+    // F0 = m / PI, F0' = mp / PI
+    E0 = -(sums[0].log_max + std::log(sums[0].sum_m) - std::log(PI)) / std::log(2);
+    grad_rho = -(sums[0].sum_mp / sums[0].sum_m) / std::log(2);
+    return E0;
+}
 
-        for (int j = 0; j < cols; j++) {
-            Eigen::VectorXd inner_log_terms_plus = Q_mat.array().log() + log_pig1_mat_plus.col(j).array();
-            double log_inner_sum_plus = log_sum_exp(inner_log_terms_plus);
-            log_m_components_plus(j) = log_inner_sum_plus + rho_plus * logqg2_plus(j);
+// E_0_co_tiled with the inner sums qg2(a, k) = sum_i Q_i exp(-s |y - sqrt(SNR) x_i|^2), at the M*n*n
+// received points y = sqrt(SNR) x_a + z_k, taken from a fast Gauss transform of bandwidth
+// h = 1/sqrt(s) (fast_gauss.h) rather than summed over all M symbols: O(M + M*n*n) per evaluation
+// instead of O(M*M*n*n) once clusters are small against the spread of the constellation; otherwise
+// the evaluation falls back to the exact E_0_co_tiled. The transform is accurate to
+// fast_gauss_tolerance (absolute, with sum Q = 1); the exact self term Q_a exp(-s |z_k|^2) is a lower
+// bound of qg2 and keeps its log finite. The mean distance <D> of the rho derivative comes from the
+// distance-weighted expansions of the same transform.
+double E_0_co_fast_gauss(double r, double rho, double &grad_rho, double &E0) {
+    const int M = Q_mat.size();
+    const int nn = stream_nodes.size();
+    const double s = 1.0 / (1.0 + rho);
+    vector<complex<double>> sources(M);
+    vector<double> weights(M);
+    for (int i = 0; i < M; i++) {
+        sources[i] = sqrt(SNR) * X_mat(i);
+        weights[i] = Q_mat(i);
+    }
+    const FastGaussTransform transform(sources, weights, 1.0 / std::sqrt(s), fast_gauss_tolerance_in_use());
+
+    // direct summation costs about M multiply-adds per received point (e0_tile, vectorized), a Horner
+    // step of the transform about FAST_GAUSS_TERM_COST of them; when the clusters are too few and too
+    // wide for the transform to beat that (low and moderate SNR), sum directly
+    double work = 0.0;
+    for (int a = 0; a < M; a++) work += transform.work(sources[a]);
+    if (FAST_GAUSS_TERM_COST * work / M > M) {
+        return E_0_co_tiled(r, rho, grad_rho, E0);
+    }
+    const VectorXd z_D = stream_nodes.array().abs2();
+    const VectorXd log_w = stream_weights.array().log();
+    const VectorXcd nodes = stream_nodes;
+
+    int threads = kernel_threads > 0 ? kernel_threads : default_kernel_threads.load();
+    if (static_cast<double>(M) * nn * transform.order() * transform.order() < KERNEL_PARALLEL_MIN_CELLS) threads = 1;
+    threads = std::max(1, std::min(threads, M));
+
+    vector<TileSums> sums(threads);
+    auto run = [&](int t) {
+        for (int a = t; a < M; a += threads) {
+            if (!(weights[a] > 0)) continue;
+            const double log_Q = std::log(weights[a]);
+            for (int k = 0; k < nn; k++) {
+                const double self = weights[a] * std::exp(-s * z_D(k));
+                double qg2;
+                double mean_D = transform.distance(sources[a] + nodes(k), qg2) / qg2;
+                if (!(qg2 > self)) { // the self term alone, at distance |z_k|^2
+                    qg2 = self;
+                    mean_D = z_D(k);
+                }
+                const double logqg2 = std::log(qg2);
+                sums[t].add(log_Q + log_w(k) + rho * s * z_D(k) + rho * logqg2, tile_factor(rho, s, logqg2, z_D(k), mean_D));
+            }
         }
-        double log_m_plus = log_sum_exp(log_m_components_plus);
-        double E0_plus = -(log_m_plus / std::log(2)) + log2_PI;
+    };
+    vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(run, t);
+    run(0);
+    for (auto &t: pool) t.join();
+    for (int t = 1; t < threads; t++) sums[0].merge(sums[t]);
+
+    E0 = -(sums[0].log_max + std::log(sums[0].sum_m) - std::log(PI)) / std::log(2);
+    grad_rho = -(sums[0].sum_mp / sums[0].sum_m) / std::log(2);
+    return E0;
+}
 
-        // Numerical gradient: dE0/drho ≈ (E0(rho+δ) - E0(rho)) / δ
-        grad_rho = (E0_plus - E0) / delta_rho;
+// Nodes y_g = center + (g - (count-1)/2) h covering [lo, hi], for the global grid
+static VectorXd grid_axis(double lo, double hi, double h) {
+    const int count = static_cast<int>(std::ceil((hi - lo) / h)) + 1;
+    const double first = 0.5 * (lo + hi) - 0.5 * (count - 1) * h;
+    return VectorXd::LinSpaced(count, first, first + (count - 1) * h);
+}
 
-        // std::cout << "DEBUG pure log-space gradient: E0=" << E0 << ", E0_plus=" << E0_plus
-        //           << ", grad_rho=" << grad_rho << "\n";
+// Accuracy the global grid is sized for, in bits of E0 and of its rho derivative
+static const double GRID_TOLERANCE = 1e-7;
+static const double GRID_FACTOR_CUTOFF = 300.0; // a product of two factors stays a normal double
 
-        if (!std::isfinite(E0)) {
-            std::cerr << "ERROR: Non-finite E0 in pure log-space: " << E0 << "\n";
-            E0 = -1.0;
-            return -1.0;
-        }
+// Lattice spacing at s = 1/(1+rho) and reach past the outermost symbols (see E_0_co_global_grid)
+static double grid_spacing(double s) {
+    return 2.0 * PI * PI / (s * std::pow(4.0 / 3.0 * -std::log(GRID_TOLERANCE), 1.5));
+}
 
-        // NOTE: At very high SNR (SNR >> 100), E0 can become negative due to numerical limitations
-        // of the quadrature approximation. This indicates the SNR is too high for accurate computation
-        // with the current number of quadrature points (N).
-        // For now, we clamp to 0 as a fallback, but this means results may be inaccurate.
-        if (E0 < 0) {
-            { std::ostringstream oss; oss << "WARNING: Negative E0=" << E0 << " at high SNR - clamping to 0. Consider increasing N or using asymptotic approximation.\n"; std::cerr << oss.str() << std::flush; }
-            E0 = 0.0;
-        }
+static double grid_reach() {
+    return std::sqrt(-std::log(GRID_TOLERANCE));
+}
 
-        return E0;
-    }
+int globalGridAxisPoints(double width, double rho) {
+    return static_cast<int>(std::ceil((width + 2.0 * grid_reach()) / grid_spacing(1.0 / (1.0 + rho)))) + 1;
 }
 
-double E_0_co(double r, double rho, double &grad_rho, double &E0) {
-    // does not compute second der
+// The four M x G tables and the two lattice-sized products F and FD
+size_t globalGridPeakBytes(int M, int rows, int cols) {
+    return (2 * static_cast<size_t>(M) * (rows + cols) + 2 * static_cast<size_t>(rows) * cols) * sizeof(double);
+}
 
-    // *** OVERFLOW DETECTION: Check D_mat BEFORE exponentiating ***
-    double check_factor = -1.0 / (1.0 + rho);
-    double max_D = D_mat.maxCoeff();
-    double min_D = D_mat.minCoeff();
-    double max_exp_arg = std::abs(check_factor * max_D);
-    double min_exp_arg = std::abs(check_factor * min_D);
-
-    const double OVERFLOW_THRESHOLD = 700.0;  // exp(709) overflows double
-
-    // Check if we should use log-space (either forced or threshold exceeded)
-    bool use_log_space = force_log_space_mode ||
-                         max_exp_arg > OVERFLOW_THRESHOLD ||
-                         min_exp_arg > OVERFLOW_THRESHOLD;
-
-    if (use_log_space) {
-        // Only print message if actually switching due to overflow (not forced)
-        // if (!force_log_space_mode && (max_exp_arg > OVERFLOW_THRESHOLD || min_exp_arg > OVERFLOW_THRESHOLD)) {
-        //     std::cout << "\n=== Switching to log-space computation (SNR=" << SNR << ", rho=" << rho << ") ===\n";
-        // }
-
-        // Use log-space version
-        return E_0_co_log_space(r, rho, grad_rho, E0);
-    }
-
-    Eigen::VectorXd logqg2 = (Q_mat.transpose() * ((-1.0 / (1.0 + rho)) * D_mat.array()).exp().matrix()).array().log();
-    // Before qg2rho = exp(rho * logqg2):
-    double max_log = logqg2.maxCoeff();
-    double min_log = logqg2.minCoeff();
-    //cout << "should print" << endl;
-    if (abs(rho * max_log) > 700) { // exp(709) overflows double
-        std::cout << "err1: Exponentiation overflow/underflow risk: " << rho * max_log << "\n";
-    } else if (rho * min_log < -700) {
-
-    }
-    Eigen::VectorXd qg2rho = (rho * logqg2.array()).exp();
-    Eigen::MatrixXd pig1_mat = PI_mat.array() * ((rho / (1.0 + rho)) * D_mat.array()).exp();
-
-    // In E_0_co(), after computing D_mat:
-    if (D_mat.hasNaN()) std::cout << "err2: NaN in D_mat!\n";
-    if (D_mat.minCoeff() < 0) std::cout << "err3: Negative values in D_mat!\n";
-
-    // After computing logqg2:
-    if (logqg2.hasNaN()) std::cout << "err4: NaN in logqg2!\n";
-    if (logqg2.minCoeff() == -std::numeric_limits<double>::infinity()) std::cout << "err5: -inf in logqg2!\n";
-    //cout << "n: " << n << endl;
-    //cout << "PI_mat size: " << PI_mat.rows() << " " << PI_mat.cols() << endl;
-    //cout << PI_mat << endl;
-    //cout << "D_mat  size: " << D_mat .rows() << " " << D_mat.cols() << endl;
-    //cout << D_mat << endl;
-
-    const int sizeX = Q_mat.size();
+// E_0_co with one grid of received points y shared by all transmitted symbols. With
+// F(y) = sum_i Q_i exp(-s |y - sqrt(SNR) x_i|^2), the outer sum over a collapses:
+//   E0  = -log2( 1/pi * integral F(y)^(1+rho) dy )
+//   E0' = -(1/ln2) integral F^(1+rho) (log F + s <D>) / integral F^(1+rho),
+//   <D> = sum_i Q_i D_i exp(-s D_i) / F,  D_i = |y - sqrt(SNR) x_i|^2
+// The integral is a trapezoidal rule on a square lattice, sized from its error bound rather than
+// from N. Around one symbol F^(1+rho) is the Gaussian exp(-|y - x|^2), whose aliasing error is
+// exp(-pi^2 / h^2); the bound comes from two symbols at distance d, where the two terms of F cancel
+// at a distance pi / (2 s d) from the real axis and F^(1+rho) is about exp(-d^2 / 4). The aliasing
+// error there is exp(-d^2 / 4 - pi^2 / (s d h)), largest at d^3 = 2 pi^2 / (s h) where it is
+// exp(-3 d^2 / 4), so h = 2 pi^2 / (s (4/3 log(1/tol))^(3/2)) holds it under GRID_TOLERANCE at any
+// SNR. Past the outermost symbols the integrand falls as exp(-t^2), so the lattice reaches
+// sqrt(log(1/tol)) beyond them. Both axes are tensor factors, so F and sum_i Q_i D_i exp(-s D_i)
+// come from M x G tables and matrix products as in e0_tile: M * G exponentials and one log per
+// lattice point, instead of one inner sum per (symbol, node) pair.
+double E_0_co_global_grid(double r, double rho, double &grad_rho, double &E0) {
     const double s = 1.0 / (1.0 + rho);
-    const double s_prime = -1.0 / pow(1.0 + rho, 2);
-
-    double m = (Q_mat.transpose() * pig1_mat * qg2rho).sum();
-    double mp = (Q_mat.transpose() * pig1_mat * (qg2rho.array() * logqg2.array()).matrix()).sum()
-                - (1.0 / (1.0 + rho)) *
-                  (Q_mat.transpose() * (pig1_mat.array() * (-D_mat.array())).matrix() * qg2rho).sum();
+    const VectorXd x_re = sqrt(SNR) * X_mat.real();
+    const VectorXd x_im = sqrt(SNR) * X_mat.imag();
+    const double reach = grid_reach();
+    const double h = grid_spacing(s);
+    const VectorXd y_re = grid_axis(x_re.minCoeff() - reach, x_re.maxCoeff() + reach, h);
+    const VectorXd y_im = grid_axis(x_im.minCoeff() - reach, x_im.maxCoeff() + reach, h);
+
+    // tables[0] = Q_i exp(-s d^2) and tables[1] = Q_i d^2 exp(-s d^2) on the real axis (Q folded in),
+    // the same without Q on the imaginary axis. Factors under exp(-GRID_FACTOR_CUTOFF) are flushed to
+    // zero: at high SNR most of the lattice is far from every symbol, and products of such factors
+    // would be subnormal, which the matrix products run orders of magnitude slower on
+    auto tables = [&](const VectorXd &x, const VectorXd &y, bool with_Q, MatrixXd &E, MatrixXd &DE) {
+        E.resize(x.size(), y.size());
+        DE.resize(x.size(), y.size());
+        for (int g = 0; g < y.size(); g++) {
+            const ArrayXd d2 = (y(g) - x.array()).square();
+            E.col(g) = (s * d2 < GRID_FACTOR_CUTOFF).select((-s * d2).exp(), 0.0);
+            if (with_Q) E.col(g).array() *= Q_mat.array();
+            DE.col(g) = E.col(g).array() * d2;
+        }
+    };
+    MatrixXd ER, DR, EI, DI;
+    tables(x_re, y_re, true, ER, DR);
+    tables(x_im, y_im, false, EI, DI);
+    const MatrixXd F = ER.transpose() * EI;
+    const MatrixXd FD = DR.transpose() * EI + ER.transpose() * DI;
+
+    TileSums sums;
+    const double log_cell = 2.0 * std::log(h);
+    for (int g2 = 0; g2 < F.cols(); g2++) {
+        for (int g1 = 0; g1 < F.rows(); g1++) {
+            if (!(F(g1, g2) > 0)) continue; // far from every symbol: underflowed, negligible
+            const double log_F = std::log(F(g1, g2));
+            sums.add(log_cell + (1.0 + rho) * log_F, log_F + s * FD(g1, g2) / F(g1, g2));
+        }
+    }
+
+    E0 = -(sums.log_max + std::log(sums.sum_m) - std::log(PI)) / std::log(2);
+    grad_rho = -(sums.sum_mp / sums.sum_m) / std::log(2);
+    return E0;
+}
 
-    // Before F0 = m/PI:
-    if (std::abs(m) < 1e-300) std::cout << "err6: Near-zero m: " << m << "\n";
-    if (std::abs(PI) < 1e-300) std::cout << "err7: Near-zero PI: " << PI << "\n";
-    double F0 = m / PI;
-    double Fder0 = mp / PI;
+double E_0_co(double r, double rho, double &grad_rho, double &E0) {
+    // does not compute second der
 
-    grad_rho = -(Fder0) / (std::log(2) * F0);
-    // After computing grad_rho:
-    if (!std::isfinite(grad_rho)) {
-        std::cout << "err8: Non-finite gradient: " << grad_rho
-                  << " at rho=" << rho << " SNR=" << SNR << "\n";
+    if (low_snr_mode) {
+        return E_0_co_low_snr(r, rho, grad_rho, E0);
+    }
+    if (quadrature_mode == EP_EVAL_GLOBAL_GRID) {
+        return E_0_co_global_grid(r, rho, grad_rho, E0);
+    }
+    if (quadrature_mode == EP_EVAL_FAST_GAUSS) {
+        return E_0_co_fast_gauss(r, rho, grad_rho, E0);
+    }
+    if (quadrature_mode != EP_EVAL_DENSE) {
+        return E_0_co_tiled(r, rho, grad_rho, E0);
     }
-    E0 = -log2(F0);
-
-    // DEBUG: Print key intermediates
-    //std::cout << "\n==== Eigen Version ====\n";
-    /*
-    std::cout << "logqg2[0]: " << logqg2(0) << std::endl;
-    std::cout << "qg2rho[0]: " << qg2rho(0) << std::endl;
 
-    Eigen::VectorXd pig1_first_col = pig1_mat.col(0);
-    std::cout << "pig1_mat(0,0): " << pig1_first_col(0) << std::endl;
-    */
-    /*
-    std::cout << "m: " << m << " | mp: " << mp << std::endl;
-    std::cout << "F0: " << F0 << " | Fder0: " << Fder0 << std::endl;
-     */
-    /*
-    cout << "PI_mat: " << endl << PI_mat << endl;
-    cout << "D_mat: " << endl << D_mat << endl;
-    cout << "Q_mat: " << endl << Q_mat << endl;
-    cout << "logqg2_mat: " << endl << logqg2 << endl;
-    cout << "qg2rho_mat: " << endl << qg2rho << endl;
-    cout << "pig1_mat: " << endl << pig1_mat << endl;
-    */
-    /*
-    // In both functions:
-    const int test_j = 1;
-    const int test_i = 0;
-    // Eigen Version:
-    std::cout << "Eigen PI_mat(0,1): " << PI_mat(0, test_j) << std::endl;
-
-      // In both versions:
-    const int test_block = 1; // Second block (i=1)
-    const int test_col = test_block * n*n + 0; // First column of second block
-    const int test_row = 3;
-
-    // Eigen
-    std::cout << "Eigen PI(" << test_row << "," << test_col << "): "
-              << PI_mat(test_row, test_col) << "\n";
-
-    // Check D_mat(0, n*n) - first element of second block
-    const int d_test_col = n*n;
-    const int d_test_row = 5;
-
-    // Eigen
-    std::cout << "Eigen D(" << d_test_row << "," << d_test_col << "): "
-              << D_mat(d_test_row, d_test_col) << "\n";
-
-    // Check pig1_mat for column j=1, row i=0
-    const int p_test_j = 3;
-    const int p_test_i = 4;
-    const int p_idx = p_test_j * sizeX + p_test_i;
-
-    // Eigen
-    std::cout << "Eigen pig1(" << p_test_i << "," << p_test_j << "): "
-              << pig1_mat(p_test_i, p_test_j) << "\n";
-
-    // Check contribution to `m` from column j=1
-    const int m_test_j = 1;
-    double m_contribution = 0.0;
-
-    // Eigen
-    Eigen::VectorXd pig1_col = pig1_mat.col(m_test_j);
-    double eigen_sum_pig1 = (Q_mat.transpose() * pig1_col).sum();
-    double eigen_temp = eigen_sum_pig1 * qg2rho[m_test_j];
-    std::cout << "Eigen m contribution j=1: " << eigen_temp << "\n";
-
-    // Check a high-D_mat value (e.g., j=256)
-    const int ttest_j = 18;
-    const int ttest_i = 20;
-    const int idx = ttest_j * sizeX + ttest_i;
-
-// Eigen
-    std::cout << "Eigen pig1(" << ttest_i << "," << ttest_j << "): "
-              << pig1_mat(ttest_i, ttest_j) << "\n";
-    */
+    // E0 and its rho-derivative in one pass of the dense quadrature
+    typedef Dual<double, 1> AD;
+    const AD e0 = E_0_co(AD::variable(rho, 0), Q_mat, NoTilt(), dense_columns(), dense_weights());
+    E0 = e0.v;
+    grad_rho = e0.d[0];
     return E0;
 }
 
-double E_0_co_vec(double r, double rho, double &grad_rho, double e0, int nn,
-                  std::vector<double> hweights, std::vector<double> multhweights,
-                  std::vector<double> roots,
+double E_0_co_vec(double, double rho, double &grad_rho, double e0, int,
+                  std::vector<double>, std::vector<double>,
+                  std::vector<double>,
                   const std::vector<double> &Q_mat,
                   const std::vector<double> &PI_mat,
                   const std::vector<double> &D_mat) {
-
-    const int cols = n * n * sizeX;
-    const double inv_1prho = 1.0 / (1.0 + rho);
-    const double rho_over_1prho = rho * inv_1prho;
-
-    // 1. Precompute logqg2 and qg2rho ------------------------------------------
-    std::vector<double> logqg2(cols);
-    std::vector<double> qg2rho(cols);
-
-    for (int j = 0; j < cols; ++j) {
-        double sum = 0.0;
-        for (int i = 0; i < sizeX; ++i) {
-            const int idx = j * sizeX + i;
-            sum += Q_mat[i] * exp(-D_mat[idx] * inv_1prho);
-        }
-        logqg2[j] = log(sum);
-        qg2rho[j] = exp(rho * logqg2[j]);
-    }
-
-    // 2. Precompute pig1_mat --------------------------------------------------
-    std::vector<double> pig1_mat(sizeX * cols);
-    for (int j = 0; j < cols; ++j) {
-        for (int i = 0; i < sizeX; ++i) {
-            const int idx = j * sizeX + i;
-            // FIXED: Add parentheses around exponent argument
-            pig1_mat[idx] = PI_mat[idx] * exp((rho / (1.0 + rho)) * D_mat[idx]);
-        }
-    }
-
-    // 3. Compute m and mp -----------------------------------------------------
-    double m = 0.0, term1_mp = 0.0, term2_mp = 0.0;
-
-    for (int j = 0; j < cols; ++j) {
-        double sum_pig1 = 0.0, sum_pig1_D = 0.0;
-
-        for (int i = 0; i < sizeX; ++i) {
-            const int idx = j * sizeX + i;
-            const double Q_i = Q_mat[i];
-            sum_pig1 += Q_i * pig1_mat[idx];
-            sum_pig1_D += Q_i * pig1_mat[idx] * (-D_mat[idx]);
-        }
-
-        const double temp = sum_pig1 * qg2rho[j];
-        m += temp;
-        term1_mp += temp * logqg2[j];
-        term2_mp += sum_pig1_D * qg2rho[j];
-    }
-
-    term2_mp *= inv_1prho;
-    const double mp = term1_mp - term2_mp;
-
-
-    // 4. Final calculations ---------------------------------------------------
-    const double F0 = m / PI;
-    const double Fder0 = mp / PI;
-    grad_rho = -Fder0 / (std::log(2) * F0);
-    e0 = -log2(F0);
-
-    // DEBUG: Print same intermediates
-    // std::cout << "\n==== Vector Version ====\n";
-    /*
-    std::cout << "logqg2[0]: " << logqg2[0] << std::endl;
-    std::cout << "qg2rho[0]: " << qg2rho[0] << std::endl;
-    std::cout << "pig1_mat[0]: " << pig1_mat[0] << std::endl;
-    */
-    // std::cout << "m: " << m << " | mp: " << mp << std::endl;
-    // std::cout << "F0: " << F0 << " | Fder0: " << Fder0 << std::endl;
-    /*
-    cout << "Q_mat:" << endl;
-    for(int i = 0; i < Q_mat.size(); i++){ cout << Q_mat[i] << " "; }
-    cout << endl;
-    cout << "D_mat:" << endl;
-    for(int i = 0; i < D_mat.size(); i++){ cout << D_mat[i] << " "; }
-    cout << endl;
-    cout << "PI_mat:" << endl;
-    for(int i = 0; i < PI_mat.size(); i++){ cout << PI_mat[i] << " "; }
-    cout << endl;
-    cout << "logqg2_mat:" << endl;
-    for(int i = 0; i < logqg2.size(); i++){ cout << logqg2[i] << " "; }
-    cout << endl;
-
-    cout << "qg2rho_mat:" << endl;
-    for(int i = 0; i < qg2rho.size(); i++){ cout << qg2rho[i] << " "; }
-    cout << endl;
-
-    cout << "pig1_mat:" << endl;
-    for(int i = 0; i < pig1_mat.size(); i++){ cout << pig1_mat[i] << " "; }
-    cout << endl;
-    */
-
-/*
-    const int test_idx = 1 * sizeX + 0;  // Column-major index for (row=0, col=1)
-    std::cout << "Vector PI[1]: " << PI_mat[test_idx] << "\n";
-    // In both versions:
-    const int test_block = 1; // Second block (i=1)
-    const int test_col = test_block * n*n + 0; // First column of second block
-    const int test_row = 3;
-
-    // Vector
-    const int vec_idx = test_col * sizeX + test_row; // Column-major index
-    std::cout << "Vector PI[" << vec_idx << "]: " << PI_mat[vec_idx] << "\n";
-
-    // Check D_mat(0, n*n) - first element of second block
-    const int d_test_col = n*n;
-    const int d_test_row = 5;
-
-    // Vector
-    const int d_vec_idx = d_test_col * sizeX + d_test_row;
-    std::cout << "Vector D[" << d_vec_idx << "]: " << D_mat[d_vec_idx] << "\n";
-
-    // Check pig1_mat for column j=1, row i=0
-    const int p_test_j = 3;
-    const int p_test_i = 4;
-    const int p_idx = p_test_j * sizeX + p_test_i;
-
-    // Vector
-    std::cout << "Vector pig1[" << p_idx << "]: " << pig1_mat[p_idx] << "\n";
-
-    // Check contribution to `m` from column j=1
-    const int m_test_j = 1;
-    double m_contribution = 0.0;
-    // Vector
-    double vec_sum_pig1 = 0.0;
-    for(int i = 0; i < sizeX; ++i) {
-        const int idx = m_test_j * sizeX + i;
-        vec_sum_pig1 += Q_mat[i] * pig1_mat[idx];
-    }
-    double vec_temp = vec_sum_pig1 * qg2rho[m_test_j];
-    std::cout << "Vector m contribution j=1: " << vec_temp << "\n";
-
-    // Check a high-D_mat value (e.g., j=256)
-    const int ttest_j = 18;
-    const int ttest_i = 20;
-    const int idx = ttest_j * sizeX + ttest_i;
-
-// Vector
-    std::cout << "Vector pig1[" << idx << "]: " << pig1_mat[idx] << "\n";
-    */
+    // E_0_co on column-major copies of Q, PI and D
+    const int M = static_cast<int>(Q_mat.size()), nodes = n * n;
+    vector<double> weights(nodes);
+    for (int k = 0; k < nodes; k++) weights[k] = PI_mat[k * M]; // PI(0, k)
+
+    typedef Dual<double, 1> AD;
+    const AD e = E_0_co(AD::variable(rho, 0), Q_mat, NoTilt(), MatrixColumns{D_mat.data(), M, nodes}, weights);
+    e0 = e.v;
+    grad_rho = e.d[0];
     return e0;
 }
 
-double E_0_co(double r, double rho, double &grad_rho, int n, vector<double> hweights, vector<double> multhweights,
-              vector<double> roots) {
-    // does not compute second der nor e0
-    Eigen::VectorXd logqg2 = (Q_mat.transpose() * ((-1.0 / (1.0 + rho)) * D_mat.array()).exp().matrix()).array().log();
-    Eigen::VectorXd qg2rho = (rho * logqg2.array()).exp();
-    Eigen::MatrixXd pig1_mat = PI_mat.array() * ((rho / (1.0 + rho)) * D_mat.array()).exp();
-
-    double m = (Q_mat.transpose() * pig1_mat * qg2rho).sum();
-    double mp = (Q_mat.transpose() * pig1_mat * (qg2rho.array() * logqg2.array()).matrix()).sum()
-                - (1.0 / (1.0 + rho)) *
-                  (Q_mat.transpose() * (pig1_mat.array() * (-D_mat.array())).matrix() * qg2rho).sum();
-
-    double F0 = m / PI;
-    double Fder0 = mp / PI;
-
-    grad_rho = -(Fder0) / (std::log(2) * F0);
-
-    return 1; // todo change
+double E_0_co(double r, double rho, double &grad_rho, int, vector<double>, vector<double>, vector<double>) {
+    // does not compute second der
+    double E0;
+    return E_0_co(r, rho, grad_rho, E0);
 }
 
 inline void
 gradient_f(complex<double> x, complex<double> y, vector<double> alphas, double rho, vector<double> &grads_alpha,
            double &grad_rho, int xindex) {
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
     for (int i = 0; i < sizeX; i++) { grads_alpha[i] = 0; }
     grad_rho = 0;
 
@@ -1378,193 +1582,56 @@ gradient_f(complex<double> x, complex<double> y, vector<double> alphas, double r
         grad_rho += GHQ * (-alphas[xcounter]/* - 1/pow(1+rho,2)*log(W(y,xhat))+1/pow(1+rho,2)*log(W(y,x))*/);
         xcounter++;
     }
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    gradient_f_times.push_back(duration_XX);
-}
 
-inline void
-gradient_f_co(complex<double> x, complex<double> y, double r, double rho, double &grad_r, double &grad_rho) {
-
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
-    grad_rho = 0;
-    grad_r = 0;
-
-    double h = H_co(r, x, y, rho), GHQ;
-    int a = 0;
-    for (auto xhat: X) {
-        double g = G_co(r, xhat, y, rho);
-        GHQ = Q(a) * (g / h);
-
-        grad_rho += GHQ * (-r * cost(xhat)/*-1/((1+rho)*(1+rho)) * (loG_co(wyx) - loG_co(W(y,xhat)))*/);
-
-        double c1 = cost(xhat);
-        double c2 = cost(x);
-        grad_r += GHQ * (-rho * c1 - c2);
-        a++;
-    }
-
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    gradient_f_co_times.push_back(duration_XX);
 }
 
-
-double e02(int n) {
-
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
-    double lhs = 0, rhs = 0, mylog, num_log, qx, wij;
-    complex<double> y;
-    int m = n;
-    vector<double> roots = Hroots(n);
-    vector<double> hweights = all_hweights[n];
-
-    int xcounter = 0;
-    for (auto x: X) {
-        qx = Q(xcounter);
-        for (int i = 0; i < n; i++) {
-            for (int j = 0; j < m; j++) {
-
-                complex<double> root(roots[i], roots[j]); // wi + imag*wj;
-                y = sqrt(SNR) * x + root;
-                wij = hweights[j] * hweights[i]; //wi * wj
-
-                num_log = 0;
-                int a = 0;
-                for (auto xhat: X) {
-                    float q = Q(a);
-                    double w = W(y, xhat);
-                    num_log += q * w;
-                    a++;
-                }
-                mylog = log2(num_log / W(y, x));
-
-                rhs += qx * mylog * wij * 1 / PI;
-                lhs += qx * mylog * mylog * wij * 1 / PI;
-            }
-        }
-        xcounter++;
-    }
-
-    double out = (rhs * rhs - lhs) * log(2);
-
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    e02_times.push_back(duration_XX);
-
-    return out;
+double e02(int) {
+    // E0''(0) in bits, i.e. -V*ln(2) with V the information-density variance in bits^2.
+    // Evaluated on the quadrature built by setPI()/setW().
+    double mutual_information;
+    return -channel_dispersion(mutual_information) * log(2);
 }
 
-inline void gradient_e0(vector<double> alphas, double rho, vector<double> &grads_alpha, double &grad_rho, int my_n,
-                        vector<double> hweights, vector<double> mult, vector<double> roots) { // TODO optimize
+inline void gradient_e0(vector<double> alphas, double rho, vector<double> &grads_alpha, double &grad_rho, int,
+                        vector<double>, vector<double>, vector<double>) {
     // ---------------------------
     // | GRADIENT OF E_0 - rho*R |
     // ---------------------------
+    // Evaluated on the quadrature built by setPI()/setW(), not on the node arguments.
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
+    const VectorXd alpha = Map<const VectorXd>(alphas.data(), alphas.size());
+    TiltedTerms k;
+    E_0_tilted(rho, -rho * alpha, alpha, k);
 
-    double grad_f_rho;
-    vector<double> grad_f_alphas(sizeX);
-    double denominator = 0, numerator_rho = 0, hwij, hi, aa_f_a_rho;
-    vector<double> numerator_alphas(sizeX);
+    grad_rho = -E_0_tilted_drho(rho, k, -alpha, VectorXd::Zero(sizeX)) / std::log(2) - R;
 
-    double Aa, f_a;
-    complex<double> y;
-    // fa
-    for (int i = 0; i < my_n; i++) { //todo change multsize
-        hi = hweights[i];
-        for (int j = 0; j < my_n; j++) {
-            hwij = hi * hweights[j];
-            complex<double> root(roots[i], roots[j]);
-            int xcounter = 0;
-            for (auto x: X) {
-                Aa = 1 / PI * Q(xcounter) * hwij;
-                y = std::sqrt(SNR) * x + root;
-                gradient_f(x, y, alphas, rho, grad_f_alphas, grad_f_rho,
-                           xcounter); //para cada f(x,...) tenemos derivadas alpha(x_hat_hat)
-                f_a = fa(x, y, alphas, rho, xcounter);
-                denominator += Aa * std::pow(f_a, rho);
-                numerator_rho += Aa * std::pow(f_a, rho) * (log(f_a) + rho * grad_f_rho / f_a);
-                for (int c = 0; c < sizeX; c++) {
-                    numerator_alphas[c] += Aa * rho * std::pow(f_a, rho - 1) * grad_f_alphas[c];
-                }
-                xcounter++;
-            }
-        }
+    // d/dalpha_c (rho log f_j) = rho (-rho P_cj - [a(j) == c])
+    VectorXd d_log_T = -rho * rho * (k.P * k.t);
+    for (int j = 0; j < k.t.size(); j++) {
+        d_log_T(k.symbol(j)) -= rho * k.t(j);
     }
-    grad_rho = -std::log2(eu) * numerator_rho / denominator - R;
+    const VectorXd grads = -d_log_T / std::log(2);
     for (int c = 0; c < sizeX - 1; c++) { // last alpha not updated
-        grads_alpha[c] = (-std::log2(eu) * numerator_alphas[c] / denominator) +
-                         (-std::log2(eu) * numerator_alphas[sizeX - 1] / denominator) * (-Q(c) / Q(sizeX - 1));
+        grads_alpha[c] = grads(c) + grads(sizeX - 1) * (-Q_mat(c) / Q_mat(sizeX - 1));
     }
-
-
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    gradient_e0_times.push_back(duration_XX);
 }
 
 
-inline void gradient_e0_co(double r, double rho, double &grad_r, double &grad_rho, int my_n, vector<double> hweights,
-                           vector<double> mult, vector<double> roots) { // TODO optimize
+inline void gradient_e0_co(double r, double rho, double &grad_r, double &grad_rho, int, vector<double>,
+                           vector<double>, vector<double>) {
     // ---------------------------
     // | GRADIENT OF E_0 - rho*R |
     // ---------------------------
+    // Evaluated on the quadrature built by setPI()/setW(), not on the node arguments.
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
-
-    double grad_f_r, grad_f_rho;
-    double numerator_r = 0, denominator = 0, numerator_rho = 0, hwij, hi, aa_f_a_rho;
-
-    vector<chrono::microseconds> inner_times;
-
-    double Aa, f_a;
-    complex<double> y;
-    // fa
-    for (int i = 0; i < my_n; i++) { // todo change multsize
-        hi = hweights[i];
-        for (int j = 0; j < my_n; j++) {
-            hwij = hi * hweights[j];
-            complex<double> root(roots[i], roots[j]);
-            int a = 0;
-            for (auto x: X) {
-                Aa = 1 / PI * Q(a) * hwij;
-                y = std::sqrt(SNR) * x + root;
-
-                auto start_inner = std::chrono::high_resolution_clock::now();
-
-                gradient_f_co(x, y, r, rho, grad_f_r, grad_f_rho); //todo problems in the past
-                f_a = fa_co(x, y, r, rho);
-
-                auto stop_inner = std::chrono::high_resolution_clock::now();
-                auto duration_inner = std::chrono::duration_cast<std::chrono::microseconds>(stop_inner - start_inner);
-
-                inner_times.push_back(duration_inner);
-
-                aa_f_a_rho = Aa * std::pow(f_a, rho);
-                numerator_r += Aa * rho * std::pow(f_a, rho - 1) * grad_f_r;
-                denominator += aa_f_a_rho;
-                numerator_rho += aa_f_a_rho * (std::log(f_a) + rho * grad_f_rho / f_a);
-                a++;
-            }
-        }
-    }
-
-    grad_r = -std::log2(eu) * numerator_r / denominator;
-    grad_rho = -std::log2(eu) * numerator_rho / denominator - R;
-
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    gradient_e0_co_times.push_back(duration_XX - sum_(inner_times));
+    E_0_cost(r, rho, grad_r, grad_rho);
+    grad_rho -= R;
 }
 
 
 inline vector<double> mult_newhweights(vector<double> hweights, int my_n) {
     // we only pick the most significant hweights, those inside the real-imaginary circle, and pairwise multiply and store them.
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     sort(hweights.begin(), hweights.end());
     double boundary = hweights[my_n - 1] - hweights[0];
@@ -1583,9 +1650,6 @@ inline vector<double> mult_newhweights(vector<double> hweights, int my_n) {
         }
     }
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    mult_newhweights_times.push_back(duration_XX);
 
     return newhweights;
 }
@@ -1596,7 +1660,6 @@ void compute_hweights(int n, int num_iterations) {
      * PRECOMPUTES THE WEIGHTS, ROOTS AND THE MULTIPLICATION OF WEIGHTS
      */
     //initQ();
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     if (DEBUG) {
         cout << endl;
@@ -1637,16 +1700,12 @@ void compute_hweights(int n, int num_iterations) {
         prev_n = my_n;
     }
      */
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    compute_hweights_times.push_back(duration_XX);
 }
 
 // Gradient Descent of E0
 double GD_ccomp(vector<double> &alphas, double &rho, double learning_rate, int num_iterations, int n) {
     //initQ();
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     float error = 0.05;
 
@@ -1770,9 +1829,6 @@ double GD_ccomp(vector<double> &alphas, double &rho, double learning_rate, int n
     }
     double out = E_0(rho, alphas, n) - rho * R;
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    GD_ccomp_times.push_back(duration_XX);
     //cout << num_iterations << endl;
     return out;
 }
@@ -1864,10 +1920,24 @@ std::vector<double> eigenToRowMajor(const Eigen::MatrixXd &mat) {
     return vec;
 }
 
+void setSolverStop(const std::atomic<bool>* cancel, std::chrono::steady_clock::time_point deadline) {
+    solver_cancel = cancel;
+    solver_deadline = deadline;
+}
+
+bool solverStopRequested() {
+    if (solver_cancel && solver_cancel->load(std::memory_order_relaxed)) return true;
+    return solver_deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= solver_deadline;
+}
+
+bool getSolverConverged() {
+    return solver_converged;
+}
+
 double GD_co(double &r, double &rho, double &rho_interpolated, int num_iterations, int n, bool updateR, double error) {
 
     // Gradient Descent of E0
-    auto start_XX = std::chrono::high_resolution_clock::now();
+    solver_converged = false;
     is_db_connected = false;
     /* Database code commented out
     if(is_db_connected){
@@ -1924,25 +1994,11 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
     double grad_r, grad_rho, grad_2_rho;
     double nextrho, auxrho = rho, nextauxrho;
     double nextr, auxr = rho, nextauxr;
-    vms inner_times;
 
     hweights = all_hweights[n];
     roots = all_roots[n];
     multhweights = all_multhweights[n];
 
-    // Decide computation method once for entire optimization to prevent discontinuities
-    // Check D_mat to see if we're in high SNR regime
-    double max_D_check = D_mat.maxCoeff();
-    double threshold_check = std::abs(-1.0 * max_D_check);  // Worst case at rho=0
-    force_log_space_mode = (threshold_check > 650.0);  // Use 650 for safety margin (50 below overflow threshold)
-
-    // std::cout << "DEBUG GD_co: max_D=" << max_D_check << ", threshold=" << threshold_check
-    //           << ", force_log_space=" << (force_log_space_mode ? "YES" : "NO") << "\n";
-
-    if (force_log_space_mode) {
-        std::cout << "INFO: Using log-space mode for entire optimization\n";
-    }
-
     E_0_co(R, 0, grad_rho, e0);
     double E0_0 = e0, E0_prime_0 = grad_rho;
 
@@ -1960,8 +2016,21 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
 
     rho_interpolated = rho;
 
+    last_initial_guess = rho;
+
+    // the cubic fit still decides whether the optimum lies on the boundary
+    if (rho > 0 && rho < 1 && warm_start_rho > 0 && warm_start_rho < 1 && warm_start_guess > 0 && warm_start_guess < 1) {
+        const double shifted = rho + (warm_start_rho - warm_start_guess);
+        if (shifted > 0 && shifted < 1) rho = shifted;
+    }
+
+    if (solverStopRequested()) { // best of the two end points
+        rho = (E0_1 - R > E0_0) ? 1.0 : 0.0;
+        return max(E0_0, E0_1 - R);
+    }
+
     if (rho <= 0 || rho >= 1) {
-        force_log_space_mode = false;  // Reset flag before early return
+        solver_converged = true;
         return E_0_co(R, max(0.0, min(rho, 1.0)), grad_rho, e0) - max(0.0, min(rho, 1.0)) * R;
     }
     
@@ -2003,7 +2072,12 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
         learning_rate = 0.01;
     }
 
+    double evaluated_rho = rho; // e0 = E0(evaluated_rho)
     for (int i = 0; i < num_iterations; ++i) {
+        if (solverStopRequested()) {
+            rho = max(0.0, min(evaluated_rho, 1.0));
+            return e0 - rho * R;
+        }
         //cout << "lr: " << fixed << setprecision(16) << learning_rate << endl;
         /*
         std::vector<double> Q_v(Q_mat.data(), Q_mat.data() + Q_mat.size());
@@ -2015,17 +2089,10 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
         std::vector<double> PI_v = eigenToColumnMajor(PI_mat);
         std::vector<double> D_v = eigenToColumnMajor(D_mat);
 
-        auto start_e0 = std::chrono::high_resolution_clock::now();
         E_0_co_vec(0.5, rho, grad_rho, e0, my_n-1, hweights, multhweights, roots, Q_v, PI_v, D_v);
-        auto stop_e0 = std::chrono::high_resolution_clock::now();
-        auto duration_e0 = std::chrono::duration_cast<std::chrono::microseconds>(stop_e0 - start_e0);
-        cout << "duration_e0: " << duration_e0.count() << endl;
         */
-        auto start_e0 = std::chrono::high_resolution_clock::now();
         E_0_co(R, rho, grad_rho, e0); // todo: 0.5
-        auto stop_e0 = std::chrono::high_resolution_clock::now();
-        auto duration_e0 = std::chrono::duration_cast<std::chrono::microseconds>(stop_e0 - start_e0);
-        /* cout << "duration_e0: " << duration_e0.count() << endl; */
+        evaluated_rho = rho;
 
         grad_rho -= R;
         grad_rho = -grad_rho;
@@ -2034,24 +2101,15 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
         rho -= learning_rate * grad_rho;
 
         if (grad_rho <= error && grad_rho >= -error) {
-            auto stop_XX = std::chrono::high_resolution_clock::now();
-            auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-            //NAG_co_times.push_back(duration_XX - sum_(inner_times));
-            /* cout << "NAG duration: " << duration_XX.count() << endl; */
             rho = max(0.0, min(rho, 1.0)); // todo change
-            force_log_space_mode = false;  // Reset flag before convergence return
+            solver_converged = true;
             return e0 - rho * R;
         }
         cout << fixed << setprecision(17) << i << " " << rho << " " << e0 << " " << e0 - rho * R << " " << grad_rho
              << endl;
     }
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    //GD_co_times.push_back(duration_XX - sum_(inner_times));
-    cout << "GD duration: " << duration_XX.count() << endl;
     rho = max(0.0, min(rho, 1.0)); // todo change
-    force_log_space_mode = false;  // Reset flag before max iterations return
     return e0 - rho * R;
 }
 
@@ -2059,7 +2117,6 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
 // Newton's Method of E0
 
 double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     if (DEBUG) {
         for (int i = 0; i < 60; i++) cout << "/";
@@ -2087,7 +2144,6 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
     double grad_rho, grad_2_rho;
     double nextrho, auxrho = rho, nextauxrho;
     double nextr, auxr = rho, nextauxr;
-    vms inner_times;
 
     // vector<double> rhos = {0,.1,.2,.3,.4,.5,.6,.7,.8,.9,1};
 
@@ -2127,7 +2183,6 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
         }
 
         prev_n = my_n;
-        auto start_inner2 = std::chrono::high_resolution_clock::now();
         double auxrho = rho;
 
         if (true && i == -1) {
@@ -2158,9 +2213,6 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
         grad_rho -= r; //todo: R
 
 
-        auto stop_inner2 = std::chrono::high_resolution_clock::now();
-        auto duration_inner2 = std::chrono::duration_cast<std::chrono::microseconds>(stop_inner2 - start_inner2);
-        inner_times.push_back(duration_inner2);
 
 
         grad_rho = -grad_rho;
@@ -2192,9 +2244,6 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
 
         if (grad_rho <= error && grad_rho >= -error) {
             //if(fabs(grad_rho / grad_2_rho) <= error){
-            auto stop_XX = std::chrono::high_resolution_clock::now();
-            auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-            //NAG_co_times.push_back(duration_XX - sum_(inner_times));
             if (DEBUG) {
                 cout << setw(4) << left << i + 1;
                 cout << setw(10) << left << rho;
@@ -2208,7 +2257,6 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
             }
             for (int i = 0; i < 60; i++) cout << "/";
             cout << endl;
-            cout << "NM duration: " << duration_XX.count() << endl;
             for (int i = 0; i < 60; i++) cout << "/";
             cout << endl;
             return e0 - rho * r;
@@ -2224,23 +2272,15 @@ double NM_co(double &r, double &rho, int num_iterations, int n, bool updateR) {
         }
     }
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    //GD_co_times.push_back(duration_XX - sum_(inner_times));
-    cout << "NM duration: " << duration_XX.count() << endl;
     return e0 - rho * R;
 
 }
 
 
 double GD_iid(double &r, double &rho, double &rho_interploated, int num_iterations, int n, double error) {
-    auto start_NAG_iid = std::chrono::high_resolution_clock::now();
     //cout << endl << "cooking" << endl;
     double out = GD_co(r, rho, rho_interploated, num_iterations, n, false, error);
 
-    auto stop_NAG_iid = std::chrono::high_resolution_clock::now();
-    auto duration_NAG_iid = std::chrono::duration_cast<std::chrono::microseconds>(stop_NAG_iid - start_NAG_iid);
-    NAG_iid_times.push_back(chrono::microseconds(0));
 
     return out;
 }
@@ -2248,13 +2288,9 @@ double GD_iid(double &r, double &rho, double &rho_interploated, int num_iteratio
 
 /*
 double GD_cc(double& r, double& rho, double learning_rate, int num_iterations, int n){
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     double out = GD_co(r, rho, learning_rate, num_iterations, n, true);
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    GD_cc_times.push_back(duration_XX);
 
     return out;
 }
@@ -2271,7 +2307,6 @@ void NAG_update(double &x_t, double &y_t, double &x_tp1, double &y_tp1, double b
 
 double NAG(vector<double> &alphas, double &rho, int num_iterations, double beta, double k, int n) {
 
-    auto start_NAG = std::chrono::high_resolution_clock::now();
 
     double kaux = ((sqrt(k) - 1) / (sqrt(k) + 1));
     vector<double> x_t_r = alphas, y_t_r = alphas, y_tp1_r(sizeX), x_tp1_r(sizeX);
@@ -2319,16 +2354,12 @@ double NAG(vector<double> &alphas, double &rho, int num_iterations, double beta,
     }
     double out = E_0(x_t_rho, x_t_r, n) - x_t_rho * R;
 
-    auto stop_NAG = std::chrono::high_resolution_clock::now();
-    auto duration_NAG = std::chrono::duration_cast<std::chrono::microseconds>(stop_NAG - start_NAG);
-    NAG_times.push_back(duration_NAG);
 
     return out;
 }
 
 double NAG_co(double &r, double &rho, double learning_rate, int num_iterations, int n, double k, bool updateR) {
 
-    auto start_XX = std::chrono::high_resolution_clock::now();
 
     if (DEBUG) cout << "it |  rho   |  r  |-e0+rho*r| -grad_rho| -grad_r" << endl;
 
@@ -2347,7 +2378,6 @@ double NAG_co(double &r, double &rho, double learning_rate, int num_iterations,
     double grad_r, grad_rho, grad_2_rho;
     double nextrho, auxrho = rho, nextauxrho;
     double nextr, auxr = rho, nextauxr;
-    vms inner_times;
 
     hweights = all_hweights[n];
     roots = all_roots[n];
@@ -2427,14 +2457,17 @@ double NAG_co(double &r, double &rho, double learning_rate, int num_iterations,
         prev_n = my_n;
          */
 
-        auto start_inner2 = std::chrono::high_resolution_clock::now();
         // gradient_e0_co(r, rho, grad_r, grad_rho, my_n-1, hweights, multhweights, roots);
 
         // cout << "gr: " << grad_rho << endl;
         //cout << "rho: " << rho << endl;
 
         //rho = rhos[i];
-        E_0_co(0.5, rho, grad_rho, e0);
+        if (updateR) {
+            e0 = E_0_cost(r, rho, grad_r, grad_rho);
+        } else {
+            E_0_co(0.5, rho, grad_rho, e0);
+        }
         grad_rho -= R;
         //cout << "gr_new: " << grad_rho << endl;
 
@@ -2446,9 +2479,6 @@ double NAG_co(double &r, double &rho, double learning_rate, int num_iterations,
         //cout << "gr_old: " << grad_rho << endl;
         //cout << "rho: " << rho << endl;
 
-        auto stop_inner2 = std::chrono::high_resolution_clock::now();
-        auto duration_inner2 = std::chrono::duration_cast<std::chrono::microseconds>(stop_inner2 - start_inner2);
-        inner_times.push_back(duration_inner2);
 
 
         grad_rho = -grad_rho;
@@ -2478,10 +2508,6 @@ double NAG_co(double &r, double &rho, double learning_rate, int num_iterations,
         /*if(DEBUG) */
 
         if (grad_rho <= error && grad_rho >= -error) {
-            auto stop_XX = std::chrono::high_resolution_clock::now();
-            auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-            //NAG_co_times.push_back(duration_XX - sum_(inner_times));
-            /* cout << "NAG duration: " << duration_XX.count() << endl; */
             return e0 - rho * R;
         }
         cout << fixed << setprecision(17) << i << " " << rho << " " << e0 << " " << e0 - rho * R << " " << grad_rho
@@ -2490,37 +2516,710 @@ double NAG_co(double &r, double &rho, double learning_rate, int num_iterations,
     //cout << rho << " " << grad_rho << " " << grad_r << " " << endl;
     //cout << num_iterations << endl;
 
-    auto stop_XX = std::chrono::high_resolution_clock::now();
-    auto duration_XX = std::chrono::duration_cast<std::chrono::microseconds>(stop_XX - start_XX);
-    //NAG_co_times.push_back(duration_XX - sum_(inner_times));
-    /* cout << "NAG duration: " << duration_XX.count() << endl; */
     return e0 - rho * R;
 }
 
 double NAG_iid(double &r, double &rho, double learning_rate, int num_iterations, int n, double k) {
-    auto start_NAG_iid = std::chrono::high_resolution_clock::now();
     //cout << endl << "cooking" << endl;
     double out = NAG_co(r, rho, learning_rate, num_iterations, n, k, false);
 
-    auto stop_NAG_iid = std::chrono::high_resolution_clock::now();
-    auto duration_NAG_iid = std::chrono::duration_cast<std::chrono::microseconds>(stop_NAG_iid - start_NAG_iid);
-    NAG_iid_times.push_back(chrono::microseconds(0));
 
     return out;
 }
 
 double NAG_cc(double &r, double &rho, double learning_rate, int num_iterations, int n, double k) {
-    auto start_NAG_cc = std::chrono::high_resolution_clock::now();
 
     double out = NAG_co(r, rho, learning_rate, num_iterations, n, k, true);
 
-    auto stop_NAG_cc = std::chrono::high_resolution_clock::now();
-    auto duration_NAG_cc = std::chrono::duration_cast<std::chrono::microseconds>(stop_NAG_cc - start_NAG_cc);
-    NAG_cc_times.push_back(duration_NAG_cc);
 
     return out;
 }
 
+// -- INPUT DISTRIBUTION OPTIMIZATION --
+
+// Per-symbol terms of the E0 kernel on the current PI/D matrices, normalized by m = sum_a Q_a f_a:
+//   f(a) = sum_{j in block a} PI(a,j) exp(rho*s*D(a,j)) qg2(j)^rho / m
+//   G(a) = sum_{j in block a} PI(a,j) exp(rho*s*D(a,j)) qg2(j)^rho z_j / m
+// where qg2(j) = sum_i Q_i exp(-s*D(i,j)) and z_j is the quadrature node of column j. (1+rho)*f(a) is
+// dm/dQ_a and G(a) gives dm/dSNR. Returns log(m); E0 = -(log(m) - log(PI)) / log(2).
+static double E_0_co_symbol_terms(double rho, VectorXd &f, VectorXcd &G) {
+    const int M = Q_mat.size();
+    const int nn = D_mat.cols() / M; // n*n nodes per transmitted symbol
+    const double s = 1.0 / (1.0 + rho);
+    vector<double> roots = Hroots(n);
+
+    // logqg2 with a per-column shift so that it cannot overflow at high SNR
+    MatrixXd A = -s * D_mat;
+    A.colwise() += Q_mat.array().log().matrix();
+    RowVectorXd col_max = A.colwise().maxCoeff();
+    RowVectorXd logqg2 = col_max.array() + (A.rowwise() - col_max).array().exp().colwise().sum().log();
+
+    VectorXd log_terms(D_mat.cols());
+    for (int a = 0; a < M; a++) {
+        for (int k = 0; k < nn; k++) {
+            const int j = a * nn + k;
+            log_terms(j) = std::log(Q_mat(a) * PI_mat(a, j)) + rho * s * D_mat(a, j) + rho * logqg2(j);
+        }
+    }
+    const double log_m = log_sum_exp(log_terms);
+
+    f = VectorXd::Zero(M);
+    G = VectorXcd::Zero(M);
+    for (int a = 0; a < M; a++) {
+        if (Q_mat(a) <= 0) continue;
+        for (int k = 0; k < nn; k++) {
+            const int j = a * nn + k;
+            const double t = std::exp(log_terms(j) - log_m) / Q_mat(a);
+            f(a) += t;
+            G(a) += t * complex<double>(roots[k / n], roots[k % n]);
+        }
+    }
+    return log_m;
+}
+
+// setW for X_mat = to * pattern when D_mat was built for X_mat = from * pattern, as the Q and
+// shaping optimizers rescale X on every trial. Each entry of D is scale^2 A + scale B + C with
+// A_ia = SNR |p_a - p_i|^2, B linear in the nodes and C_k = |z_k|^2 (the entries D(a, a*n*n + k)), so
+//   D(to) = (to/from) D(from) + to (to - from) A + (1 - to/from) C
+// is two multiply-adds per entry, without B, Y or the nodes. Anything else (from = 0 for none, or
+// a mode without D_mat) runs setW.
+static void rescaleW(const VectorXcd &pattern, double from, double to) {
+    const int nn = n * n;
+    if (!(from > 0) || quadrature_mode != EP_EVAL_DENSE || D_mat.rows() != sizeX || D_mat.cols() != sizeX * nn) {
+        setW();
+        return;
+    }
+    low_snr_mode = false;
+    const double ratio = to / from, a_factor = to * (to - from) * SNR, c_factor = 1.0 - ratio;
+    VectorXd C(nn), A(sizeX);
+    for (int k = 0; k < nn; k++) C(k) = c_factor * D_mat(0, k);
+    for (int a = 0; a < sizeX; a++) {
+        for (int i = 0; i < sizeX; i++) A(i) = a_factor * abs_sq(pattern(a) - pattern(i));
+        for (int k = 0; k < nn; k++) {
+            D_mat.col(a * nn + k) = (ratio * D_mat.col(a * nn + k).array() + A.array() + C(k)).matrix();
+        }
+    }
+}
+
+// Maximizes E0(rho) (rho_fixed > 0) or E(R) = max_rho E0(rho) - rho*R (rho_fixed <= 0) over Q for the
+// current constellation, keeping the average power E_Q|X|^2 at its initial value: X is rescaled
+// whenever Q changes, so the objective is E0(rho, Q, SNR / E_Q|X|^2).
+// With d_a = (1+rho) f(a) - SNR |x_a|^2 (dm/dSNR)/m, the derivative of m with the rescaling included,
+// each step is the Arimoto-type update Q_a <- Q_a (d_a / sum_b Q_b d_b)^(-eta/rho); eta is halved
+// whenever a step does not improve the objective and doubled (up to 4, over-relaxed) after one that does. At the optimum d_a is constant on the support of Q,
+// so the largest relative deviation of d_a is returned in kkt_gap. Requires setPI()/setW().
+double optimize_input_distribution(double rho_fixed, double &rho, int max_iterations, double tolerance,
+                                   int &iterations, double &kkt_gap, double &scale) {
+    const bool rate_mode = !(rho_fixed > 0);
+    const int M = Q_mat.size();
+    VectorXd energy(M);
+    for (int i = 0; i < M; i++) energy(i) = abs_sq(X_mat(i));
+    const double power = Q_mat.dot(energy);
+    VectorXcd X_pattern = X_mat;
+    scale = 1.0;
+    double w_scale = 1.0; // of the X_mat that D_mat was built for
+
+    double grad_rho, e0, rho_interpolated, r;
+    auto objective = [&](double &rho_now) {
+        if (rate_mode) {
+            return GD_co(r, rho_now, rho_interpolated, 20, n, false, tolerance);
+        }
+        rho_now = rho_fixed;
+        return E_0_co(R, rho_now, grad_rho, e0) - rho_now * R;
+    };
+
+    double best = objective(rho);
+    double eta = 1.0;
+    VectorXd f;
+    VectorXcd G;
+    kkt_gap = std::numeric_limits<double>::infinity();
+
+    for (iterations = 0; iterations < max_iterations; iterations++) {
+        // rates above I(X;Y) give rho = 0, where E(R) = 0 for every Q; keep pushing I(X;Y) up
+        const double rho_step = rate_mode ? std::max(rho, 0.01) : rho;
+
+        E_0_co_symbol_terms(rho_step, f, G);
+        double dm_dsnr = 0.0;
+        for (int i = 0; i < M; i++) dm_dsnr += Q_mat(i) * std::real(std::conj(X_mat(i)) * G(i));
+        dm_dsnr /= std::sqrt(SNR);
+
+        VectorXd d = (1.0 + rho_step) * f - (SNR * scale * scale * dm_dsnr) * energy;
+        const double d_mean = Q_mat.dot(d);
+        kkt_gap = 0.0;
+        for (int i = 0; i < M; i++) {
+            if (Q_mat(i) > 1e-12) kkt_gap = std::max(kkt_gap, std::abs(d(i) / d_mean - 1.0));
+        }
+        if (kkt_gap < tolerance) break;
+
+        const VectorXd Q_prev = Q_mat;
+        const double scale_prev = scale;
+        const double rho_prev = rho;
+        while (true) {
+            for (int i = 0; i < M; i++) {
+                Q_mat(i) = Q_prev(i) * std::pow(std::max(d(i), 1e-300) / d_mean, -eta / rho_step);
+            }
+            Q_mat /= Q_mat.sum();
+            scale = std::sqrt(power / Q_mat.dot(energy));
+            X_mat = scale * X_pattern;
+            rescaleW(X_pattern, w_scale, scale);
+            w_scale = scale;
+
+            double value = objective(rho);
+            if (value >= best - 1e-15) {
+                best = value;
+                eta = std::min(4.0, 2.0 * eta);
+                break;
+            }
+            eta *= 0.5;
+            if (eta < 1e-6) {
+                Q_mat = Q_prev;
+                scale = scale_prev;
+                X_mat = scale * X_pattern;
+                rescaleW(X_pattern, w_scale, scale);
+                rho = rho_prev;
+                return best;
+            }
+        }
+    }
+
+    for (int i = 0; i < M; i++) X[i] = X_mat(i);
+    return best;
+}
+
+vector<double> getQ() {
+    return vector<double>(Q_mat.data(), Q_mat.data() + Q_mat.size());
+}
+
+// -- COST-CONSTRAINED EXPONENT --
+
+// max over r of E0(rho, r) at fixed rho. E0 is concave in r, so the root of dE0/dr is bracketed by
+// stepping from the current r along the slope (doubling the step) and refined by Illinois false position.
+static double E_0_cost_max_r(double rho, double &r, double &grad_rho, double tolerance) {
+    double g_lo, g_hi, g, e;
+    e = E_0_cost(r, rho, g, grad_rho);
+    if (std::abs(g) <= tolerance) return e;
+
+    const double direction = (g > 0) ? 1.0 : -1.0;
+    double step = 0.25, lo = r, hi = r + direction * step;
+    g_lo = g;
+    E_0_cost(hi, rho, g_hi, grad_rho);
+    while (g_hi * direction > 0 && step < 1e3) {
+        lo = hi;
+        g_lo = g_hi;
+        step *= 2;
+        hi = lo + direction * step;
+        E_0_cost(hi, rho, g_hi, grad_rho);
+    }
+    if (lo > hi) {
+        std::swap(lo, hi);
+        std::swap(g_lo, g_hi);
+    }
+
+    int side = 0;
+    double x = hi;
+    for (int it = 0; it < 60; it++) {
+        x = hi - g_hi * (hi - lo) / (g_hi - g_lo);
+        e = E_0_cost(x, rho, g, grad_rho);
+        if (std::abs(g) < tolerance || hi - lo < 1e-12) break;
+        if (g > 0) {
+            lo = x;
+            g_lo = g;
+            if (side == 1) g_hi /= 2;
+            side = 1;
+        } else {
+            hi = x;
+            g_hi = g;
+            if (side == -1) g_lo /= 2;
+            side = -1;
+        }
+    }
+    r = x;
+    return e;
+}
+
+// Cost-constrained random-coding exponent max_{0<=rho<=1, r} E0(rho, r) - rho*R on the tilted
+// matrix kernel. By the envelope theorem d/drho max_r E0 = dE0/drho at r*(rho), whose root in rho is
+// found by Illinois false position on [0, 1]. Requires setPI()/setW(). Returns the exponent in bits.
+double E_cost_constrained(double &r, double &rho, int max_iterations, double tolerance) {
+    double grad_rho;
+    r = 0;
+    E_0_cost_max_r(0, r, grad_rho, tolerance);
+    double lo = 0, s_lo = grad_rho - R;
+    if (s_lo <= 0) {
+        rho = 0;
+        return 0;
+    }
+    double e = E_0_cost_max_r(1, r, grad_rho, tolerance);
+    double hi = 1, s_hi = grad_rho - R;
+    if (s_hi >= 0) {
+        rho = 1;
+        return e - R;
+    }
+
+    int side = 0;
+    for (int it = 0; it < max_iterations; it++) {
+        rho = hi - s_hi * (hi - lo) / (s_hi - s_lo);
+        e = E_0_cost_max_r(rho, r, grad_rho, tolerance);
+        const double slope = grad_rho - R;
+        if (std::abs(slope) < tolerance || hi - lo < 1e-12) break;
+        if (slope > 0) {
+            lo = rho;
+            s_lo = slope;
+            if (side == 1) s_hi /= 2;
+            side = 1;
+        } else {
+            hi = rho;
+            s_hi = slope;
+            if (side == -1) s_lo /= 2;
+            side = -1;
+        }
+    }
+    return e - rho * R;
+}
+
+// -- AUTOMATIC DIFFERENTIATION OF E0 --
+
+// Node weights w_k of the n*n grid in the order of PointColumns, as setPI builds them
+static vector<double> node_weights() {
+    const vector<double> hweights = Hweights(n - 1);
+    vector<double> weights;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) weights.push_back(hweights[i] * hweights[j]);
+    }
+    return weights;
+}
+
+// Exact partial derivatives of E0(rho) (bits) with respect to rho, SNR, every Q_i and every point x_i
+// (d_X[i] = dE0/dRe(x_i) + i*dE0/dIm(x_i)): forward mode over the 2 + 3*sizeX variables, GRADIENT_CHUNK
+// of them per pass of the E_0_co template on columns rebuilt from the points. Uses the current Q_mat,
+// X_mat, SNR and n. Returns E0(rho).
+static const int GRADIENT_CHUNK = 8;
+
+double E_0_co_gradient(double rho, double &d_rho, double &d_snr, vector<double> &d_Q, vector<complex<double>> &d_X) {
+    typedef Dual<double, GRADIENT_CHUNK> AD;
+    const int M = Q_mat.size();
+    const int P = 2 + 3 * M;
+    const vector<double> weights = node_weights();
+
+    vector<double> grad(P);
+    double e0 = 0;
+    for (int first = 0; first < P; first += GRADIENT_CHUNK) {
+        // variable j (rho, SNR, Q_i, Re x_i, Im x_i) is seeded in slot j - first when in this chunk
+        const AD amplitude = sqrt(AD::variable(SNR, 1 - first));
+        vector<AD> Q(M);
+        PointColumns<AD> columns;
+        columns.roots = Hroots(n);
+        for (int i = 0; i < M; i++) {
+            Q[i] = AD::variable(Q_mat(i), 2 + i - first);
+            columns.x_re.push_back(amplitude * AD::variable(X_mat(i).real(), 2 + M + i - first));
+            columns.x_im.push_back(amplitude * AD::variable(X_mat(i).imag(), 2 + 2 * M + i - first));
+        }
+        const AD e = E_0_co(AD::variable(rho, -first), Q, NoTilt(), columns, weights);
+        for (int k = 0; k < GRADIENT_CHUNK && first + k < P; k++) grad[first + k] = e.d[k];
+        e0 = e.v;
+    }
+
+    d_rho = grad[0];
+    d_snr = grad[1];
+    d_Q.resize(M);
+    d_X.resize(M);
+    for (int i = 0; i < M; i++) {
+        d_Q[i] = grad[2 + i];
+        d_X[i] = complex<double>(grad[2 + M + i], grad[2 + 2 * M + i]);
+    }
+    return e0;
+}
+
+// E0(rho) with its first and second rho-derivatives (bits) from a nested dual number, like
+// E_0_co_derivatives but on columns rebuilt from the points (no setPI()/setW()). Returns E0(rho).
+double E_0_co_curvature(double rho, double &d_rho, double &d2_rho) {
+    typedef Dual<double, 1> AD1;
+    typedef Dual<AD1, 1> AD2;
+    PointColumns<double> columns;
+    columns.roots = Hroots(n);
+    for (int i = 0; i < Q_mat.size(); i++) {
+        columns.x_re.push_back(sqrt(SNR) * X_mat(i).real());
+        columns.x_im.push_back(sqrt(SNR) * X_mat(i).imag());
+    }
+    const AD2 e0 = E_0_co(AD2::variable(AD1::variable(rho, 0), 0), Q_mat, NoTilt(), columns, node_weights());
+
+    d_rho = e0.v.d[0];
+    d2_rho = e0.d[0].d[0];
+    return e0.v.v;
+}
+
+// -- CONSTELLATION GEOMETRY OPTIMIZATION --
+
+// Gradient of E0(rho) with respect to every constellation point, grad[a] = dE0/dRe(x_a) + i*dE0/dIm(x_a).
+// Differentiating m = integral of (sum_i Q_i exp(-s|y - sqrt(SNR) x_i|^2))^(1+rho) gives
+//   dm/dx_a = 2 sqrt(SNR) Q_a * integral of qg2(a + z)^rho z exp(-s|z|^2) dz = 2 sqrt(SNR) Q_a m G(a),
+// which the quadrature around x_a evaluates from the same columns as E0 itself (one pass over D).
+// Requires setPI()/setW(). Returns E0(rho).
+double gradient_E0_constellation(double rho, vector<complex<double>> &grad) {
+    VectorXd f;
+    VectorXcd G;
+    const double log_m = E_0_co_symbol_terms(rho, f, G);
+    grad.resize(Q_mat.size());
+    for (int a = 0; a < Q_mat.size(); a++) {
+        grad[a] = -2.0 * std::sqrt(SNR) * Q_mat(a) * G(a) / std::log(2);
+    }
+    return -(log_m - std::log(PI)) / std::log(2);
+}
+
+// Projected gradient ascent on the constellation points for E(R) (rho_fixed <= 0; by the envelope
+// theorem its gradient is that of E0 at the optimal rho) or E0(rho) - rho*R (rho_fixed > 0).
+// Each step is projected back onto the power constraint enforced by normalizeX_for_Q: X is centered
+// (E0 is translation invariant) and rescaled to its initial average power E_Q|X|^2. The step size is
+// halved after a rejected step and grown after an accepted one; iteration stops when the tangential
+// gradient norm falls below tolerance or no step improves the objective.
+double optimize_constellation_geometry(double rho_fixed, double &rho, int max_iterations, double tolerance,
+                                       int &iterations, double &grad_norm) {
+    const bool rate_mode = !(rho_fixed > 0);
+    const int M = Q_mat.size();
+    double power = 0.0;
+    for (int i = 0; i < M; i++) power += Q_mat(i) * abs_sq(X_mat(i));
+
+    double grad_rho, e0, rho_interpolated, r;
+    auto objective = [&](double &rho_now) {
+        if (rate_mode) {
+            return GD_co(r, rho_now, rho_interpolated, 20, n, false, tolerance);
+        }
+        rho_now = rho_fixed;
+        return E_0_co(R, rho_now, grad_rho, e0) - rho_now * R;
+    };
+    auto project = [&](VectorXcd &x) {
+        complex<double> mean = 0.0;
+        for (int i = 0; i < M; i++) mean += Q_mat(i) * x(i);
+        x.array() -= mean;
+        double p = 0.0;
+        for (int i = 0; i < M; i++) p += Q_mat(i) * abs_sq(x(i));
+        x *= std::sqrt(power / p);
+    };
+
+    project(X_mat);
+    setW();
+    double best = objective(rho);
+    double step = -1.0;
+    vector<complex<double>> grad;
+    grad_norm = 0.0;
+
+    for (iterations = 0; iterations < max_iterations; iterations++) {
+        gradient_E0_constellation(std::max(rho, 1e-3), grad);
+
+        // remove the component along the constraint normal (Q_a x_a)
+        complex<double> g_dot_n = 0.0;
+        double n_dot_n = 0.0;
+        for (int i = 0; i < M; i++) {
+            g_dot_n += std::conj(Q_mat(i) * X_mat(i)) * grad[i];
+            n_dot_n += abs_sq(Q_mat(i) * X_mat(i));
+        }
+        const double lambda = std::real(g_dot_n) / n_dot_n;
+        double max_g = 0.0;
+        grad_norm = 0.0;
+        for (int i = 0; i < M; i++) {
+            grad[i] -= lambda * Q_mat(i) * X_mat(i);
+            grad_norm += abs_sq(grad[i]);
+            max_g = std::max(max_g, std::abs(grad[i]));
+        }
+        grad_norm = std::sqrt(grad_norm);
+        if (grad_norm < tolerance) break;
+
+        // first step moves the point with the largest gradient by 5% of the RMS amplitude
+        if (step < 0) step = 0.05 * std::sqrt(power) / max_g;
+
+        const VectorXcd X_prev = X_mat;
+        const double rho_prev = rho;
+        bool accepted = false;
+        while (step * max_g > 1e-9 * std::sqrt(power)) {
+            for (int i = 0; i < M; i++) X_mat(i) = X_prev(i) + step * grad[i];
+            project(X_mat);
+            setW();
+            double value = objective(rho);
+            if (value > best) {
+                best = value;
+                step *= 1.5;
+                accepted = true;
+                break;
+            }
+            step *= 0.5;
+        }
+        if (!accepted) {
+            X_mat = X_prev;
+            setW();
+            rho = rho_prev;
+            break;
+        }
+    }
+
+    X.assign(X_mat.data(), X_mat.data() + M);
+    return best;
+}
+
+vector<complex<double>> getX() {
+    return vector<complex<double>>(X_mat.data(), X_mat.data() + X_mat.size());
+}
+
+// -- SHAPING PARAMETER OPTIMIZATION --
+
+// Maximizes E(R) (objective "exponent") or I(X;Y) (objective "mutual-information") over the
+// Maxwell-Boltzmann parameter beta in [beta_lo, beta_hi] with Brent's method, starting from
+// beta_start. The constellation pattern set by setMod() and PI (setPI()) are reused between
+// evaluations; each evaluation only recomputes Q and the scale of X (normalizeX_for_Q) and rescales
+// D to it (rescaleW).
+// On return the globals hold X, Q and D for the optimal beta.
+double optimize_shaping_parameter(string objective, double beta_lo, double beta_hi, double beta_start,
+                                  double tolerance, int max_evaluations, double &beta_opt, int &evaluations) {
+    const VectorXcd pattern = X_mat;
+    const bool mutual_information = (objective == "mutual-information");
+    evaluations = 0;
+
+    const double pattern_power = pattern.squaredNorm();
+    double w_scale = 0.0; // of the X_mat that D_mat was built for, 0: none yet
+
+    double grad_rho, e0, rho, rho_interpolated, r;
+    auto evaluate = [&](double beta) {
+        evaluations++;
+        X_mat = pattern;
+        current_distribution = "maxwell-boltzmann";
+        current_beta = beta;
+        normalizeX_for_Q();
+        const double scale = std::sqrt(X_mat.squaredNorm() / pattern_power);
+        rescaleW(pattern, w_scale, scale);
+        w_scale = scale;
+        if (mutual_information) {
+            E_0_co(R, 0, grad_rho, e0);
+            return grad_rho;
+        }
+        return GD_co(r, rho, rho_interpolated, 20, n, false, tolerance);
+    };
+
+    // Brent's method on -f (golden-section steps when the parabolic step is not acceptable)
+    const double golden = 0.3819660112501051;
+    double a = beta_lo, b = beta_hi;
+    double x = std::min(std::max(beta_start, a), b), w = x, v = x;
+    double fx = -evaluate(x), fw = fx, fv = fx;
+    double d = 0.0, e = 0.0;
+
+    while (evaluations < max_evaluations) {
+        const double m = 0.5 * (a + b);
+        const double tol1 = std::sqrt(tolerance) * std::abs(x) + 1e-10;
+        const double tol2 = 2.0 * tol1;
+        if (std::abs(x - m) <= tol2 - 0.5 * (b - a)) break;
+
+        bool golden_step = true;
+        if (std::abs(e) > tol1) {
+            double r1 = (x - w) * (fx - fv);
+            double q = (x - v) * (fx - fw);
+            double p = (x - v) * q - (x - w) * r1;
+            q = 2.0 * (q - r1);
+            if (q > 0) p = -p;
+            q = std::abs(q);
+            if (std::abs(p) < std::abs(0.5 * q * e) && p > q * (a - x) && p < q * (b - x)) {
+                e = d;
+                d = p / q;
+                const double u = x + d;
+                if (u - a < tol2 || b - u < tol2) d = (x < m) ? tol1 : -tol1;
+                golden_step = false;
+            }
+        }
+        if (golden_step) {
+            e = (x >= m) ? a - x : b - x;
+            d = golden * e;
+        }
+
+        const double u = (std::abs(d) >= tol1) ? x + d : x + (d > 0 ? tol1 : -tol1);
+        const double fu = -evaluate(u);
+        if (fu <= fx) {
+            if (u >= x) a = x; else b = x;
+            v = w; fv = fw;
+            w = x; fw = fx;
+            x = u; fx = fu;
+        } else {
+            if (u < x) a = u; else b = u;
+            if (fu <= fw || w == x) {
+                v = w; fv = fw;
+                w = u; fw = fu;
+            } else if (fu <= fv || v == x || v == w) {
+                v = u; fv = fu;
+            }
+        }
+    }
+
+    beta_opt = x;
+    evaluate(beta_opt);
+    evaluations--;
+    return -fx;
+}
+
+// -- MONTE CARLO E0 --
+
+// Counter-based generator: every random number is a hash of (seed, sample, stream), so a sample's
+// value does not depend on which thread draws it or in which order.
+static inline uint64_t mc_hash(uint64_t seed, uint64_t sample, uint64_t stream) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (2 * sample + 1) + 0xD1B54A32D192ED03ULL * (stream + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL; // splitmix64 finalizer
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline double mc_uniform(uint64_t seed, uint64_t sample, uint64_t stream) { // in (0, 1]
+    return ((mc_hash(seed, sample, stream) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+// Partial sums over a block of samples: g = f^rho and h = dg/drho for each antithetic pair
+struct MCBlock {
+    double g = 0, g2 = 0, h = 0, h2 = 0, gh = 0;
+};
+
+// f^rho and its rho-derivative at y = sqrt(SNR) x_a + z, with
+// log f = log sum_i Q_i exp(-s(|sqrt(SNR)(x_a - x_i) + z|^2 - |z|^2)) and d log f/drho = s'(|z|^2 - E_P[D]).
+static inline void mc_integrand(double rho, int a, complex<double> z, const VectorXcd &X_scaled,
+                                const VectorXd &Q, vector<double> &e, double &g, double &h) {
+    const int M = X_scaled.size();
+    const double s = 1.0 / (1.0 + rho);
+    const double z2 = std::norm(z);
+    double e_max = -INFINITY;
+    for (int i = 0; i < M; i++) {
+        e[i] = -s * (std::norm(X_scaled(a) - X_scaled(i) + z) - z2);
+        e_max = std::max(e_max, e[i]);
+    }
+    double sum = 0, sum_D = 0;
+    for (int i = 0; i < M; i++) {
+        const double w = Q(i) * std::exp(e[i] - e_max);
+        sum += w;
+        sum_D += w * (z2 - e[i] / s); // w * D_i
+    }
+    const double log_f = std::log(sum) + e_max;
+    const double d_log_f = -s * s * (z2 - sum_D / sum);
+    g = std::exp(rho * log_f);
+    h = g * (log_f + rho * d_log_f);
+}
+
+// Monte Carlo estimate of E0(rho) and E0'(rho) (bits) for the current Q_mat, X_mat and SNR, without
+// the D/PI matrices. Each sample draws the transmitted symbol from Q and y from W(.|x_a), i.e. importance
+// sampling centred on the transmitted symbols, and averages the antithetic pair z, -z. Samples are split
+// into fixed blocks whose partial sums are reduced in block order, so the result for a given seed is
+// the same for any number of threads. Returns E0 and the 95% confidence half-widths (delta method).
+double E_0_monte_carlo(double rho, long long samples, uint64_t seed, int threads, double &grad_rho,
+                       double &e0_halfwidth, double &grad_halfwidth) {
+    const int M = Q_mat.size();
+    // the engine state is thread_local: workers only see these copies
+    const VectorXcd X_scaled = sqrt(SNR) * X_mat;
+    const VectorXd Q = Q_mat;
+    vector<double> cdf(M);
+    std::partial_sum(Q_mat.data(), Q_mat.data() + M, cdf.begin());
+
+    const long long block_size = 1024;
+    const long long blocks = (samples + block_size - 1) / block_size;
+    vector<MCBlock> partial(blocks);
+    std::atomic<long long> next_block(0);
+
+    auto worker = [&]() {
+        vector<double> e(M);
+        for (long long b = next_block++; b < blocks; b = next_block++) {
+            MCBlock &acc = partial[b];
+            const long long end = std::min(samples, (b + 1) * block_size);
+            for (long long k = b * block_size; k < end; k++) {
+                const double u = mc_uniform(seed, k, 0) * cdf[M - 1];
+                const int a = std::min<int>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin(), M - 1);
+                const double radius = std::sqrt(-std::log(mc_uniform(seed, k, 1)));
+                const double angle = 2 * PI * mc_uniform(seed, k, 2);
+                const complex<double> z(radius * std::cos(angle), radius * std::sin(angle));
+
+                double g1, h1, g2, h2;
+                mc_integrand(rho, a, z, X_scaled, Q, e, g1, h1);
+                mc_integrand(rho, a, -z, X_scaled, Q, e, g2, h2);
+                const double g = 0.5 * (g1 + g2), h = 0.5 * (h1 + h2);
+                acc.g += g;
+                acc.g2 += g * g;
+                acc.h += h;
+                acc.h2 += h * h;
+                acc.gh += g * h;
+            }
+        }
+    };
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<int>(std::min<long long>(threads, blocks));
+    vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for (auto &t: pool) t.join();
+
+    MCBlock total;
+    for (const MCBlock &p: partial) {
+        total.g += p.g;
+        total.g2 += p.g2;
+        total.h += p.h;
+        total.h2 += p.h2;
+        total.gh += p.gh;
+    }
+    const double K = static_cast<double>(samples);
+    const double T = total.g / K, dT = total.h / K;
+    const double var_g = std::max(total.g2 / K - T * T, 0.0);
+    const double var_h = std::max(total.h2 / K - dT * dT, 0.0);
+    const double cov_gh = total.gh / K - T * dT;
+    const double z95 = 1.959963984540054;
+
+    grad_rho = -dT / (T * std::log(2));
+    // E0 = -log2(T); E0' = -(dT/T)/ln2, linearized in (T, dT)
+    const double ratio = dT / T;
+    const double var_ratio = std::max(var_h - 2 * ratio * cov_gh + ratio * ratio * var_g, 0.0) / (T * T);
+    e0_halfwidth = z95 * std::sqrt(var_g / K) / (T * std::log(2));
+    grad_halfwidth = z95 * std::sqrt(var_ratio / K) / std::log(2);
+    return -log2(T);
+}
+
+// I(X;Y) = E0'(0), R0 = E0(1) and R_crit = E0'(1) at the current SNR, without any rho optimization.
+// Uses the low-SNR series when accurate; otherwise rebuilds D (setW) for the PI set by setPI() and makes
+// a single exponential pass over it: with A = exp(-(D - min_i D)/2) per column, rho = 1 (s = 1/2) needs A
+// and rho = 0 (s = 1) needs A∘A. All logs are taken per column, so no SNR overflows.
+// Also updates the values returned by the getters below.
+void channel_rates(double &mutual_information, double &cutoff_rate, double &critical_rate) {
+    if (useLowSNRSeries()) {
+        double grad_rho, e0;
+        E_0_co(R, 0, grad_rho, e0);
+        mutual_information = grad_rho;
+        E_0_co(R, 1, grad_rho, e0);
+        cutoff_rate = e0;
+        critical_rate = grad_rho;
+    } else {
+        setW();
+        const int M = Q_mat.size();
+        const int cols = D_mat.cols();
+        const int block = cols / M;
+
+        const RowVectorXd min_D = D_mat.colwise().minCoeff();
+        const MatrixXd A = (-0.5 * (D_mat.rowwise() - min_D)).array().exp().matrix();
+        const MatrixXd QA = A.array().colwise() * Q_mat.array();
+        const RowVectorXd sum_half = QA.colwise().sum();                      // sum_i Q_i A_ij
+        const RowVectorXd sum_full = (QA.array() * A.array()).colwise().sum(); // sum_i Q_i A_ij^2
+        const RowVectorXd mean_D = (QA.array() * D_mat.array()).colwise().sum() / sum_half.array();
+
+        // rho = 0: log f_j = -i(x_a; y_j); rho = 1: log f_j = log sum_i Q_i exp(-(D_ij - D_aj)/2)
+        double t0_sum = 0, info = 0, T1 = 0, slope = 0;
+        for (int a = 0; a < M; a++) {
+            for (int j = a * block; j < (a + 1) * block; j++) {
+                const double t0 = Q_mat(a) * PI_mat(a, j) / PI;
+                const double log_f0 = std::log(sum_full(j)) - min_D(j) + D_mat(a, j);
+                const double log_f1 = std::log(sum_half(j)) - 0.5 * (min_D(j) - D_mat(a, j));
+                const double t1 = t0 * std::exp(log_f1);
+                t0_sum += t0;
+                info -= t0 * log_f0;
+                T1 += t1;
+                // d/drho (rho log f_j) at rho = 1 with s' = -1/4
+                slope += t1 * (log_f1 - 0.25 * (D_mat(a, j) - mean_D(j)));
+            }
+        }
+        mutual_information = info / (t0_sum * std::log(2));
+        cutoff_rate = -log2(T1);
+        critical_rate = -slope / (T1 * std::log(2));
+    }
+
+    g_mutual_information = mutual_information;
+    g_cutoff_rate = cutoff_rate;
+    g_critical_rate = critical_rate;
+}
+
 // Getter functions for mutual information, cutoff rate, and critical rate
 // These values are computed during GD_co/GD_iid and stored in global variables
 double getMutualInformation() {
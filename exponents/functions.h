@@ -6,7 +6,9 @@
 #define TFG_FUNCTIONS_H
 #include <complex>
 #include <vector>
+#include <cstdint>
 #include <chrono>
+#include <atomic>
 #include<unordered_map>
 
 using namespace std;
@@ -55,8 +57,24 @@ double fa_co(complex<double> x, complex<double> y, double r, double rho);
 
 double E_0(double rho, vector<double> alphas, int n);
 
+double E_0_cost(double r, double rho, double& grad_r, double& grad_rho);
+
+double E_cost_constrained(double& r, double& rho, int max_iterations, double tolerance);
+
 double E_0_co(double r, double rho, double& grad_rho, double& E0);
 
+double E_0_co_low_snr(double r, double rho, double& grad_rho, double& E0);
+
+double E_0_co_tiled(double r, double rho, double& grad_rho, double& E0);
+double E_0_co_global_grid(double r, double rho, double& grad_rho, double& E0);
+double E_0_co_fast_gauss(double r, double rho, double& grad_rho, double& E0);
+
+bool useLowSNRSeries();
+// The same decision for the constellation X with probabilities Q at snr, without the engine state
+bool lowSNRSeriesFor(const complex<double>* X, const double* Q, int M, double snr);
+
+void setLowSNRTolerance(double tol);
+
 double E_0_co(double r, double rho, double& grad_rho, double& grad_2_rho, double& E0, int n, vector<double> hweights, vector<double> multhweights, vector<double> roots);
 
 double E_0_co(double r, double rho, double& grad_rho, double& E0, int n, vector<double> hweights, vector<double> multhweights, vector<double> roots);
@@ -65,6 +83,16 @@ inline void gradient_f(complex<double> x, complex<double> y, vector<double> alph
 
 double e02(int n);
 
+double channel_dispersion(double& mutual_information);
+
+double normal_approximation(double mutual_information, double dispersion, double R, double n);
+
+double E_0_co_derivatives(double rho, double& d1, double& d2);
+
+double rcu_saddlepoint_point(double R, double& rho_hat, double& d1, double& d2);
+
+double rcu_saddlepoint(double n, double R, double rho_hat, double e0, double d1, double d2);
+
 inline void gradient_e0(vector<double> alphas, double rho, vector<double>& grads_alpha, double& grad_rho, int my_n, vector<double> hweights, vector<double> mult, vector<double> roots);
 
 inline void gradient_e0_co(double r, double rho, double& grad_r, double& grad_rho, int my_n, vector<double> hweights, vector<double> mult, vector<double> roots);
@@ -79,6 +107,89 @@ double GD_co(double &r, double &rho, double &rho_interpolated, int num_iteration
 
 double GD_iid(double& r, double& rho, double& rho_interpolated, int num_iterations, int n, double error);
 
+// Cancellation flag (may be null) and deadline checked by GD_co in the calling thread;
+// getSolverConverged() tells whether the last GD_co run converged rather than stopped or ran out of iterations
+void setSolverStop(const std::atomic<bool>* cancel, std::chrono::steady_clock::time_point deadline);
+bool solverStopRequested();
+bool getSolverConverged();
+
+// Peak bytes of the dense quadrature matrices for M symbols and n nodes per dimension. With a budget
+// below it, setPI/setW switch to the tiled kernel, whose only buffer is tiledPeakBytes.
+// setMemoryBudget sets it for the calling thread, setDefaultMemoryBudget for threads without their
+// own (bytes, 0: none).
+size_t quadraturePeakBytes(int M, int n);
+size_t tiledPeakBytes(int M, int n);
+void setMemoryBudget(size_t bytes);
+void setDefaultMemoryBudget(size_t bytes);
+
+// Tiled kernel for every setup, not only those over budget, and the threads each E_0_co call may
+// split its tiles over. setTiledEvaluation applies to the calling thread (tiled -1 and threads 0: the
+// process default); setDefaultTiledEvaluation sets that default (threads <= 0: all cores).
+void setTiledEvaluation(int tiled, int threads);
+void setDefaultTiledEvaluation(bool tiled, int threads);
+
+// Integrate over one lattice of received points shared by all symbols (E_0_co_global_grid) instead
+// of a Gauss-Hermite grid around each symbol; same conventions (enabled -1: the process default)
+void setGlobalGridQuadrature(int enabled);
+void setDefaultGlobalGridQuadrature(bool enabled);
+
+// Inner symbol sums from a fast Gauss transform with this absolute tolerance (E_0_co_fast_gauss) for
+// constellations of 64 points or more; 0 (or a tolerance of 1 or more) disables it, and
+// setFastGaussTolerance(-1) restores the process default
+void setFastGaussTolerance(double tolerance);
+void setDefaultFastGaussTolerance(double tolerance);
+
+// How E_0_co evaluates the current setup, as an EPEvaluationMode (exponents.h)
+int getEvaluationMode();
+
+// The EPEvaluationMode setPI/setW would pick for M symbols and n nodes per dimension under the calling
+// thread's settings (low-SNR series aside)
+int quadratureModeFor(int M, int n);
+
+// Lattice points per axis of the global grid for symbols spanning width (scaled by sqrt(SNR)) at rho,
+// and its peak bytes for M symbols on a rows x cols lattice
+int globalGridAxisPoints(double width, double rho);
+size_t globalGridPeakBytes(int M, int rows, int cols);
+
+// Whether setPI/setW would build the dense D and PI matrices for the current constellation and N
+bool denseQuadratureSelected();
+
+// While one is alive in a thread, setPI/setW build the dense D and PI matrices whatever tiled, global
+// grid or fast Gauss mode is set, for the routines that index them directly (channel_rates,
+// channel_dispersion, E_0_co_derivatives, E_cost_constrained, optimize_input_distribution and the
+// constellation gradient). The memory budget still applies: over it denseQuadratureSelected() is false
+// and those routines must not be called.
+void enterDenseQuadrature();
+void leaveDenseQuadrature();
+struct DenseQuadratureScope {
+    DenseQuadratureScope() { enterDenseQuadrature(); }
+    ~DenseQuadratureScope() { leaveDenseQuadrature(); }
+    DenseQuadratureScope(const DenseQuadratureScope&) = delete;
+    DenseQuadratureScope& operator=(const DenseQuadratureScope&) = delete;
+};
+
+// Warm start of the next GD_co runs in this thread from the optimum rho of a nearby problem and the
+// cubic fit initial_guess made there (getInitialGuess() after that run): when the optimum is interior,
+// GD_co starts from its own fit plus rho - guess. rho < 0: no warm start.
+void setWarmStart(double rho, double guess);
+double getInitialGuess();
+
+// Dense D and PI held outside the thread's engine state, e.g. by a session whose constellation is
+// edited between solves (session.cpp). Moving symbol i rewrites row i and the n*n columns of symbol i
+// in O(M n^2); appending or removing one computes or drops only those, but copies the rest of D into
+// the resized matrix, O(M^2 n^2) without evaluating a distance (and invalidates PI).
+// quadratureCacheState is 0 unless the cache holds D for M symbols at this SNR and N, 1 when it
+// does, 2 when PI is valid too. exchangeQuadrature swaps the cache with the thread's D_mat and PI_mat
+// (the dense kernel then runs on them without setW) and labels it with SNR and N.
+struct QuadratureCache;
+QuadratureCache* createQuadratureCache();
+void destroyQuadratureCache(QuadratureCache* cache);
+int quadratureCacheState(const QuadratureCache* cache, int M, double snr, int n);
+void exchangeQuadrature(QuadratureCache* cache, double snr, int n);
+void quadratureCacheMoveSymbol(QuadratureCache* cache, const vector<complex<double>>& points, int index);
+void quadratureCacheAppendSymbol(QuadratureCache* cache, const vector<complex<double>>& points);
+void quadratureCacheRemoveSymbol(QuadratureCache* cache, int index);
+
 double GD_cc(double& r, double& rho, double learning_rate, int num_iterations, int n);
 
 void NAG_update(double &x_t, double &y_t, double &x_tp1, double &y_tp1, double beta, double grad, double kaux);
@@ -93,8 +204,6 @@ double NAG_cc(double& r, double& rho, double learning_rate, int num_iterations,
 
 double NM_co(double& r, double& rho, int num_iterations, int n, bool updateR);
 
-vector<chrono::microseconds> getE0_times();
-
 void test();
 
 void setQ(string distribution = "uniform", double shaping_param = 0.0);
@@ -105,8 +214,6 @@ void setPI();
 
 void setW();
 
-unordered_map<string, vector<chrono::microseconds>> get_times();
-
 void setN(int n);
 
 vector<double> getAllHweights();
@@ -129,6 +236,30 @@ bool connect_to_db();
 
 bool disconnect_from_db();
 
+double optimize_input_distribution(double rho_fixed, double& rho, int max_iterations, double tolerance,
+                                   int& iterations, double& kkt_gap, double& scale);
+
+vector<double> getQ();
+
+double E_0_co_gradient(double rho, double& d_rho, double& d_snr, vector<double>& d_Q, vector<complex<double>>& d_X);
+
+double E_0_co_curvature(double rho, double& d_rho, double& d2_rho);
+
+double gradient_E0_constellation(double rho, vector<complex<double>>& grad);
+
+double optimize_constellation_geometry(double rho_fixed, double& rho, int max_iterations, double tolerance,
+                                       int& iterations, double& grad_norm);
+
+vector<complex<double>> getX();
+
+double optimize_shaping_parameter(string objective, double beta_lo, double beta_hi, double beta_start,
+                                  double tolerance, int max_evaluations, double& beta_opt, int& evaluations);
+
+double E_0_monte_carlo(double rho, long long samples, uint64_t seed, int threads, double& grad_rho,
+                       double& e0_halfwidth, double& grad_halfwidth);
+
+void channel_rates(double& mutual_information, double& cutoff_rate, double& critical_rate);
+
 // Getter functions for mutual information, cutoff rate, and critical rate
 // These values are computed during GD_co/GD_iid optimization
 double getMutualInformation();
@@ -0,0 +1,138 @@
+// progressive.cpp
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include "functions.h"
+#include "exponents.h"
+
+// Progressive evaluation for interactive callers: a coarse solve at a few quadrature nodes is
+// reported within milliseconds, then the point is solved again at geometrically growing N, each
+// level warm-started from the previous one. The Gauss-Hermite error falls off quickly with N, so
+// the change from one level to the next bounds the error of the coarser one and estimates that of
+// the finer one conservatively.
+
+namespace {
+
+const int DEFAULT_INITIAL_N = 5;
+const double DEFAULT_GROWTH = 2.0;
+const int PILOT_STEP = 2; // the pilot solve runs at initial_N - PILOT_STEP nodes
+
+int next_N(int N, double growth, int max_N) {
+    return std::min(max_N, std::max(N + 2, static_cast<int>(std::lround(N * growth))));
+}
+
+EPResult failed_result(int status) {
+    EPResult result = EPResult();
+    result.Pe = -1.0;
+    result.E0 = -1.0;
+    result.status = status;
+    return result;
+}
+
+template <typename P>
+int run_progressive(const P* params, const EPProgressiveOptions* options, const EPBatchOptions* call, EPProgressiveResult* out) {
+    *out = EPProgressiveResult();
+    out->final = 1;
+    if (!params || !validPoint(*params)) {
+        out->result = failed_result(EP_STATUS_INVALID_PARAMS);
+        return out->result.status;
+    }
+
+    const int max_N = params->N;
+    const int initial_N = std::min(max_N, options && options->initial_N > 0 ? options->initial_N : DEFAULT_INITIAL_N);
+    const double growth = options && options->growth > 1 ? options->growth : DEFAULT_GROWTH;
+    const double tolerance = options ? options->tolerance : 0.0;
+    auto report = [&](const EPProgressiveResult& level) {
+        if (options && options->on_level) options->on_level(&level, options->user_data);
+    };
+
+    applyCallOptions(call, std::chrono::steady_clock::now());
+    if (solverStopRequested()) {
+        resetCallOptions();
+        out->N = initial_N;
+        out->error_estimate = -1.0;
+        out->result = failed_result(EP_STATUS_CANCELLED);
+        report(*out);
+        return out->result.status;
+    }
+
+    double rho = -1.0, guess = -1.0; // warm start from the last level solved
+    auto solve = [&](int N) {
+        double point[6] = {-1.0, -1.0, 0.0, 0.0, 0.0, 0.0};
+        bool pi_ready = false;
+        setWarmStart(rho, guess);
+        const int status = exponents_point(params->SNR, params->R, N, params->n, params->threshold, pi_ready, point);
+        setWarmStart(-1.0, -1.0);
+        EPResult result = EPResult();
+        result.Pe = point[0];
+        result.E0 = point[1];
+        result.rho = point[2];
+        result.mutual_information = point[3];
+        result.cutoff_rate = point[4];
+        result.critical_rate = point[5];
+        result.status = status;
+        result.converged = getSolverConverged();
+        result.evaluation_mode = getEvaluationMode();
+        if (status == EP_STATUS_OK) {
+            rho = point[2];
+            guess = getInitialGuess();
+        }
+        return result;
+    };
+
+    EPProgressiveResult level = EPProgressiveResult();
+    level.N = initial_N;
+    try {
+        setupPoint(*params);
+
+        bool have_previous = false; // previous_E0 holds a valid exponent of the level below
+        double previous_E0 = 0.0;
+        if (initial_N - PILOT_STEP >= 1) {
+            const EPResult pilot = solve(initial_N - PILOT_STEP);
+            have_previous = pilot.status == EP_STATUS_OK;
+            previous_E0 = pilot.E0;
+        }
+
+        for (;;) {
+            level.result = solve(level.N);
+            const bool valid = level.result.status == EP_STATUS_OK || level.result.status == EP_STATUS_STOPPED;
+            level.error_estimate = (have_previous && valid) ? std::abs(level.result.E0 - previous_E0) : -1.0;
+            const bool accurate = tolerance > 0 && level.error_estimate >= 0 && level.error_estimate <= tolerance;
+            const bool stopped = level.result.status == EP_STATUS_STOPPED || solverStopRequested();
+            level.final = level.N >= max_N || accurate || stopped;
+            report(level);
+            if (level.final) break;
+
+            have_previous = level.result.status == EP_STATUS_OK;
+            previous_E0 = level.result.E0;
+            level.N = next_N(level.N, growth, max_N);
+            level.level++;
+        }
+    } catch (const std::exception&) {
+        setWarmStart(-1.0, -1.0);
+        level.result = failed_result(EP_STATUS_FAILED);
+        level.error_estimate = -1.0;
+        level.final = 1;
+        report(level);
+    }
+    resetCallOptions();
+    *out = level;
+    return out->result.status;
+}
+
+} // namespace
+
+extern "C" {
+
+    int exponents_progressive(const EPParams* params, const EPProgressiveOptions* options, const EPBatchOptions* call,
+                              EPProgressiveResult* result) {
+        return run_progressive(params, options, call, result);
+    }
+
+    int exponents_custom_progressive(const EPCustomParams* params, const EPProgressiveOptions* options,
+                                     const EPBatchOptions* call, EPProgressiveResult* result) {
+        return run_progressive(params, options, call, result);
+    }
+
+}
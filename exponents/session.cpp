@@ -0,0 +1,163 @@
+// session.cpp
+#include <chrono>
+#include <complex>
+#include <exception>
+#include <vector>
+#include "functions.h"
+#include "exponents.h"
+
+// A session owns its constellation and, once a solve has run with dense quadrature, the D and PI
+// matrices of that solve (QuadratureCache). A move patches D in place, an add or remove copies it into
+// the new shape with only the edited symbol's distances computed; a solve at the same SNR and N
+// swaps the matrices into the calling thread's engine state instead of running setW, and swaps them
+// back afterwards. Solves that end up tiled, streaming, on the global grid, with the fast Gauss
+// transform or on the low-SNR series have no D to keep: there an edit costs nothing beyond the
+// constellation itself and only the warm start applies.
+
+struct EPSession {
+    std::vector<std::complex<double>> points;
+    std::vector<double> weights;    // probabilities as given
+    QuadratureCache* cache = nullptr;
+    double rho = -1.0;              // optimal rho of the last solve, < 0: none
+    double guess = -1.0;            // GD_co's initial guess in that solve
+};
+
+namespace {
+
+bool valid_index(const EPSession* session, int index) {
+    return session && index >= 0 && index < static_cast<int>(session->points.size());
+}
+
+void fail(EPResult* result, int status) {
+    *result = EPResult();
+    result->Pe = -1.0;
+    result->E0 = -1.0;
+    result->status = status;
+}
+
+} // namespace
+
+extern "C" {
+
+    EPSession* ep_session_create(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points) {
+        if (!real_parts || !imag_parts || !probabilities || num_points < 1) return nullptr;
+        EPSession* session = new EPSession();
+        for (int i = 0; i < num_points; i++) {
+            session->points.emplace_back(real_parts[i], imag_parts[i]);
+            session->weights.push_back(probabilities[i]);
+        }
+        session->cache = createQuadratureCache();
+        return session;
+    }
+
+    void ep_session_destroy(EPSession* session) {
+        if (!session) return;
+        destroyQuadratureCache(session->cache);
+        delete session;
+    }
+
+    int ep_session_size(const EPSession* session) {
+        return session ? static_cast<int>(session->points.size()) : 0;
+    }
+
+    int ep_session_move_point(EPSession* session, int index, double real, double imag) {
+        if (!valid_index(session, index)) return EP_STATUS_INVALID_PARAMS;
+        session->points[index] = std::complex<double>(real, imag);
+        quadratureCacheMoveSymbol(session->cache, session->points, index);
+        return EP_STATUS_OK;
+    }
+
+    int ep_session_set_probability(EPSession* session, int index, double probability) {
+        if (!valid_index(session, index) || !(probability >= 0)) return EP_STATUS_INVALID_PARAMS;
+        session->weights[index] = probability; // D does not depend on Q
+        return EP_STATUS_OK;
+    }
+
+    int ep_session_add_point(EPSession* session, double real, double imag, double probability) {
+        if (!session || !(probability >= 0)) return EP_STATUS_INVALID_PARAMS;
+        session->points.emplace_back(real, imag);
+        session->weights.push_back(probability);
+        quadratureCacheAppendSymbol(session->cache, session->points);
+        return EP_STATUS_OK;
+    }
+
+    int ep_session_remove_point(EPSession* session, int index) {
+        if (!valid_index(session, index) || session->points.size() == 1) return EP_STATUS_INVALID_PARAMS;
+        session->points.erase(session->points.begin() + index);
+        session->weights.erase(session->weights.begin() + index);
+        quadratureCacheRemoveSymbol(session->cache, index);
+        return EP_STATUS_OK;
+    }
+
+    int ep_session_solve(EPSession* session, double SNR, double R, int N, double n, double threshold,
+                         const EPBatchOptions* options, EPResult* result) {
+        double total = 0.0;
+        if (session) {
+            for (double w: session->weights) total += w;
+        }
+        if (!session || N < 1 || !(total > 0)) {
+            fail(result, EP_STATUS_INVALID_PARAMS);
+            return result->status;
+        }
+
+        const int M = static_cast<int>(session->points.size());
+        std::vector<double> re(M), im(M), Q(M);
+        for (int i = 0; i < M; i++) {
+            re[i] = session->points[i].real();
+            im[i] = session->points[i].imag();
+            Q[i] = session->weights[i] / total;
+        }
+
+        applyCallOptions(options, std::chrono::steady_clock::now());
+        if (solverStopRequested()) {
+            resetCallOptions();
+            fail(result, EP_STATUS_CANCELLED);
+            return result->status;
+        }
+
+        bool held = false; // the thread's D_mat and PI_mat are the cache's
+        try {
+            setCustomConstellation(re.data(), im.data(), Q.data(), M);
+            setSNR(SNR);
+            setN(N);
+            const bool dense = !useLowSNRSeries() && denseQuadratureSelected();
+            const int cached = dense ? quadratureCacheState(session->cache, M, SNR, N) : 0;
+            bool pi_ready = cached == 2;
+            if (cached) {
+                exchangeQuadrature(session->cache, SNR, N);
+                held = true;
+            }
+
+            double point[6] = {-1.0, -1.0, 0.0, 0.0, 0.0, 0.0};
+            setWarmStart(session->rho, session->guess);
+            const int status = exponents_point(SNR, R, N, n, threshold, pi_ready, point, cached > 0);
+            setWarmStart(-1.0, -1.0);
+            if (dense) { // keep this solve's D and PI
+                exchangeQuadrature(session->cache, SNR, N);
+                held = false;
+            }
+
+            *result = EPResult();
+            result->Pe = point[0];
+            result->E0 = point[1];
+            result->rho = point[2];
+            result->mutual_information = point[3];
+            result->cutoff_rate = point[4];
+            result->critical_rate = point[5];
+            result->status = status;
+            result->converged = getSolverConverged();
+            result->evaluation_mode = getEvaluationMode();
+            if (status == EP_STATUS_OK) {
+                session->rho = point[2];
+                session->guess = getInitialGuess();
+            }
+        } catch (const std::exception&) {
+            setWarmStart(-1.0, -1.0);
+            if (held) exchangeQuadrature(session->cache, SNR, N);
+            fail(result, EP_STATUS_FAILED);
+        }
+        resetCallOptions();
+        return result->status;
+    }
+
+}
@@ -0,0 +1,39 @@
+// check.h — assertions of the exponents/tests programs: each failed CHECK is reported and the
+// program then exits with status 1 (see `make test`)
+#ifndef EXPONENTS_TESTS_CHECK_H
+#define EXPONENTS_TESTS_CHECK_H
+
+#include <cmath>
+#include <iostream>
+
+static int check_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed\n"; \
+            check_failures++; \
+        } \
+    } while (0)
+
+// |a - b| <= tol, with both values in the message when it fails
+#define CHECK_NEAR(a, b, tol) \
+    do { \
+        const double check_a = (a), check_b = (b); \
+        if (!(std::fabs(check_a - check_b) <= (tol))) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_NEAR(" #a ", " #b ", " #tol ") failed: " \
+                      << check_a << " vs " << check_b << "\n"; \
+            check_failures++; \
+        } \
+    } while (0)
+
+static int check_report(const char* name) {
+    if (check_failures) {
+        std::cerr << name << ": " << check_failures << " failed check(s)\n";
+        return 1;
+    }
+    std::cerr << name << ": ok\n";
+    return 0;
+}
+
+#endif
@@ -0,0 +1,122 @@
+// exponents_batch and exponents_custom_batch against exponents() and exponents_custom() point by point,
+// over mixed constellations, distributions, N and SNR in shuffled order (so setups are shared only after
+// sorting); invalid points are flagged without touching the others, and the thread count changes nothing.
+#include <cmath>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+#include "exponents.h"
+
+extern "C" {
+double* exponents(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+double* exponents_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, double n, double threshold, double* results);
+}
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+static const char* modulation_name(int modulation) {
+    return modulation == EP_MOD_PSK ? "PSK" : modulation == EP_MOD_QAM ? "QAM" : "PAM";
+}
+
+static void check_same(const EPResult& got, const double* expected, size_t index) {
+    CHECK(got.index == index);
+    CHECK(got.status == EP_STATUS_OK);
+    CHECK(got.Pe == expected[0]);
+    CHECK(got.E0 == expected[1]);
+    CHECK(got.rho == expected[2]);
+    CHECK(got.mutual_information == expected[3]);
+    CHECK(got.cutoff_rate == expected[4]);
+    CHECK(got.critical_rate == expected[5]);
+}
+
+static bool same_results(const std::vector<EPResult>& a, const std::vector<EPResult>& b) {
+    for (size_t k = 0; k < a.size(); k++) {
+        if (a[k].Pe != b[k].Pe || a[k].E0 != b[k].E0 || a[k].rho != b[k].rho || a[k].status != b[k].status ||
+            a[k].mutual_information != b[k].mutual_information || a[k].index != b[k].index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_standard() {
+    // interleaved so that equal setups are not adjacent; two invalid points in between
+    std::vector<EPParams> params = {
+        {16, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 10.0, 1.5, BLOCKLENGTH, THRESHOLD},
+        {8, EP_MOD_PSK, EP_DIST_UNIFORM, 6, 0.0, 3.0, 0.5, BLOCKLENGTH, THRESHOLD},
+        {4, EP_MOD_PAM, EP_DIST_MAXWELL_BOLTZMANN, 8, 0.3, 5.0, 0.8, BLOCKLENGTH, THRESHOLD},
+        {0, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 10.0, 1.0, BLOCKLENGTH, THRESHOLD},
+        {16, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 3.0, 1.0, BLOCKLENGTH, THRESHOLD},
+        {8, EP_MOD_PSK, EP_DIST_UNIFORM, 10, 0.0, 3.0, 0.5, BLOCKLENGTH, THRESHOLD},
+        {4, EP_MOD_PAM, EP_DIST_MAXWELL_BOLTZMANN, 8, 0.3, 1.0, 0.2, BLOCKLENGTH, THRESHOLD},
+        {16, EP_MOD_QAM, 7, 8, 0.0, 10.0, 1.0, BLOCKLENGTH, THRESHOLD},
+        {16, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 30.0, 2.5, BLOCKLENGTH, THRESHOLD},
+        {8, EP_MOD_PSK, EP_DIST_UNIFORM, 6, 0.0, 10.0, 1.0, BLOCKLENGTH, THRESHOLD},
+    };
+    const size_t count = params.size();
+
+    std::vector<EPResult> one(count), three(count);
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(params.data(), count, one.data(), &options);
+    options.threads = 3;
+    exponents_batch(params.data(), count, three.data(), &options);
+    CHECK(same_results(one, three));
+
+    for (size_t k = 0; k < count; k++) {
+        const EPParams& p = params[k];
+        if (p.M < 1 || p.distribution > EP_DIST_MAXWELL_BOLTZMANN) {
+            CHECK(one[k].index == k);
+            CHECK(one[k].status == EP_STATUS_INVALID_PARAMS);
+            CHECK(one[k].Pe == -1.0 && one[k].E0 == -1.0);
+            continue;
+        }
+        double expected[6];
+        exponents(p.M, modulation_name(p.modulation), p.SNR, p.R, p.N, p.n, p.threshold,
+                  p.distribution == EP_DIST_MAXWELL_BOLTZMANN ? "maxwell-boltzmann" : "uniform", p.shaping_param, expected);
+        check_same(one[k], expected, k);
+        CHECK(one[k].evaluation_mode == EP_EVAL_DENSE);
+    }
+
+    // nothing to do
+    exponents_batch(params.data(), 0, nullptr, nullptr);
+}
+
+static void check_custom() {
+    // an off-centre 3-point constellation and 4-QAM with skewed probabilities, points sharing the arrays
+    const double tri_re[3] = {1.0, -0.5, -0.5}, tri_im[3] = {0.2, 0.9, -0.7}, tri_q[3] = {0.5, 0.25, 0.25};
+    const double qam_re[4] = {1, -1, -1, 1}, qam_im[4] = {1, 1, -1, -1}, qam_q[4] = {0.4, 0.3, 0.2, 0.1};
+    std::vector<EPCustomParams> params = {
+        {tri_re, tri_im, tri_q, 3, 8, 2.0, 0.3, BLOCKLENGTH, THRESHOLD},
+        {qam_re, qam_im, qam_q, 4, 8, 5.0, 0.8, BLOCKLENGTH, THRESHOLD},
+        {tri_re, tri_im, tri_q, 3, 8, 8.0, 0.6, BLOCKLENGTH, THRESHOLD},
+        {qam_re, qam_im, nullptr, 4, 8, 5.0, 0.8, BLOCKLENGTH, THRESHOLD},
+        {qam_re, qam_im, qam_q, 4, 10, 1.0, 0.1, BLOCKLENGTH, THRESHOLD},
+    };
+    const size_t count = params.size();
+
+    std::vector<EPResult> one(count), two(count);
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_custom_batch(params.data(), count, one.data(), &options);
+    options.threads = 2;
+    exponents_custom_batch(params.data(), count, two.data(), &options);
+    CHECK(same_results(one, two));
+
+    for (size_t k = 0; k < count; k++) {
+        const EPCustomParams& p = params[k];
+        if (!p.probabilities) {
+            CHECK(one[k].status == EP_STATUS_INVALID_PARAMS);
+            continue;
+        }
+        double expected[6];
+        exponents_custom(p.real_parts, p.imag_parts, p.probabilities, p.num_points, p.SNR, p.R, p.N, p.n, p.threshold, expected);
+        check_same(one[k], expected, k);
+    }
+}
+
+int main() {
+    check_standard();
+    check_custom();
+    return check_report("test_batch");
+}
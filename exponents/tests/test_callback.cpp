@@ -0,0 +1,83 @@
+// The on_result callback of exponents_batch: called exactly once per point, invalid ones included, with
+// the results entry already filled, never from two workers at once, and the same whether or not a
+// callback is set.
+#include <atomic>
+#include <vector>
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+struct Record {
+    const EPResult* results;
+    std::vector<int> calls;
+    std::vector<size_t> order;
+    std::atomic<int> inside{0};
+    bool overlapped = false;
+    bool filled = true;
+};
+
+static void on_result(size_t index, const EPResult* result, void* user_data) {
+    Record& record = *static_cast<Record*>(user_data);
+    if (record.inside.fetch_add(1) != 0) record.overlapped = true;
+    record.calls[index]++;
+    record.order.push_back(index);
+    if (result != &record.results[index] || result->index != index) record.filled = false;
+    record.inside.fetch_sub(1);
+}
+
+int main() {
+    std::vector<EPParams> params;
+    for (int k = 0; k < 12; k++) {
+        const int M = k % 3 == 0 ? 4 : k % 3 == 1 ? 8 : 16;
+        params.push_back({M, k % 3 == 1 ? EP_MOD_PSK : EP_MOD_QAM, EP_DIST_UNIFORM, 6 + k % 2 * 2, 0.0,
+                          1.0 + k, 0.2 + 0.1 * k, BLOCKLENGTH, THRESHOLD});
+    }
+    params[5].M = 0;
+    params[9].modulation = 9;
+    const size_t count = params.size();
+
+    std::vector<EPResult> plain(count);
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(params.data(), count, plain.data(), &options);
+
+    for (int threads: {1, 4}) {
+        std::vector<EPResult> results(count);
+        Record record;
+        record.results = results.data();
+        record.calls.assign(count, 0);
+        options.threads = threads;
+        options.on_result = on_result;
+        options.user_data = &record;
+        exponents_batch(params.data(), count, results.data(), &options);
+
+        CHECK(!record.overlapped);
+        CHECK(record.filled);
+        CHECK(record.order.size() == count);
+        for (size_t k = 0; k < count; k++) {
+            CHECK(record.calls[k] == 1);
+            CHECK(results[k].status == plain[k].status);
+            CHECK(results[k].E0 == plain[k].E0 && results[k].rho == plain[k].rho);
+        }
+        CHECK(results[5].status == EP_STATUS_INVALID_PARAMS && results[9].status == EP_STATUS_INVALID_PARAMS);
+        // the invalid points are reported before anything is solved
+        CHECK(record.order[0] == 5 && record.order[1] == 9);
+    }
+
+    // the custom batch reports the same way
+    const double re[3] = {1.0, -0.5, -0.5}, im[3] = {0.0, 0.8, -0.8}, q[3] = {0.4, 0.3, 0.3};
+    std::vector<EPCustomParams> custom;
+    for (int k = 0; k < 4; k++) custom.push_back({re, im, q, 3, 6, 1.0 + k, 0.3, BLOCKLENGTH, THRESHOLD});
+    std::vector<EPResult> results(custom.size());
+    Record record;
+    record.results = results.data();
+    record.calls.assign(custom.size(), 0);
+    options.threads = 2;
+    options.user_data = &record;
+    exponents_custom_batch(custom.data(), custom.size(), results.data(), &options);
+    CHECK(!record.overlapped && record.filled);
+    for (size_t k = 0; k < custom.size(); k++) CHECK(record.calls[k] == 1 && results[k].status == EP_STATUS_OK);
+
+    return check_report("test_callback");
+}
@@ -0,0 +1,114 @@
+// Cancellation tokens and deadlines: a cancelled token or an expired deadline marks the points not yet
+// started EP_STATUS_CANCELLED (invalid ones stay EP_STATUS_INVALID_PARAMS), cancelling from the callback
+// keeps the points already solved, a stop inside the solver returns the best end point as
+// EP_STATUS_STOPPED, and nothing carries over to the next call.
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+static std::vector<EPParams> make_points() {
+    std::vector<EPParams> params;
+    for (int k = 0; k < 8; k++) {
+        params.push_back({k < 4 ? 16 : 8, k < 4 ? EP_MOD_QAM : EP_MOD_PSK, EP_DIST_UNIFORM, 6, 0.0,
+                          2.0 + k, 0.5 + 0.1 * k, BLOCKLENGTH, THRESHOLD});
+    }
+    params[2].N = 0;
+    return params;
+}
+
+struct Canceller {
+    EPCancelToken* token;
+    size_t solved;
+    size_t after;
+};
+
+static void cancel_after(size_t, const EPResult* result, void* user_data) {
+    Canceller& c = *static_cast<Canceller*>(user_data);
+    if (result->status == EP_STATUS_OK && ++c.solved == c.after) ep_cancel_token_cancel(c.token);
+}
+
+static void check_cancelled(const EPResult& r) {
+    CHECK(r.status == EP_STATUS_CANCELLED);
+    CHECK(r.Pe == -1.0 && r.E0 == -1.0);
+    CHECK(!r.converged);
+}
+
+int main() {
+    const std::vector<EPParams> params = make_points();
+    const size_t count = params.size();
+    std::vector<EPResult> plain(count);
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(params.data(), count, plain.data(), &options);
+    for (size_t k = 0; k < count; k++) CHECK(plain[k].status == (k == 2 ? EP_STATUS_INVALID_PARAMS : EP_STATUS_OK));
+
+    EPCancelToken* token = ep_cancel_token_create();
+    CHECK(!ep_cancel_token_is_cancelled(token));
+
+    // cancelled from the callback after three solved points: those keep their results, the rest never start
+    Canceller canceller = {token, 0, 3};
+    std::vector<EPResult> results(count);
+    options.cancel = token;
+    options.on_result = cancel_after;
+    options.user_data = &canceller;
+    exponents_batch(params.data(), count, results.data(), &options);
+    CHECK(ep_cancel_token_is_cancelled(token));
+    size_t solved = 0, cancelled = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (results[k].status == EP_STATUS_OK) {
+            solved++;
+            CHECK(results[k].E0 == plain[k].E0 && results[k].rho == plain[k].rho);
+        } else if (k != 2) {
+            cancelled++;
+            check_cancelled(results[k]);
+        }
+    }
+    CHECK(solved == 3 && cancelled == count - 4);
+    CHECK(results[2].status == EP_STATUS_INVALID_PARAMS);
+
+    // already cancelled: nothing is solved, on any number of threads
+    options.on_result = nullptr;
+    for (int threads: {1, 3}) {
+        options.threads = threads;
+        exponents_batch(params.data(), count, results.data(), &options);
+        for (size_t k = 0; k < count; k++) {
+            if (k == 2) CHECK(results[k].status == EP_STATUS_INVALID_PARAMS);
+            else check_cancelled(results[k]);
+        }
+    }
+    ep_cancel_token_destroy(token);
+
+    // a deadline that has passed before the first point
+    options.cancel = nullptr;
+    options.timeout_ms = 1e-6;
+    exponents_batch(params.data(), count, results.data(), &options);
+    for (size_t k = 0; k < count; k++) if (k != 2) check_cancelled(results[k]);
+
+    // the same batch without either solves normally again
+    options.timeout_ms = 0;
+    options.threads = 1;
+    exponents_batch(params.data(), count, results.data(), &options);
+    for (size_t k = 0; k < count; k++) CHECK(results[k].status == plain[k].status && results[k].E0 == plain[k].E0);
+
+    // stopped inside the solver: the better of the two end points rho = 0 and 1, below the optimum
+    const EPParams& p = params[0];
+    setupPoint(p);
+    const std::atomic<bool> stop(true);
+    setSolverStop(&stop, std::chrono::steady_clock::time_point::max());
+    bool pi_ready = false;
+    double point[6];
+    const int status = exponents_point(p.SNR, p.R, p.N, p.n, p.threshold, pi_ready, point);
+    setSolverStop(nullptr, std::chrono::steady_clock::time_point::max());
+    CHECK(status == EP_STATUS_STOPPED);
+    CHECK(!getSolverConverged());
+    CHECK(point[2] == 0.0 || point[2] == 1.0);
+    CHECK(point[1] >= 0 && point[1] <= plain[0].E0 + 1e-12);
+    CHECK_NEAR(point[1], point[2] == 1.0 ? point[4] - p.R : 0.0, 1e-12);
+
+    return check_report("test_cancellation");
+}
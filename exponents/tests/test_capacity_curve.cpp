@@ -0,0 +1,74 @@
+// I(X;Y), R0 and R_crit across SNR (capacity_curve): the single pass of channel_rates against E0 and
+// E0' from the E_0_co kernel at rho = 0 and 1, at SNRs from the low-SNR series to saturation, with
+// R_crit <= R0 <= I <= H(Q) and I increasing in SNR; the custom version gives the same curve.
+#include <cmath>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+extern "C" {
+void capacity_curve(double M, const char* typeM, const double* snr_values, int count, double N, const char* distribution, double shaping_param, double* mi_out, double* r0_out, double* rcrit_out);
+void capacity_curve_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, const double* snr_values, int count, double N, double* mi_out, double* r0_out, double* rcrit_out);
+}
+
+static const int N = 10, COUNT = 6;
+static const double SNRS[COUNT] = {1e-3, 0.1, 1.0, 3.0, 30.0, 1000.0};
+
+static void check_case(int M, const char* type, const char* distribution, double beta) {
+    double mi[COUNT], r0[COUNT], rcrit[COUNT];
+    capacity_curve(M, type, SNRS, COUNT, N, distribution, beta, mi, r0, rcrit);
+
+    setMod(M, type);
+    setQ(distribution, beta);
+    normalizeX_for_Q();
+    setN(N);
+    const vector<complex<double>> x = getX();
+    const vector<double> q = getQ();
+    double entropy = 0;
+    for (double p: q) entropy -= p * std::log2(p);
+    for (int k = 0; k < COUNT; k++) {
+        setSNR(SNRS[k]);
+        setPI();
+        setW();
+        double d0, d1, e0, e1;
+        E_0_co(0, 0, d0, e0);
+        E_0_co(0, 1, d1, e1);
+        CHECK_NEAR(mi[k], d0, 1e-9);
+        CHECK_NEAR(r0[k], e1, 1e-9);
+        CHECK_NEAR(rcrit[k], d1, 1e-9);
+
+        CHECK(rcrit[k] <= r0[k] + 1e-12 && r0[k] <= mi[k] + 1e-12 && mi[k] <= entropy + 1e-9);
+        if (k > 0) CHECK(mi[k] > mi[k - 1]);
+    }
+    // saturating at H(Q)
+    CHECK_NEAR(mi[COUNT - 1], entropy, 1e-3);
+
+    // the same points as a custom constellation
+    vector<double> re, im;
+    for (const auto& p: x) {
+        re.push_back(p.real());
+        im.push_back(p.imag());
+    }
+    double mi_custom[COUNT], r0_custom[COUNT], rcrit_custom[COUNT];
+    capacity_curve_custom(re.data(), im.data(), q.data(), M, SNRS, COUNT, N, mi_custom, r0_custom, rcrit_custom);
+    for (int k = 0; k < COUNT; k++) {
+        CHECK_NEAR(mi_custom[k], mi[k], 1e-12);
+        CHECK_NEAR(r0_custom[k], r0[k], 1e-12);
+        CHECK_NEAR(rcrit_custom[k], rcrit[k], 1e-12);
+    }
+}
+
+int main() {
+    check_case(4, "QAM", "uniform", 0.0);
+    check_case(16, "QAM", "uniform", 0.0);
+    check_case(16, "QAM", "maxwell-boltzmann", 0.5);
+    check_case(8, "PSK", "uniform", 0.0);
+    check_case(8, "PAM", "uniform", 0.0);
+
+    // a zero-length curve touches nothing
+    double untouched = 7.0;
+    capacity_curve(16, "QAM", SNRS, 0, N, "uniform", 0.0, &untouched, &untouched, &untouched);
+    CHECK(untouched == 7.0);
+
+    return check_report("test_capacity_curve");
+}
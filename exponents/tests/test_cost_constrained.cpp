@@ -0,0 +1,88 @@
+// Cost-constrained exponent (E_cost_constrained): a stationary point in rho and r, not below a grid
+// over both, above the i.i.d. exponent (r = 0) and equal to it when every point has the same energy.
+// The alpha-tilted E_0 with alpha_i = r cost_i is the same tilt, so it must agree with E_0_cost.
+#include <cmath>
+#include <string>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+extern "C" {
+double* exponents_cost_constrained(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+}
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-9;
+static const int N = 8;
+
+static void setup(int M, const char* type, double snr, double rate, const char* distribution, double beta) {
+    setMod(M, type);
+    setQ(distribution, beta);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setR(rate);
+    setN(N);
+    setPI();
+    setW();
+}
+
+static void check_case(int M, const char* type, double snr, double rate, const char* distribution, double beta, bool gain) {
+    setup(M, type, snr, rate, distribution, beta);
+    double r, rho;
+    const double exponent = E_cost_constrained(r, rho, 50, THRESHOLD);
+    CHECK(rho >= 0 && rho <= 1);
+
+    // stationary in r, and in rho unless at the edge
+    double grad_r, grad_rho;
+    CHECK_NEAR(exponent, E_0_cost(r, rho, grad_r, grad_rho) - rho * rate, 1e-12);
+    CHECK_NEAR(grad_r, 0.0, 1e-6);
+    if (rho < 1) CHECK_NEAR(grad_rho, rate, 1e-6); else CHECK(grad_rho >= rate);
+    // and not below a grid over both
+    for (double rho_k: {0.0, 0.25, 0.5, 0.75, 1.0}) {
+        for (double r_k: {-1.0, -0.5, -0.25, 0.0, 0.25}) {
+            CHECK(exponent >= E_0_cost(r_k, rho_k, grad_r, grad_rho) - rho_k * rate - 1e-9);
+        }
+    }
+
+    // r = 0 is the i.i.d. exponent
+    double r_iid, rho_iid, rho_interpolated;
+    const double iid = GD_co(r_iid, rho_iid, rho_interpolated, 20, N, false, THRESHOLD);
+    if (gain) {
+        CHECK(exponent > iid + 1e-6);
+        CHECK(std::abs(r) > 1e-3);
+    } else {
+        CHECK_NEAR(exponent, iid, 1e-6);
+    }
+
+    // alpha_i = r cost_i
+    const vector<complex<double>> x = getX();
+    const vector<double> q = getQ();
+    double power = 0;
+    for (int i = 0; i < M; i++) power += q[i] * std::norm(x[i]);
+    vector<double> alphas;
+    for (int i = 0; i < M; i++) alphas.push_back(r * (std::norm(x[i]) - power));
+    CHECK_NEAR(E_0(rho, alphas, N), E_0_cost(r, rho, grad_r, grad_rho), 1e-12);
+
+    // the C entry point
+    double results[4];
+    exponents_cost_constrained(M, type, snr, rate, N, BLOCKLENGTH, THRESHOLD, distribution, beta, results);
+    CHECK_NEAR(results[1], exponent, 1e-12);
+    CHECK_NEAR(results[2], rho, 1e-12);
+    CHECK_NEAR(results[3], r, 1e-12);
+    CHECK_NEAR(results[0], std::pow(2.0, -BLOCKLENGTH * exponent), 1e-15);
+}
+
+int main() {
+    check_case(16, "QAM", 3.0, 1.0, "uniform", 0.0, true);
+    check_case(16, "QAM", 3.0, 1.7, "uniform", 0.0, true); // optimum inside (0, 1)
+    check_case(16, "QAM", 10.0, 3.0, "maxwell-boltzmann", 0.5, true);
+    check_case(8, "PAM", 10.0, 1.0, "uniform", 0.0, true);
+    // no cost differences to tilt by
+    check_case(8, "PSK", 3.0, 1.0, "uniform", 0.0, false);
+
+    // above I(X;Y) there is no exponent
+    setup(16, "QAM", 3.0, 2.5, "uniform", 0.0);
+    double r, rho;
+    CHECK(E_cost_constrained(r, rho, 50, THRESHOLD) == 0 && rho == 0);
+
+    return check_report("test_cost_constrained");
+}
@@ -0,0 +1,143 @@
+// The cost model follows the evaluation mode a point would run in: the mode of each estimate matches
+// the one the batch reports under the same options, and its time and peak memory come from that
+// mode's coefficients and buffers (dense matrices, tiled factor tables, or a global grid sized
+// independently of N); points on the low-SNR series cost only the overhead.
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+static EPCostEstimate estimate_under(const EPParams& p, const EPBatchOptions& options) {
+    EPCostEstimate estimate;
+    applyCallOptions(&options, std::chrono::steady_clock::now());
+    CHECK(ep_estimate_cost(&p, &estimate) == EP_STATUS_OK);
+    resetCallOptions();
+    return estimate;
+}
+
+static int batch_mode(const EPParams& p, EPBatchOptions options) {
+    EPResult result;
+    options.threads = 1;
+    exponents_batch(&p, 1, &result, &options);
+    CHECK(result.status == EP_STATUS_OK);
+    return result.evaluation_mode;
+}
+
+int main() {
+    EPCostModel model;
+    ep_calibrate_cost_model(&model);
+    CHECK(model.setup_ns_per_cell > 0 && model.eval_ns_per_cell > 0);
+    CHECK(model.tiled_ns_per_cell > 0 && model.grid_ns_per_cell > 0);
+    CHECK(model.evaluations >= 1 && model.overhead_ms >= 0 && model.calibration_ms > 0);
+
+    const EPParams qam16 = {16, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 5.0, 1.0, BLOCKLENGTH, THRESHOLD};
+    const EPParams qam64 = {64, EP_MOD_QAM, EP_DIST_UNIFORM, 4, 0.0, 30.0, 2.0, BLOCKLENGTH, THRESHOLD};
+    const double cells16 = 16.0 * 16 * 8 * 8;
+
+    // dense by default
+    EPBatchOptions options = {};
+    EPCostEstimate e = estimate_under(qam16, options);
+    CHECK(e.evaluation_mode == EP_EVAL_DENSE && batch_mode(qam16, options) == EP_EVAL_DENSE);
+    CHECK(e.peak_bytes == static_cast<double>(quadraturePeakBytes(16, 8)));
+    CHECK(e.streaming_peak_bytes == static_cast<double>(tiledPeakBytes(16, 8)));
+    CHECK_NEAR(e.time_ms, model.overhead_ms + 1e-6 * cells16 * (model.setup_ns_per_cell + model.evaluations * model.eval_ns_per_cell), 1e-9);
+
+    // over the memory budget: streaming, with only the tiled buffers
+    options.memory_budget = quadraturePeakBytes(16, 8) - 1;
+    e = estimate_under(qam16, options);
+    CHECK(e.evaluation_mode == EP_EVAL_STREAMING && batch_mode(qam16, options) == EP_EVAL_STREAMING);
+    CHECK(e.peak_bytes == e.streaming_peak_bytes);
+    CHECK_NEAR(e.time_ms, model.overhead_ms + 1e-6 * cells16 * model.evaluations * model.tiled_ns_per_cell, 1e-9);
+
+    // tiled within budget: the same cost as streaming
+    options.memory_budget = 0;
+    options.tiled = 1;
+    const EPCostEstimate tiled = estimate_under(qam16, options);
+    CHECK(tiled.evaluation_mode == EP_EVAL_TILED && batch_mode(qam16, options) == EP_EVAL_TILED);
+    CHECK(tiled.time_ms == e.time_ms && tiled.peak_bytes == e.peak_bytes);
+
+    // global grid: the lattice does not depend on N, so neither does the estimate
+    options.tiled = 0;
+    options.global_grid = 1;
+    e = estimate_under(qam16, options);
+    CHECK(e.evaluation_mode == EP_EVAL_GLOBAL_GRID && batch_mode(qam16, options) == EP_EVAL_GLOBAL_GRID);
+    EPParams fine = qam16;
+    fine.N = 30;
+    const EPCostEstimate grid_fine = estimate_under(fine, options);
+    CHECK(grid_fine.time_ms == e.time_ms && grid_fine.peak_bytes == e.peak_bytes);
+    CHECK(grid_fine.streaming_peak_bytes > e.streaming_peak_bytes);
+    // sized from the widths of the constellation: the same points as a custom constellation agree
+    setMod(16, "QAM");
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    std::vector<double> re, im, q(16, 1.0 / 16);
+    for (const auto& x: getX()) {
+        re.push_back(x.real());
+        im.push_back(x.imag());
+    }
+    const EPCustomParams custom = {re.data(), im.data(), q.data(), 16, 8, qam16.SNR, qam16.R, BLOCKLENGTH, THRESHOLD};
+    applyCallOptions(&options, std::chrono::steady_clock::now());
+    EPCostEstimate custom_estimate;
+    CHECK(ep_estimate_custom_cost(&custom, &custom_estimate) == EP_STATUS_OK);
+    resetCallOptions();
+    CHECK(custom_estimate.evaluation_mode == EP_EVAL_GLOBAL_GRID);
+    CHECK_NEAR(custom_estimate.time_ms, e.time_ms, 1e-9 * e.time_ms);
+    // a wider spread (higher SNR) needs a larger lattice
+    EPParams loud = qam16;
+    loud.SNR = 100.0;
+    CHECK(estimate_under(loud, options).time_ms > e.time_ms);
+
+    // fast Gauss from 64 points on, costed as the tiled kernel it never runs slower than
+    options.global_grid = 0;
+    options.fast_gauss_tolerance = 1e-6;
+    CHECK(estimate_under(qam16, options).evaluation_mode == EP_EVAL_DENSE);
+    e = estimate_under(qam64, options);
+    CHECK(e.evaluation_mode == EP_EVAL_FAST_GAUSS && batch_mode(qam64, options) == EP_EVAL_FAST_GAUSS);
+    options.fast_gauss_tolerance = 0;
+    options.tiled = 1;
+    CHECK(estimate_under(qam64, options).time_ms == e.time_ms);
+
+    // low SNR: the series, without any quadrature, whatever the N or the requested mode
+    EPParams quiet = qam64;
+    quiet.SNR = 1e-4;
+    quiet.N = 40;
+    for (int tiled: {0, 1}) {
+        options.tiled = tiled;
+        e = estimate_under(quiet, options);
+        CHECK(e.evaluation_mode == EP_EVAL_LOW_SNR_SERIES && batch_mode(quiet, options) == EP_EVAL_LOW_SNR_SERIES);
+        CHECK(e.time_ms == model.overhead_ms && e.peak_bytes == 0);
+    }
+    options.tiled = 0;
+    // shaped and custom constellations decide it from their own moments, as the solver does
+    EPParams shaped = qam16;
+    shaped.distribution = EP_DIST_MAXWELL_BOLTZMANN;
+    shaped.shaping_param = 1.0;
+    for (double snr: {1e-4, 1.0}) {
+        shaped.SNR = snr;
+        CHECK(estimate_under(shaped, options).evaluation_mode == batch_mode(shaped, options));
+    }
+    const EPCustomParams quiet_custom = {re.data(), im.data(), q.data(), 16, 40, 1e-4, qam16.R, BLOCKLENGTH, THRESHOLD};
+    CHECK(ep_estimate_custom_cost(&quiet_custom, &custom_estimate) == EP_STATUS_OK);
+    CHECK(custom_estimate.evaluation_mode == EP_EVAL_LOW_SNR_SERIES && custom_estimate.peak_bytes == 0);
+
+    // the process defaults count for calls without options
+    ep_set_tiled_evaluation(1, 1);
+    EPCostEstimate by_default;
+    CHECK(ep_estimate_cost(&qam16, &by_default) == EP_STATUS_OK);
+    CHECK(by_default.evaluation_mode == EP_EVAL_TILED);
+    ep_set_tiled_evaluation(0, 1);
+    CHECK(ep_estimate_cost(&qam16, &by_default) == EP_STATUS_OK);
+    CHECK(by_default.evaluation_mode == EP_EVAL_DENSE);
+
+    // invalid points are rejected with a zeroed estimate
+    EPParams invalid = qam16;
+    invalid.N = 0;
+    CHECK(ep_estimate_cost(&invalid, &e) == EP_STATUS_INVALID_PARAMS);
+    CHECK(e.time_ms == 0 && e.peak_bytes == 0 && e.evaluation_mode == 0);
+
+    return check_report("test_cost_model");
+}
@@ -0,0 +1,123 @@
+// Entry points built on the dense D and PI matrices under every other quadrature mode: with tiled,
+// global-grid or fast Gauss evaluation set they must give the dense results, and over the memory
+// budget they must return -1 outputs instead of indexing empty matrices.
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "check.h"
+
+extern "C" {
+void ep_set_memory_budget(size_t bytes);
+void ep_set_tiled_evaluation(int enabled, int kernel_threads);
+void ep_set_global_grid_quadrature(int enabled);
+void ep_set_fast_gauss_tolerance(double tolerance);
+void capacity_curve(double M, const char* typeM, const double* snr_values, int count, double N, const char* distribution, double shaping_param, double* mi_out, double* r0_out, double* rcrit_out);
+double* exponents_normal(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+double* rcu_bound(double M, const char* typeM, double SNR, double R, double N, const char* distribution, double shaping_param, const double* n_values, int count, double* pe_out, double* results);
+double* exponents_cost_constrained(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+double* optimize_distribution(double M, const char* typeM, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* q_out, double* results);
+double* e0_constellation_gradient(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double N, double* grad_real, double* grad_imag, double* results);
+double* optimize_constellation(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* real_out, double* imag_out, double* results);
+}
+
+static const double SNR = 4.0, RATE = 0.5, BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+// Every output of the dense-only entry points for an M-point square QAM (as a custom constellation
+// for the ones that take one) with N nodes per dimension
+struct Outputs {
+    double rates[6];                // capacity_curve at two SNRs: I, R0, R_crit
+    double normal[8];               // exponents_normal
+    double rcu_pe[2], rcu[4];       // rcu_bound
+    double cost[4];                 // exponents_cost_constrained
+    std::vector<double> q_opt;      // optimize_distribution
+    double shaped[9];
+    std::vector<double> grad;       // e0_constellation_gradient
+    double e0;
+    std::vector<double> geometry;   // optimize_constellation
+    double moved[8];
+};
+
+static Outputs run_all(int M, int N) {
+    const int side = static_cast<int>(std::lround(std::sqrt(M)));
+    std::vector<double> re, im, q(M, 1.0 / M);
+    double energy = 0;
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            re.push_back(2 * i - side + 1);
+            im.push_back(2 * j - side + 1);
+            energy += (re.back() * re.back() + im.back() * im.back()) / M;
+        }
+    }
+    for (int i = 0; i < M; i++) {
+        re[i] /= std::sqrt(energy);
+        im[i] /= std::sqrt(energy);
+    }
+
+    Outputs out;
+    const double snrs[2] = {1.0, SNR}, blocklengths[2] = {100, 500};
+    capacity_curve(M, "QAM", snrs, 2, N, "uniform", 0.0, out.rates, out.rates + 2, out.rates + 4);
+    exponents_normal(M, "QAM", SNR, RATE, N, BLOCKLENGTH, THRESHOLD, "uniform", 0.0, out.normal);
+    rcu_bound(M, "QAM", SNR, RATE, N, "uniform", 0.0, blocklengths, 2, out.rcu_pe, out.rcu);
+    exponents_cost_constrained(M, "QAM", SNR, RATE, N, BLOCKLENGTH, THRESHOLD, "uniform", 0.0, out.cost);
+    out.q_opt.resize(M);
+    optimize_distribution(M, "QAM", SNR, RATE, 0.5, N, BLOCKLENGTH, THRESHOLD, 3, out.q_opt.data(), out.shaped);
+    out.grad.resize(2 * M);
+    e0_constellation_gradient(re.data(), im.data(), q.data(), M, SNR, 0.5, N, out.grad.data(), out.grad.data() + M, &out.e0);
+    out.geometry.resize(2 * M);
+    optimize_constellation(re.data(), im.data(), q.data(), M, SNR, RATE, 0.5, N, BLOCKLENGTH, THRESHOLD, 3,
+                           out.geometry.data(), out.geometry.data() + M, out.moved);
+    return out;
+}
+
+// Everything but the exponent of exponents_normal, which comes from the mode under test
+static void check_same(const Outputs& got, const Outputs& dense) {
+    const double tol = 1e-9;
+    for (int k = 0; k < 6; k++) CHECK_NEAR(got.rates[k], dense.rates[k], tol);
+    CHECK_NEAR(got.normal[6], dense.normal[6], tol);
+    CHECK(got.normal[1] >= 0);
+    for (int k = 0; k < 2; k++) CHECK_NEAR(got.rcu_pe[k], dense.rcu_pe[k], tol);
+    for (int k = 0; k < 4; k++) CHECK_NEAR(got.rcu[k], dense.rcu[k], tol);
+    for (int k = 0; k < 4; k++) CHECK_NEAR(got.cost[k], dense.cost[k], tol);
+    for (size_t k = 0; k < got.q_opt.size(); k++) CHECK_NEAR(got.q_opt[k], dense.q_opt[k], tol);
+    for (int k = 0; k < 6; k++) CHECK_NEAR(got.shaped[k], dense.shaped[k], tol);
+    for (size_t k = 0; k < got.grad.size(); k++) CHECK_NEAR(got.grad[k], dense.grad[k], tol);
+    CHECK_NEAR(got.e0, dense.e0, tol);
+    for (size_t k = 0; k < got.geometry.size(); k++) CHECK_NEAR(got.geometry[k], dense.geometry[k], tol);
+    for (int k = 0; k < 6; k++) CHECK_NEAR(got.moved[k], dense.moved[k], tol);
+}
+
+static void check_invalid(const Outputs& got) {
+    for (int k = 0; k < 6; k++) CHECK(got.rates[k] == -1.0);
+    CHECK(got.normal[1] >= 0); // the exponent itself runs on the streaming kernel
+    CHECK(got.normal[6] == -1.0 && got.normal[7] == -1.0);
+    CHECK(got.rcu_pe[0] == -1.0 && got.rcu_pe[1] == -1.0);
+    for (int k = 0; k < 4; k++) CHECK(got.rcu[k] == -1.0);
+    for (int k = 0; k < 4; k++) CHECK(got.cost[k] == -1.0);
+    for (int k = 0; k < 9; k++) CHECK(got.shaped[k] == -1.0);
+    CHECK(got.e0 == -1.0);
+    for (int k = 0; k < 8; k++) CHECK(got.moved[k] == -1.0);
+}
+
+int main() {
+    const Outputs dense16 = run_all(16, 6);
+
+    ep_set_tiled_evaluation(1, 1);
+    check_same(run_all(16, 6), dense16);
+    ep_set_tiled_evaluation(0, 1);
+
+    ep_set_global_grid_quadrature(1);
+    check_same(run_all(16, 6), dense16);
+    ep_set_global_grid_quadrature(0);
+
+    ep_set_memory_budget(1);
+    check_invalid(run_all(16, 6));
+    ep_set_memory_budget(0);
+
+    // the fast Gauss transform only applies from 64 points
+    const Outputs dense64 = run_all(64, 3);
+    ep_set_fast_gauss_tolerance(1e-6);
+    check_same(run_all(64, 3), dense64);
+    ep_set_fast_gauss_tolerance(0);
+
+    return check_report("test_dense_modes");
+}
@@ -0,0 +1,118 @@
+// Derivatives of E0 from the E_0_co template (dual numbers) against central differences of E0 itself
+#include <complex>
+#include <string>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+static const double STEP = 1e-5;
+
+// Dense quadrature of an M-point constellation at SNR with N nodes per dimension
+static void setup(int M, const char* type, double snr, int N) {
+    setMod(M, type);
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setN(N);
+    setPI();
+    setW();
+}
+
+static double e0_at(double rho) {
+    double grad_rho, e0;
+    return E_0_co(0, rho, grad_rho, e0);
+}
+
+static void check_rho_derivatives(double rho) {
+    double grad_rho, e0;
+    E_0_co(0, rho, grad_rho, e0);
+    CHECK_NEAR(grad_rho, (e0_at(rho + STEP) - e0_at(rho - STEP)) / (2 * STEP), 1e-7);
+
+    double d1, d2;
+    CHECK_NEAR(E_0_co_derivatives(rho, d1, d2), e0, 1e-12);
+    CHECK_NEAR(d1, grad_rho, 1e-10);
+    double d1_plus, d1_minus, unused;
+    E_0_co_derivatives(rho + STEP, d1_plus, unused);
+    E_0_co_derivatives(rho - STEP, d1_minus, unused);
+    CHECK_NEAR(d2, (d1_plus - d1_minus) / (2 * STEP), 1e-6);
+
+    // the same from columns rebuilt from the points
+    double c1, c2;
+    CHECK_NEAR(E_0_co_curvature(rho, c1, c2), e0, 1e-10);
+    CHECK_NEAR(c1, d1, 1e-8);
+    CHECK_NEAR(c2, d2, 1e-8);
+}
+
+static void check_cost_derivatives(double r, double rho) {
+    double grad_r, grad_rho, unused_r, unused_rho;
+    E_0_cost(r, rho, grad_r, grad_rho);
+    const double fd_r = (E_0_cost(r + STEP, rho, unused_r, unused_rho) - E_0_cost(r - STEP, rho, unused_r, unused_rho)) / (2 * STEP);
+    const double fd_rho = (E_0_cost(r, rho + STEP, unused_r, unused_rho) - E_0_cost(r, rho - STEP, unused_r, unused_rho)) / (2 * STEP);
+    CHECK_NEAR(grad_r, fd_r, 1e-7);
+    CHECK_NEAR(grad_rho, fd_rho, 1e-7);
+    // no tilt: E_0_co
+    double grad_rho_co, e0;
+    E_0_co(0, rho, grad_rho_co, e0);
+    CHECK_NEAR(E_0_cost(0, rho, unused_r, grad_rho), e0, 1e-12);
+    CHECK_NEAR(grad_rho, grad_rho_co, 1e-10);
+}
+
+// Every partial of E_0_co_gradient (more variables than one chunk) against a central difference
+static void check_gradient(double rho) {
+    const vector<complex<double>> x = getX();
+    const vector<double> q = getQ();
+    const int M = static_cast<int>(x.size());
+    const double snr = 2.0;
+    auto e0_of = [&](const vector<complex<double>>& points, const vector<double>& probabilities, double s, double r) {
+        vector<double> re, im;
+        for (const auto& p : points) {
+            re.push_back(p.real());
+            im.push_back(p.imag());
+        }
+        setCustomConstellation(re.data(), im.data(), probabilities.data(), M);
+        setSNR(s);
+        double d1, d2;
+        return E_0_co_curvature(r, d1, d2);
+    };
+
+    e0_of(x, q, snr, rho);
+    double d_rho, d_snr;
+    vector<double> d_Q;
+    vector<complex<double>> d_X;
+    const double e0 = E_0_co_gradient(rho, d_rho, d_snr, d_Q, d_X);
+    CHECK_NEAR(e0, e0_of(x, q, snr, rho), 1e-12);
+    CHECK_NEAR(d_rho, (e0_of(x, q, snr, rho + STEP) - e0_of(x, q, snr, rho - STEP)) / (2 * STEP), 1e-7);
+    CHECK_NEAR(d_snr, (e0_of(x, q, snr + STEP, rho) - e0_of(x, q, snr - STEP, rho)) / (2 * STEP), 1e-7);
+    for (int i = 0; i < M; i++) {
+        vector<double> q_plus = q, q_minus = q;
+        q_plus[i] += STEP;
+        q_minus[i] -= STEP;
+        CHECK_NEAR(d_Q[i], (e0_of(x, q_plus, snr, rho) - e0_of(x, q_minus, snr, rho)) / (2 * STEP), 1e-6);
+        for (int part = 0; part < 2; part++) {
+            const complex<double> step = part == 0 ? complex<double>(STEP, 0) : complex<double>(0, STEP);
+            vector<complex<double>> x_plus = x, x_minus = x;
+            x_plus[i] += step;
+            x_minus[i] -= step;
+            const double fd = (e0_of(x_plus, q, snr, rho) - e0_of(x_minus, q, snr, rho)) / (2 * STEP);
+            CHECK_NEAR(part == 0 ? d_X[i].real() : d_X[i].imag(), fd, 1e-6);
+        }
+    }
+}
+
+int main() {
+    setup(16, "QAM", 10, 12);
+    check_rho_derivatives(0.0);
+    check_rho_derivatives(0.4);
+    check_rho_derivatives(1.0);
+    check_cost_derivatives(0.2, 0.5);
+
+    // high SNR, where the exponents of the inner sums exceed the double range without the shift
+    setup(64, "QAM", 100, 8);
+    check_rho_derivatives(0.3);
+    check_cost_derivatives(0.1, 0.3);
+
+    setup(8, "PSK", 1.0, 6);
+    check_gradient(0.6);
+
+    return check_report("test_derivatives");
+}
@@ -0,0 +1,111 @@
+// Channel dispersion (channel_dispersion) and the normal approximation of Pe: I and V against the
+// information density integrated on a fine lattice, as is -E0''(0) / ln 2 from the differentiated
+// kernel (both to within the error of the quadrature at N = 20), and exponents_normal returning
+// normal_approximation of its own I and V.
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+extern "C" {
+double* exponents_normal(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+}
+
+static const int N = 20;
+static const double BLOCKLENGTH = 500;
+
+static void setup(int M, const char* type, double snr) {
+    setMod(M, type);
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setN(N);
+    setPI();
+    setW();
+}
+
+// Mean and variance (bits, bits^2) of i(x;y) = log2 W(y|x) / sum_i Q_i W(y|x_i), summed on a lattice of
+// spacing h reaching 7 past the outermost points, in long double
+static void fine_lattice(double snr, double h, double& mean, double& variance) {
+    std::vector<std::complex<double>> x = getX();
+    const std::vector<double> q = getQ();
+    const int M = static_cast<int>(x.size());
+    for (auto& p: x) p *= std::sqrt(snr);
+    double lo_re = 0, hi_re = 0, lo_im = 0, hi_im = 0;
+    for (const auto& p: x) {
+        lo_re = std::min(lo_re, p.real());
+        hi_re = std::max(hi_re, p.real());
+        lo_im = std::min(lo_im, p.imag());
+        hi_im = std::max(hi_im, p.imag());
+    }
+    long double m1 = 0, m2 = 0;
+    std::vector<long double> w(M);
+    for (double y_re = lo_re - 7; y_re <= hi_re + 7; y_re += h) {
+        for (double y_im = lo_im - 7; y_im <= hi_im + 7; y_im += h) {
+            long double output = 0;
+            for (int i = 0; i < M; i++) {
+                w[i] = std::exp(-static_cast<long double>(std::norm(std::complex<double>(y_re, y_im) - x[i])));
+                output += q[i] * w[i];
+            }
+            for (int a = 0; a < M; a++) {
+                if (w[a] <= 0) continue;
+                const long double density = std::log(w[a] / output) / std::log(2.0L);
+                const long double weight = q[a] * w[a] * h * h / M_PI;
+                m1 += weight * density;
+                m2 += weight * density * density;
+            }
+        }
+    }
+    mean = static_cast<double>(m1);
+    variance = static_cast<double>(m2 - m1 * m1);
+}
+
+static void check_case(int M, const char* type, double snr) {
+    setup(M, type, snr);
+    double mutual_information;
+    const double dispersion = channel_dispersion(mutual_information);
+    CHECK(dispersion > 0);
+
+    double mean, variance;
+    fine_lattice(snr, 0.05, mean, variance);
+    CHECK_NEAR(mutual_information, mean, 1e-4);
+    CHECK_NEAR(dispersion, variance, 2e-3);
+
+    double d1, d2;
+    E_0_co_derivatives(0, d1, d2);
+    CHECK_NEAR(d1, mutual_information, 1e-10);
+    // the same variance only up to the quadrature: the s = 1/(1+rho) term of E0'' vanishes for the integral
+    CHECK_NEAR(-d2 / std::log(2.0), variance, 2e-3);
+
+    // Pe ~ Q((n(I - R) + log2(n)/2) / sqrt(nV)): 1/2 where the shift is zero, falling with the backoff
+    const double half_rate = mutual_information + 0.5 * std::log2(BLOCKLENGTH) / BLOCKLENGTH;
+    CHECK_NEAR(normal_approximation(mutual_information, dispersion, half_rate, BLOCKLENGTH), 0.5, 1e-12);
+    double previous = 1.0;
+    for (double backoff: {0.0, 0.05, 0.1, 0.2}) {
+        const double pe = normal_approximation(mutual_information, dispersion, mutual_information - backoff, BLOCKLENGTH);
+        CHECK(pe < previous && pe > 0);
+        previous = pe;
+    }
+
+    const double rate = 0.8 * mutual_information;
+    double results[8];
+    exponents_normal(M, type, snr, rate, N, BLOCKLENGTH, 1e-6, "uniform", 0.0, results);
+    CHECK_NEAR(results[3], mutual_information, 1e-9);
+    CHECK_NEAR(results[6], dispersion, 1e-9);
+    CHECK_NEAR(results[7], normal_approximation(results[3], results[6], rate, BLOCKLENGTH), 1e-15);
+}
+
+int main() {
+    check_case(2, "PAM", 1.0);
+    check_case(4, "QAM", 3.0);
+    check_case(16, "QAM", 10.0);
+    check_case(8, "PSK", 10.0);
+
+    // without dispersion the approximation is a step at I + log2(n)/(2n)
+    CHECK(normal_approximation(1.0, 0.0, 0.9, BLOCKLENGTH) == 0.0);
+    CHECK(normal_approximation(1.0, 0.0, 1.1, BLOCKLENGTH) == 1.0);
+
+    return check_report("test_dispersion");
+}
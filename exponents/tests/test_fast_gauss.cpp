@@ -0,0 +1,120 @@
+// The fast Gauss transform against direct summation (G and the distance-weighted sum stay within the
+// tolerance), and E_0_co in EP_EVAL_FAST_GAUSS mode against the dense quadrature: E0 and its rho
+// derivative within the tolerance, and the derivative against central differences of E0; tolerances
+// of 1 or more turn the transform off.
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+#include "exponents.h"
+#include "fast_gauss.h"
+
+static const double RHOS[3] = {0.0, 0.4, 1.0};
+
+// deterministic points in [-1, 1)
+static double uniform(unsigned& state) {
+    state = state * 1664525u + 1013904223u;
+    return 2.0 * (state >> 8) / 16777216.0 - 1.0;
+}
+
+static void check_transform(double h, double tolerance) {
+    unsigned state = 12345;
+    std::vector<std::complex<double>> sources(300);
+    std::vector<double> weights(sources.size());
+    for (size_t i = 0; i < sources.size(); i++) {
+        sources[i] = {3 * uniform(state), 3 * uniform(state)};
+        weights[i] = (1.5 + uniform(state)) / sources.size();
+    }
+    const FastGaussTransform transform(sources, weights, h, tolerance);
+    CHECK(transform.clusters() > 1 && transform.clusters() < static_cast<int>(sources.size()));
+    for (int t = 0; t < 50; t++) {
+        const std::complex<double> y(3.5 * uniform(state), 3.5 * uniform(state));
+        double G = 0, D = 0;
+        for (size_t i = 0; i < sources.size(); i++) {
+            const double d2 = std::norm(y - sources[i]);
+            const double e = weights[i] * std::exp(-d2 / (h * h));
+            G += e;
+            D += d2 * e;
+        }
+        double fast_G;
+        const double fast_D = transform.distance(y, fast_G);
+        // weights sum to at most 2.5 / 1.5 times one; |y - x|^2 e^(-|y - x|^2 / h^2) <= h^2 / e
+        CHECK_NEAR(transform(y), G, 2 * tolerance);
+        CHECK_NEAR(fast_G, transform(y), 1e-14);
+        CHECK_NEAR(fast_D, D, 2 * tolerance * h * h);
+    }
+}
+
+struct Values {
+    double e0[3], d[3];
+    int mode;
+};
+
+static Values evaluate(int N) {
+    setN(N);
+    setPI();
+    setW();
+    Values v;
+    for (int k = 0; k < 3; k++) E_0_co(0, RHOS[k], v.d[k], v.e0[k]);
+    v.mode = getEvaluationMode();
+    return v;
+}
+
+static void check_case(double snr, int N) {
+    setMod(64, "QAM");
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+    const Values dense = evaluate(N);
+    CHECK(dense.mode == EP_EVAL_DENSE);
+
+    setFastGaussTolerance(1e-10);
+    const Values fast = evaluate(N);
+    CHECK(fast.mode == EP_EVAL_FAST_GAUSS);
+    for (int k = 0; k < 3; k++) {
+        CHECK_NEAR(fast.e0[k], dense.e0[k], 1e-8);
+        CHECK_NEAR(fast.d[k], dense.d[k], 1e-7);
+    }
+    const double step = 1e-4;
+    double d, up, down;
+    E_0_co(0, 0.5 + step, d, up);
+    E_0_co(0, 0.5 - step, d, down);
+    double e0;
+    E_0_co(0, 0.5, d, e0);
+    CHECK_NEAR(d, (up - down) / (2 * step), 1e-6);
+
+    // a coarse tolerance moves the result, so the transform is the one being evaluated
+    setFastGaussTolerance(1e-3);
+    const Values coarse = evaluate(N);
+    CHECK(std::fabs(coarse.d[2] - dense.d[2]) > 1e-6);
+    setFastGaussTolerance(0);
+}
+
+int main() {
+    check_transform(0.5, 1e-6);
+    check_transform(1.0, 1e-10);
+    check_case(30.0, 6);
+    check_case(100.0, 4);
+
+    // tolerances of 1 and more bound nothing: exact evaluation, whichever way they are set
+    const Values dense = evaluate(4);
+    for (double tolerance: {1.0, 2.0}) {
+        setFastGaussTolerance(tolerance);
+        const Values off = evaluate(4);
+        CHECK(off.mode == EP_EVAL_DENSE && off.e0[1] == dense.e0[1] && off.d[1] == dense.d[1]);
+        setFastGaussTolerance(-1.0);
+        ep_set_fast_gauss_tolerance(tolerance);
+        CHECK(evaluate(4).mode == EP_EVAL_DENSE);
+        ep_set_fast_gauss_tolerance(0.0);
+
+        const EPParams p = {64, EP_MOD_QAM, EP_DIST_UNIFORM, 4, 0.0, 100.0, 2.0, 100, 1e-6};
+        EPBatchOptions options = {};
+        options.threads = 1;
+        options.fast_gauss_tolerance = tolerance;
+        EPResult result;
+        exponents_batch(&p, 1, &result, &options);
+        CHECK(result.status == EP_STATUS_OK && result.evaluation_mode == EP_EVAL_DENSE);
+    }
+    return check_report("test_fast_gauss");
+}
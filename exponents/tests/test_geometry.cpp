@@ -0,0 +1,136 @@
+// Constellation geometry optimization: the analytic point gradient of E0 (e0_constellation_gradient)
+// against central differences, and optimize_constellation improving E0(rho) - rho R and E(R) from a
+// distorted 16-QAM while keeping the constellation centered at its average power.
+#include <cmath>
+#include <vector>
+#include "check.h"
+
+extern "C" {
+double* exponents_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double N, double n, double threshold, double* results);
+double* e0_constellation_gradient(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double N, double* grad_real, double* grad_imag, double* results);
+double* optimize_constellation(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double R, double rho, double N, double n, double threshold, int max_iterations, double* real_out, double* imag_out, double* results);
+}
+
+static const double SNR = 4.0, RATE = 1.0, RHO = 0.5, N = 8, BLOCKLENGTH = 100, THRESHOLD = 1e-6, STEP = 1e-5;
+static const int ITERATIONS = 20;
+
+struct Constellation {
+    std::vector<double> re, im, q;
+    int size() const { return static_cast<int>(q.size()); }
+};
+
+// Square QAM with every point moved by up to distortion (deterministically), centered and scaled
+// to unit average power under q
+static Constellation distorted_qam(int M, double distortion, bool shaped) {
+    const int side = static_cast<int>(std::lround(std::sqrt(M)));
+    Constellation c;
+    for (int i = 0; i < side; i++) {
+        for (int j = 0; j < side; j++) {
+            const int k = i * side + j;
+            c.re.push_back(2 * i - side + 1 + distortion * std::sin(1.7 * k + 0.3));
+            c.im.push_back(2 * j - side + 1 + distortion * std::cos(2.3 * k + 1.1));
+            c.q.push_back(shaped ? std::exp(-0.1 * (c.re.back() * c.re.back() + c.im.back() * c.im.back())) : 1.0);
+        }
+    }
+    double q_sum = 0;
+    for (double p: c.q) q_sum += p;
+    double mean_re = 0, mean_im = 0;
+    for (int i = 0; i < M; i++) {
+        c.q[i] /= q_sum;
+        mean_re += c.q[i] * c.re[i];
+        mean_im += c.q[i] * c.im[i];
+    }
+    double power = 0;
+    for (int i = 0; i < M; i++) {
+        c.re[i] -= mean_re;
+        c.im[i] -= mean_im;
+        power += c.q[i] * (c.re[i] * c.re[i] + c.im[i] * c.im[i]);
+    }
+    for (int i = 0; i < M; i++) {
+        c.re[i] /= std::sqrt(power);
+        c.im[i] /= std::sqrt(power);
+    }
+    return c;
+}
+
+static double e0(const Constellation& c, double rho, double nodes = N) {
+    std::vector<double> grad(2 * c.size());
+    double result;
+    e0_constellation_gradient(c.re.data(), c.im.data(), c.q.data(), c.size(), SNR, rho, nodes, grad.data(), grad.data() + c.size(), &result);
+    return result;
+}
+
+// Central differences of E0 with the given nodes per dimension, at every stride-th point
+static void check_gradient(const Constellation& c, double rho, double nodes, double tol, int stride = 1) {
+    const int M = c.size();
+    std::vector<double> grad(2 * M);
+    double result;
+    e0_constellation_gradient(c.re.data(), c.im.data(), c.q.data(), M, SNR, rho, nodes, grad.data(), grad.data() + M, &result);
+    for (int i = 0; i < M; i += stride) {
+        for (int part = 0; part < 2; part++) {
+            Constellation plus = c, minus = c;
+            (part == 0 ? plus.re : plus.im)[i] += STEP;
+            (part == 0 ? minus.re : minus.im)[i] -= STEP;
+            CHECK_NEAR(grad[part * M + i], (e0(plus, rho, nodes) - e0(minus, rho, nodes)) / (2 * STEP), tol);
+        }
+    }
+}
+
+// The optimized constellation is centered with the starting average power, and moving it improved
+// the objective: E0(rho) - rho R at rho_fixed > 0, E(R) otherwise
+static void check_optimized(const Constellation& start, double rho_fixed) {
+    const int M = start.size();
+    Constellation moved = start;
+    double results[8];
+    optimize_constellation(start.re.data(), start.im.data(), start.q.data(), M, SNR, RATE, rho_fixed, N, BLOCKLENGTH,
+                           THRESHOLD, ITERATIONS, moved.re.data(), moved.im.data(), results);
+    CHECK(results[6] > 0);
+
+    double mean_re = 0, mean_im = 0, power = 0;
+    for (int i = 0; i < M; i++) {
+        mean_re += moved.q[i] * moved.re[i];
+        mean_im += moved.q[i] * moved.im[i];
+        power += moved.q[i] * (moved.re[i] * moved.re[i] + moved.im[i] * moved.im[i]);
+    }
+    CHECK_NEAR(mean_re, 0.0, 1e-12);
+    CHECK_NEAR(mean_im, 0.0, 1e-12);
+    CHECK_NEAR(power, 1.0, 1e-12);
+
+    if (rho_fixed > 0) {
+        CHECK_NEAR(results[1], e0(moved, rho_fixed) - rho_fixed * RATE, 1e-12);
+        CHECK(results[1] > e0(start, rho_fixed) - rho_fixed * RATE + 1e-3);
+    } else {
+        double before[6], after[6];
+        exponents_custom(start.re.data(), start.im.data(), start.q.data(), M, SNR, RATE, N, BLOCKLENGTH, THRESHOLD, before);
+        exponents_custom(moved.re.data(), moved.im.data(), moved.q.data(), M, SNR, RATE, N, BLOCKLENGTH, THRESHOLD, after);
+        CHECK_NEAR(results[1], after[1], 1e-6);
+        CHECK(results[1] > before[1] + 1e-3);
+    }
+}
+
+int main() {
+    const Constellation distorted = distorted_qam(16, 0.6, false);
+    // the gradient is that of the integral, so it matches the quadrature's own derivative to within
+    // the quadrature error: 1e-4 at N = 8, 1e-7 at N = 20
+    check_gradient(distorted, RHO, N, 1e-4);
+    check_gradient(distorted, RHO, 20, 1e-7, 5);
+    check_gradient(distorted_qam(16, 0.6, true), 1.0, 20, 1e-7, 5);
+    check_optimized(distorted, RHO);
+    check_optimized(distorted, 0.0);
+    check_optimized(distorted_qam(16, 0.6, true), RHO);
+
+    // 4-QAM is a stationary point: no tangential gradient, so it is returned as it was
+    const Constellation square = distorted_qam(4, 0.0, false);
+    Constellation moved = square;
+    double results[8];
+    optimize_constellation(square.re.data(), square.im.data(), square.q.data(), 4, SNR, RATE, RHO, N, BLOCKLENGTH,
+                           THRESHOLD, ITERATIONS, moved.re.data(), moved.im.data(), results);
+    CHECK(results[6] == 0);
+    CHECK(results[7] < 1e-9);
+    for (int i = 0; i < 4; i++) {
+        CHECK_NEAR(moved.re[i], square.re[i], 1e-12);
+        CHECK_NEAR(moved.im[i], square.im[i], 1e-12);
+    }
+
+    return check_report("test_geometry");
+}
@@ -0,0 +1,102 @@
+// Accuracy of the global grid (E_0_co_global_grid) over constellations and SNRs: E0 and its rho
+// derivative (the mutual information at rho = 0) against the same integral summed on a much finer
+// lattice, and up to 16 points against the dense Gauss-Hermite quadrature at N = 40 within that
+// quadrature's own error, which at these SNRs is up to 2e-5 bits (4-QAM at SNR 10)
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+static const double TOLERANCE = 2e-7;       // bits
+static const double DENSE_TOLERANCE = 5e-5; // bits
+static const double RHOS[2] = {0.0, 0.5};
+
+struct Values {
+    double e0[2], d[2];
+};
+
+static Values evaluate(int N, int grid) {
+    setGlobalGridQuadrature(grid);
+    setN(N);
+    setPI();
+    setW();
+    Values v;
+    for (int k = 0; k < 2; k++) E_0_co(0, RHOS[k], v.d[k], v.e0[k]);
+    setGlobalGridQuadrature(-1);
+    return v;
+}
+
+// -log2(1/pi sum h^2 F^(1+rho)) and its rho derivative on a lattice of spacing h reaching 7 past the
+// outermost points, in long double
+static Values fine_lattice(double snr, double h) {
+    std::vector<std::complex<double>> x = getX();
+    const int M = static_cast<int>(x.size());
+    for (auto &p: x) p *= std::sqrt(snr);
+    double lo_re = 0, hi_re = 0, lo_im = 0, hi_im = 0;
+    for (const auto &p: x) {
+        lo_re = std::min(lo_re, p.real());
+        hi_re = std::max(hi_re, p.real());
+        lo_im = std::min(lo_im, p.imag());
+        hi_im = std::max(hi_im, p.imag());
+    }
+    Values v;
+    for (int k = 0; k < 2; k++) {
+        const double s = 1.0 / (1.0 + RHOS[k]);
+        long double m = 0, mp = 0;
+        for (double y_re = lo_re - 7; y_re <= hi_re + 7; y_re += h) {
+            for (double y_im = lo_im - 7; y_im <= hi_im + 7; y_im += h) {
+                long double F = 0, FD = 0;
+                for (const auto &p: x) {
+                    const double D = std::norm(std::complex<double>(y_re, y_im) - p);
+                    const long double e = std::exp(static_cast<long double>(-s * D)) / M;
+                    F += e;
+                    FD += e * D;
+                }
+                if (F <= 0) continue;
+                const long double t = std::pow(F, static_cast<long double>(1 + RHOS[k])) * h * h;
+                m += t;
+                mp += t * (std::log(F) + s * FD / F);
+            }
+        }
+        v.e0[k] = -std::log(static_cast<double>(m) / M_PI) / std::log(2.0);
+        v.d[k] = -static_cast<double>(mp / m) / std::log(2.0);
+    }
+    return v;
+}
+
+static void check_case(int M, const char *type, double snr) {
+    setMod(M, type);
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+
+    // the lattice does not depend on N
+    const Values grid = evaluate(6, 1);
+    const Values grid_n = evaluate(20, 1);
+    const Values fine = fine_lattice(snr, 0.15);
+    for (int k = 0; k < 2; k++) {
+        CHECK(grid.e0[k] == grid_n.e0[k] && grid.d[k] == grid_n.d[k]);
+        CHECK_NEAR(grid.e0[k], fine.e0[k], TOLERANCE);
+        CHECK_NEAR(grid.d[k], fine.d[k], TOLERANCE);
+    }
+    if (M > 16) return; // dense quadrature at N = 40 takes seconds per point here
+    const Values dense = evaluate(40, 0);
+    for (int k = 0; k < 2; k++) {
+        CHECK_NEAR(grid.e0[k], dense.e0[k], DENSE_TOLERANCE);
+        CHECK_NEAR(grid.d[k], dense.d[k], DENSE_TOLERANCE);
+    }
+}
+
+int main() {
+    for (double snr: {1.0, 10.0, 100.0}) {
+        check_case(4, "QAM", snr);
+        check_case(8, "PSK", snr);
+        check_case(16, "QAM", snr);
+    }
+    // where a lattice spaced from N was off by up to 3e-3 bits of MI (N = 10)
+    check_case(64, "QAM", 30.0);
+    check_case(64, "QAM", 100.0);
+    return check_report("test_global_grid");
+}
@@ -0,0 +1,83 @@
+// Arimoto-type optimization of Q (optimize_input_distribution): improves on the uniform Q at
+// constant average power, ends near its KKT conditions and keeps the symmetries of the constellation.
+// Both it and the shaping optimizer rescale D on every trial (rescaleW), which must give the D that
+// setW builds for the final X.
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+static const double RATE = 1.0, RHO = 0.5;
+
+static void setup(int M, const char* type, double snr) {
+    setMod(M, type);
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setR(RATE);
+    setN(8);
+    setPI();
+    setW();
+}
+
+// E0 at a few rho from the current D_mat, and again after setW rebuilt it
+static void check_distances() {
+    for (double rho: {0.0, 0.5, 1.0}) {
+        double d, e0, d_fresh, e0_fresh;
+        E_0_co(0, rho, d, e0);
+        setW();
+        E_0_co(0, rho, d_fresh, e0_fresh);
+        CHECK_NEAR(e0, e0_fresh, 1e-12);
+        CHECK_NEAR(d, d_fresh, 1e-12);
+    }
+}
+
+static void check_optimized(int M, const char* type, double snr, double rho_fixed) {
+    setup(M, type, snr);
+    double grad_rho, e0, rho = rho_fixed, r, rho_interpolated;
+    const double uniform = rho_fixed > 0 ? E_0_co(0, RHO, grad_rho, e0) - RHO * RATE
+                                         : GD_co(r, rho, rho_interpolated, 20, 8, false, 1e-9);
+
+    int iterations;
+    double kkt_gap, scale;
+    rho = rho_fixed;
+    const double optimized = optimize_input_distribution(rho_fixed, rho, 100, 1e-6, iterations, kkt_gap, scale);
+    CHECK(optimized >= uniform);
+    CHECK(kkt_gap < (rho_fixed > 0 ? 1e-3 : 1e-2)); // rho moves with Q in rate mode
+
+    const vector<complex<double>> x = getX();
+    const vector<double> q = getQ();
+    double q_sum = 0, power = 0;
+    for (int i = 0; i < M; i++) {
+        q_sum += q[i];
+        power += q[i] * std::norm(x[i]);
+        // points of equal energy are exchanged by a symmetry of the constellation
+        for (int j = 0; j < i; j++) {
+            if (std::abs(std::norm(x[i]) - std::norm(x[j])) < 1e-12) CHECK_NEAR(q[i], q[j], 1e-6);
+        }
+    }
+    CHECK_NEAR(q_sum, 1.0, 1e-12);
+    CHECK_NEAR(power, 1.0, 1e-12);
+    check_distances();
+}
+
+int main() {
+    check_optimized(16, "QAM", 3.0, RHO);
+    check_optimized(16, "QAM", 3.0, 0.0);
+    check_optimized(8, "PAM", 10.0, RHO);
+
+    // the shaping optimizer's last evaluation is not at its optimum, so D was rescaled across betas
+    setMod(16, "QAM");
+    setSNR(3.0);
+    setR(RATE);
+    setN(8);
+    setPI();
+    double beta;
+    int evaluations;
+    optimize_shaping_parameter("mutual-information", 0.0, 2.0, 0.5, 1e-6, 50, beta, evaluations);
+    CHECK(evaluations > 2);
+    check_distances();
+
+    return check_report("test_input_distribution");
+}
@@ -0,0 +1,71 @@
+// Low-SNR series (E_0_co_low_snr) against the quadrature wherever useLowSNRSeries selects it, and the
+// batch reporting the points it ran on
+#include <cstddef>
+#include <vector>
+#include "functions.h"
+#include "exponents.h"
+#include "check.h"
+
+extern "C" double* exponents(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+
+static const double TOLERANCE = 1e-9; // the default low_snr_tolerance, bits
+
+static void setup(int M, const char* type, const char* distribution, double beta, double snr) {
+    setMod(M, type);
+    setQ(distribution, beta);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setN(20);
+    setPI();
+    setW();
+}
+
+static void check_series(int M, const char* type, const char* distribution, double beta, double snr) {
+    setup(M, type, distribution, beta, snr);
+    double dense_e0[3], dense_d[3], e0, d;
+    const double rhos[3] = {0.0, 0.5, 1.0};
+    for (int k = 0; k < 3; k++) E_0_co(0, rhos[k], dense_d[k], dense_e0[k]);
+
+    CHECK(useLowSNRSeries());
+    CHECK(getEvaluationMode() == EP_EVAL_LOW_SNR_SERIES);
+    for (int k = 0; k < 3; k++) {
+        E_0_co(0, rhos[k], d, e0);
+        CHECK_NEAR(e0, dense_e0[k], TOLERANCE);
+        CHECK_NEAR(d, dense_d[k], TOLERANCE);
+    }
+}
+
+int main() {
+    for (double snr: {1e-5, 1e-4}) {
+        check_series(2, "PAM", "uniform", 0.0, snr);
+        check_series(8, "PSK", "uniform", 0.0, snr);
+        check_series(16, "QAM", "uniform", 0.0, snr);
+        check_series(16, "QAM", "maxwell-boltzmann", 0.5, snr);
+    }
+
+    // the quadrature at ordinary SNRs
+    setup(16, "QAM", "uniform", 0.0, 1.0);
+    CHECK(!useLowSNRSeries());
+    CHECK(getEvaluationMode() == EP_EVAL_DENSE);
+
+    // batch points below and above the threshold, with the same results as exponents()
+    std::vector<EPParams> params = {
+        {16, EP_MOD_QAM, EP_DIST_UNIFORM, 20, 0.0, 1e-4, 1e-5, 100, 1e-6},
+        {16, EP_MOD_QAM, EP_DIST_UNIFORM, 20, 0.0, 1.0, 0.2, 100, 1e-6},
+    };
+    std::vector<EPResult> results(params.size());
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(params.data(), params.size(), results.data(), &options);
+    CHECK(results[0].evaluation_mode == EP_EVAL_LOW_SNR_SERIES);
+    CHECK(results[1].evaluation_mode == EP_EVAL_DENSE);
+    for (size_t k = 0; k < params.size(); k++) {
+        CHECK(results[k].status == EP_STATUS_OK);
+        double single[6];
+        exponents(16, "QAM", params[k].SNR, params[k].R, 20, 100, 1e-6, "uniform", 0.0, single);
+        CHECK_NEAR(results[k].E0, single[1], 1e-12);
+        CHECK_NEAR(results[k].mutual_information, single[3], 1e-12);
+    }
+
+    return check_report("test_low_snr");
+}
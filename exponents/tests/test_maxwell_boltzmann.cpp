@@ -0,0 +1,58 @@
+// Maxwell-Boltzmann normalization (normalizeX_for_Q): Q_i proportional to exp(-beta |x_i|^2) with
+// unit average power for every beta, and a repeated setup served from the per-beta cache
+#include <cmath>
+#include <complex>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+static void setup(int M, const char* type, double beta) {
+    setMod(M, type);
+    setQ("maxwell-boltzmann", beta);
+    normalizeX_for_Q();
+}
+
+static void check_normalized(int M, const char* type, double beta) {
+    setup(M, type, beta);
+    const vector<complex<double>> x = getX();
+    const vector<double> q = getQ();
+    int inner = 0;
+    for (int i = 0; i < M; i++) {
+        if (std::norm(x[i]) < std::norm(x[inner])) inner = i;
+    }
+    double q_sum = 0, power = 0;
+    for (int i = 0; i < M; i++) {
+        q_sum += q[i];
+        power += q[i] * std::norm(x[i]);
+        const double log_ratio = -beta * (std::norm(x[i]) - std::norm(x[inner]));
+        if (log_ratio < -700) {
+            CHECK(q[i] >= 0 && q[i] < 1e-300); // underflows
+        } else {
+            CHECK_NEAR(std::log(q[i] / q[inner]), log_ratio, 1e-9);
+        }
+    }
+    CHECK_NEAR(q_sum, 1.0, 1e-12);
+    CHECK_NEAR(power, 1.0, 1e-12);
+
+    // the same constellation again, from the cache
+    setup(M, type, beta);
+    CHECK(getX() == x);
+    CHECK(getQ() == q);
+}
+
+int main() {
+    for (double beta: {0.0, 0.1, 1.0, 5.0, 20.0}) {
+        check_normalized(8, "PAM", beta);
+        check_normalized(16, "QAM", beta);
+        check_normalized(64, "QAM", beta);
+    }
+    // far into the shaped regime the outer points carry almost no probability
+    check_normalized(256, "QAM", 100.0);
+
+    // constant energy: uniform whatever beta
+    setup(8, "PSK", 3.0);
+    for (double q: getQ()) CHECK_NEAR(q, 1.0 / 8, 1e-15);
+    for (const auto& p: getX()) CHECK_NEAR(std::abs(p), 1.0, 1e-12);
+
+    return check_report("test_maxwell_boltzmann");
+}
@@ -0,0 +1,84 @@
+// Monte Carlo E0 and E0' (e0_monte_carlo): the same numbers for a seed whatever the thread count,
+// within a few confidence half-widths of the dense quadrature, half-widths shrinking as 1/sqrt(samples),
+// exact at rho = 0 (E0 = 0), and -1 outputs without samples.
+#include <cmath>
+#include <vector>
+#include "functions.h"
+#include "check.h"
+
+extern "C" {
+double* e0_monte_carlo(double M, const char* typeM, double SNR, double rho, const char* distribution, double shaping_param, double samples, double seed, int threads, double* results);
+double* e0_monte_carlo_custom(const double* real_parts, const double* imag_parts, const double* probabilities, int num_points, double SNR, double rho, double samples, double seed, int threads, double* results);
+}
+
+static const double SAMPLES = 1 << 15;
+
+// E0 and E0' from the dense quadrature at N = 20
+static void dense(int M, const char* type, double snr, double rho, const char* distribution, double beta, double& e0, double& d) {
+    setMod(M, type);
+    setQ(distribution, beta);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setN(20);
+    setPI();
+    setW();
+    E_0_co(0, rho, d, e0);
+}
+
+static void check_case(int M, const char* type, double snr, double rho, const char* distribution, double beta) {
+    double e0, d;
+    dense(M, type, snr, rho, distribution, beta, e0, d);
+
+    double one[4], two[4], four[4];
+    e0_monte_carlo(M, type, snr, rho, distribution, beta, SAMPLES, 7, 1, one);
+    e0_monte_carlo(M, type, snr, rho, distribution, beta, SAMPLES, 7, 2, two);
+    e0_monte_carlo(M, type, snr, rho, distribution, beta, SAMPLES, 7, 4, four);
+    for (int k = 0; k < 4; k++) CHECK(one[k] == two[k] && one[k] == four[k]);
+
+    CHECK(one[2] > 0 && one[3] > 0);
+    CHECK(std::abs(one[0] - e0) < 3 * one[2]);
+    CHECK(std::abs(one[1] - d) < 3 * one[3]);
+
+    double other[4], more[4];
+    e0_monte_carlo(M, type, snr, rho, distribution, beta, SAMPLES, 8, 1, other);
+    CHECK(other[0] != one[0]);
+    e0_monte_carlo(M, type, snr, rho, distribution, beta, 4 * SAMPLES, 7, 1, more);
+    CHECK_NEAR(more[2] / one[2], 0.5, 0.05);
+    CHECK_NEAR(more[3] / one[3], 0.5, 0.15); // the sample variance of E0' terms is itself noisy at high SNR
+    CHECK(std::abs(more[0] - e0) < 3 * more[2]);
+}
+
+int main() {
+    check_case(16, "QAM", 3.0, 0.5, "uniform", 0.0);
+    check_case(16, "QAM", 10.0, 1.0, "maxwell-boltzmann", 0.3);
+    check_case(8, "PSK", 1.0, 0.2, "uniform", 0.0);
+
+    // f^0 = 1 for every sample
+    double results[4];
+    e0_monte_carlo(16, "QAM", 3.0, 0.0, "uniform", 0.0, SAMPLES, 7, 1, results);
+    CHECK_NEAR(results[0], 0.0, 1e-12);
+    CHECK_NEAR(results[2], 0.0, 1e-12);
+
+    // a custom constellation as it is given: an off-centre 3-point one against the quadrature
+    const double re[3] = {1.0, -0.5, 0.2}, im[3] = {0.0, 0.8, -1.1}, q[3] = {0.5, 0.3, 0.2};
+    setCustomConstellation(re, im, q, 3);
+    setSNR(4.0);
+    setN(20);
+    setPI();
+    setW();
+    double e0, d;
+    E_0_co(0, 0.7, d, e0);
+    e0_monte_carlo_custom(re, im, q, 3, 4.0, 0.7, SAMPLES, 11, 0, results);
+    CHECK(std::abs(results[0] - e0) < 3 * results[2]);
+    CHECK(std::abs(results[1] - d) < 3 * results[3]);
+
+    // no samples: invalid, not NaN or a throw through the C boundary
+    for (double samples: {0.0, -5.0, 0.5}) {
+        e0_monte_carlo(16, "QAM", 3.0, 0.5, "uniform", 0.0, samples, 7, 1, results);
+        for (double r: results) CHECK(r == -1.0);
+        e0_monte_carlo_custom(re, im, q, 3, 4.0, 0.7, samples, 11, 0, results);
+        for (double r: results) CHECK(r == -1.0);
+    }
+
+    return check_report("test_monte_carlo");
+}
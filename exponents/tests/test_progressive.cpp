@@ -0,0 +1,132 @@
+// Progressive evaluation: the levels arrive in order with N growing as configured up to params N, only
+// the last one final, each with the change in E0 from the level below; the last level agrees with a
+// batch solve at params N; a tolerance stops early, and a cancellation ends on the level it interrupts.
+#include <cmath>
+#include <vector>
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+struct Levels {
+    std::vector<EPProgressiveResult> levels;
+    EPCancelToken* cancel_after_first = nullptr;
+};
+
+static void on_level(const EPProgressiveResult* level, void* user_data) {
+    Levels& l = *static_cast<Levels*>(user_data);
+    l.levels.push_back(*level);
+    if (l.cancel_after_first) ep_cancel_token_cancel(l.cancel_after_first);
+}
+
+static EPProgressiveOptions options_for(Levels& levels, int initial_N, double growth, double tolerance) {
+    EPProgressiveOptions options = {initial_N, growth, tolerance, on_level, &levels};
+    return options;
+}
+
+// levels numbered from 0 and final only at the end; the result is the last one
+static void check_sequence(const Levels& l, const EPProgressiveResult& result, const std::vector<int>& Ns) {
+    CHECK(l.levels.size() == Ns.size());
+    if (l.levels.size() != Ns.size()) return;
+    for (size_t k = 0; k < Ns.size(); k++) {
+        CHECK(l.levels[k].N == Ns[k] && l.levels[k].level == static_cast<int>(k));
+        CHECK(l.levels[k].final == (k + 1 == Ns.size()));
+    }
+    const EPProgressiveResult& last = l.levels.back();
+    CHECK(result.N == last.N && result.level == last.level && result.final);
+    CHECK(result.result.E0 == last.result.E0 && result.error_estimate == last.error_estimate);
+}
+
+static EPResult batch(const EPParams& p) {
+    EPResult result;
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(&p, 1, &result, &options);
+    return result;
+}
+
+int main() {
+    const EPParams p = {16, EP_MOD_QAM, EP_DIST_UNIFORM, 20, 0.0, 10.0, 1.5, BLOCKLENGTH, THRESHOLD};
+    const EPResult reference = batch(p);
+    CHECK(reference.status == EP_STATUS_OK);
+
+    // defaults: 5, 10, 20; every level has a coarser one to compare with (the pilot for the first)
+    Levels l;
+    EPProgressiveOptions options = options_for(l, 0, 0, 0);
+    EPProgressiveResult result;
+    CHECK(exponents_progressive(&p, &options, nullptr, &result) == EP_STATUS_OK);
+    check_sequence(l, result, {5, 10, 20});
+    for (const auto& level: l.levels) CHECK(level.result.status == EP_STATUS_OK && level.error_estimate >= 0);
+    for (size_t k = 1; k < l.levels.size(); k++) {
+        CHECK_NEAR(l.levels[k].error_estimate, std::fabs(l.levels[k].result.E0 - l.levels[k - 1].result.E0), 1e-15);
+    }
+    CHECK_NEAR(result.result.E0, reference.E0, 1e-9);
+    CHECK_NEAR(result.result.rho, reference.rho, 1e-5);
+    CHECK(result.result.mutual_information == reference.mutual_information);
+
+    // a slower growth, rounded, ending exactly at params N; no pilot below 1 node
+    l = Levels();
+    options = options_for(l, 2, 1.5, 0);
+    EPParams p12 = p;
+    p12.N = 12;
+    CHECK(exponents_progressive(&p12, &options, nullptr, &result) == EP_STATUS_OK);
+    check_sequence(l, result, {2, 4, 6, 9, 12});
+    CHECK(l.levels[0].error_estimate == -1.0 && l.levels[1].error_estimate >= 0);
+
+    // the initial N capped at params N: one level
+    l = Levels();
+    options = options_for(l, 50, 0, 0);
+    CHECK(exponents_progressive(&p12, &options, nullptr, &result) == EP_STATUS_OK);
+    check_sequence(l, result, {12});
+
+    // a tolerance stops at the first level whose change is within it
+    l = Levels();
+    options = options_for(l, 3, 0, 1e-2);
+    CHECK(exponents_progressive(&p, &options, nullptr, &result) == EP_STATUS_OK);
+    CHECK(result.N < p.N && result.error_estimate >= 0 && result.error_estimate <= 1e-2);
+    for (size_t k = 0; k + 1 < l.levels.size(); k++) CHECK(l.levels[k].error_estimate > 1e-2);
+
+    // cancelled while reporting the first level: the next one is the last
+    EPCancelToken* token = ep_cancel_token_create();
+    l = Levels();
+    l.cancel_after_first = token;
+    options = options_for(l, 0, 0, 0);
+    EPBatchOptions call = {};
+    call.cancel = token;
+    exponents_progressive(&p, &options, &call, &result);
+    CHECK(l.levels.size() <= 2 && result.final);
+    CHECK(l.levels[0].result.status == EP_STATUS_OK && !l.levels[0].final);
+    CHECK(result.result.status == EP_STATUS_STOPPED || result.result.status == EP_STATUS_CANCELLED);
+
+    // already cancelled: a single cancelled level
+    l = Levels();
+    CHECK(exponents_progressive(&p, &options, &call, &result) == EP_STATUS_CANCELLED);
+    CHECK(l.levels.size() == 1 && l.levels[0].final && l.levels[0].result.status == EP_STATUS_CANCELLED);
+    CHECK(result.error_estimate == -1.0 && result.result.E0 == -1.0);
+    ep_cancel_token_destroy(token);
+
+    // custom constellations end where the custom batch does
+    const double re[3] = {1.0, -0.5, -0.5}, im[3] = {0.0, 0.8, -0.8}, q[3] = {0.4, 0.3, 0.3};
+    const EPCustomParams custom = {re, im, q, 3, 10, 3.0, 0.4, BLOCKLENGTH, THRESHOLD};
+    EPResult custom_reference;
+    EPBatchOptions one = {};
+    one.threads = 1;
+    exponents_custom_batch(&custom, 1, &custom_reference, &one);
+    l = Levels();
+    options = options_for(l, 0, 0, 0);
+    CHECK(exponents_custom_progressive(&custom, &options, nullptr, &result) == EP_STATUS_OK);
+    check_sequence(l, result, {5, 10});
+    CHECK_NEAR(result.result.E0, custom_reference.E0, 1e-9);
+
+    // invalid points and NULL options
+    EPParams invalid = p;
+    invalid.N = 0;
+    l = Levels();
+    options = options_for(l, 0, 0, 0);
+    CHECK(exponents_progressive(&invalid, &options, nullptr, &result) == EP_STATUS_INVALID_PARAMS);
+    CHECK(l.levels.empty() && result.final && result.result.E0 == -1.0);
+    CHECK(exponents_progressive(nullptr, nullptr, nullptr, &result) == EP_STATUS_INVALID_PARAMS);
+    CHECK(exponents_progressive(&p12, nullptr, nullptr, &result) == EP_STATUS_OK && result.N == 12 && result.final);
+
+    return check_report("test_progressive");
+}
@@ -0,0 +1,101 @@
+// Saddlepoint approximation of the RCU bound (rcu_saddlepoint_point, rcu_saddlepoint): rho_hat
+// maximizes E0(rho) - rho R, the closed form matches E[exp(-rho U) min(1, exp(U))] integrated
+// numerically below R_crit, between R_crit and I and above I, and Pe stays under 2^(-n E(R)).
+#include <algorithm>
+#include <cmath>
+#include "functions.h"
+#include "check.h"
+
+extern "C" {
+double* rcu_bound(double M, const char* typeM, double SNR, double R, double N, const char* distribution, double shaping_param, const double* n_values, int count, double* pe_out, double* results);
+}
+
+static const int N = 8;
+
+static void setup(int M, const char* type, double snr) {
+    setMod(M, type);
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(snr);
+    setN(N);
+    setPI();
+    setW();
+}
+
+// exp(-n(E0 - rho R)) E[exp(-rho U) min(1, exp(U))] for U ~ N(n(R - E0') ln 2, -n E0'' ln 2), by the
+// midpoint rule in the log domain on cells aligned with the kink at U = 0
+static double integrated(double n, double R, double rho, double e0, double d1, double d2) {
+    const double ln2 = std::log(2.0);
+    const double mu = n * (R - d1) * ln2, variance = -n * d2 * ln2, sigma = std::sqrt(variance);
+    const double h = sigma / 4000;
+    const double lo = std::floor((mu - variance - 20 * sigma) / h) * h, hi = mu + variance + 20 * sigma;
+    const long cells = std::lround((hi - lo) / h);
+    auto log_integrand = [&](long k) {
+        const double u = lo + (k + 0.5) * h;
+        return -rho * u + std::min(0.0, u) - (u - mu) * (u - mu) / (2 * variance);
+    };
+    double top = -INFINITY;
+    for (long k = 0; k < cells; k++) top = std::max(top, log_integrand(k));
+    long double sum = 0;
+    for (long k = 0; k < cells; k++) sum += std::exp(static_cast<long double>(log_integrand(k) - top));
+    const double log_expectation = top + std::log(static_cast<double>(sum) * h / (sigma * std::sqrt(2 * M_PI)));
+    return std::min(1.0, std::exp(-n * (e0 - rho * R) * ln2 + log_expectation));
+}
+
+static void check_rate(double R, double rho_expected) {
+    double rho, d1, d2;
+    const double e0 = rcu_saddlepoint_point(R, rho, d1, d2);
+    if (rho_expected >= 0) {
+        CHECK(rho == rho_expected);
+    } else {
+        CHECK(rho > 0 && rho < 1);
+        CHECK_NEAR(d1, R, 1e-10);
+    }
+    // E0 - rho R is concave in rho: its maximum on a grid is not above the one found
+    for (int k = 0; k <= 20; k++) {
+        double grad_rho, e_k;
+        E_0_co(0, k / 20.0, grad_rho, e_k);
+        CHECK(e_k - k / 20.0 * R <= e0 - rho * R + 1e-12);
+    }
+
+    double previous = 1.0;
+    for (double n: {50.0, 200.0, 1000.0}) {
+        const double pe = rcu_saddlepoint(n, R, rho, e0, d1, d2);
+        const double reference = integrated(n, R, rho, e0, d1, d2);
+        CHECK(std::abs(pe - reference) <= 1e-6 * reference);
+        CHECK(pe <= std::pow(2.0, -n * (e0 - rho * R)) * (1 + 1e-12));
+        if (R < d1 || rho > 0) {
+            CHECK(pe < previous);
+            previous = pe;
+        }
+    }
+}
+
+int main() {
+    setup(16, "QAM", 3.0);
+    double mutual_information, critical_rate, d2;
+    E_0_co_derivatives(0, mutual_information, d2);
+    E_0_co_derivatives(1, critical_rate, d2);
+    check_rate(0.5 * critical_rate, 1.0);
+    check_rate(0.5 * (critical_rate + mutual_information), -1.0);
+    check_rate(0.95 * mutual_information, -1.0);
+    check_rate(1.05 * mutual_information, 0.0);
+
+    // above I the error probability goes to 1 with n
+    double rho, d1;
+    const double e0 = rcu_saddlepoint_point(1.05 * mutual_information, rho, d1, d2);
+    CHECK(rcu_saddlepoint(1e5, 1.05 * mutual_information, rho, e0, d1, d2) > 0.99);
+    // without variance U is deterministic
+    CHECK_NEAR(rcu_saddlepoint(100, 1.0, 0.5, 1.2, 1.1, 0.0), std::pow(2.0, -100 * (1.2 - 0.5)) * std::pow(2.0, 0.5 * 100 * (1.0 - 1.1)), 1e-30);
+
+    // the C entry point: the same point for every blocklength
+    const double blocklengths[3] = {50, 200, 1000}, rate = 0.5 * (critical_rate + mutual_information);
+    double pe[3], results[4];
+    rcu_bound(16, "QAM", 3.0, rate, N, "uniform", 0.0, blocklengths, 3, pe, results);
+    const double e0_rate = rcu_saddlepoint_point(rate, rho, d1, d2);
+    CHECK_NEAR(results[0], rho, 1e-12);
+    CHECK_NEAR(results[1], e0_rate - rho * rate, 1e-12);
+    for (int k = 0; k < 3; k++) CHECK_NEAR(pe[k], rcu_saddlepoint(blocklengths[k], rate, rho, e0_rate, d1, d2), 1e-15 * pe[k] + 1e-300);
+
+    return check_report("test_rcu");
+}
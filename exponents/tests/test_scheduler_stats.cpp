@@ -0,0 +1,77 @@
+// Batch statistics of the work-stealing scheduler: every valid point is counted once over the workers,
+// a worker sets a constellation up only when its chunk changes setup (one setup for a single-setup batch
+// on one thread, with nothing stolen), busy time stays within the wall time, and per_thread is filled
+// only up to its capacity.
+#include <vector>
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+static EPBatchStats run(const std::vector<EPParams>& params, int threads, EPThreadStats* per_thread, int capacity) {
+    std::vector<EPResult> results(params.size());
+    EPBatchStats stats = {};
+    stats.per_thread = per_thread;
+    stats.per_thread_capacity = capacity;
+    EPBatchOptions options = {};
+    options.threads = threads;
+    options.stats = &stats;
+    exponents_batch(params.data(), params.size(), results.data(), &options);
+    return stats;
+}
+
+static EPThreadStats total(const EPThreadStats* per_thread, int threads) {
+    EPThreadStats sum = {};
+    for (int t = 0; t < threads; t++) {
+        sum.points += per_thread[t].points;
+        sum.chunks += per_thread[t].chunks;
+        sum.stolen += per_thread[t].stolen;
+        sum.setups += per_thread[t].setups;
+    }
+    return sum;
+}
+
+int main() {
+    // one setup: 16-QAM at N = 6 over SNR
+    std::vector<EPParams> single;
+    for (int k = 0; k < 8; k++) single.push_back({16, EP_MOD_QAM, EP_DIST_UNIFORM, 6, 0.0, 1.0 + k, 0.5, BLOCKLENGTH, THRESHOLD});
+    EPThreadStats per_thread[4];
+    EPBatchStats stats = run(single, 1, per_thread, 4);
+    CHECK(stats.threads == 1);
+    CHECK(stats.wall_ms > 0);
+    CHECK(per_thread[0].points == single.size());
+    CHECK(per_thread[0].chunks >= 1 && per_thread[0].setups == 1 && per_thread[0].stolen == 0);
+    CHECK(per_thread[0].busy_ms <= stats.wall_ms && per_thread[0].utilisation <= 1.0 && per_thread[0].utilisation > 0.5);
+
+    // three setups, one of them invalid points only
+    std::vector<EPParams> mixed = single;
+    for (int k = 0; k < 6; k++) mixed.push_back({8, EP_MOD_PSK, EP_DIST_UNIFORM, 8, 0.0, 2.0 + k, 0.4, BLOCKLENGTH, THRESHOLD});
+    for (int k = 0; k < 3; k++) mixed.push_back({4, EP_MOD_PAM, EP_DIST_UNIFORM, 0, 0.0, 1.0, 0.1, BLOCKLENGTH, THRESHOLD});
+    for (int threads: {1, 2, 3}) {
+        stats = run(mixed, threads, per_thread, 4);
+        CHECK(stats.threads == threads);
+        const EPThreadStats sum = total(per_thread, threads);
+        CHECK(sum.points == mixed.size() - 3);
+        CHECK(sum.setups >= 2 && sum.setups <= sum.chunks);
+        CHECK(sum.stolen <= sum.chunks);
+        for (int t = 0; t < threads; t++) {
+            CHECK(per_thread[t].busy_ms <= stats.wall_ms);
+            CHECK(per_thread[t].utilisation >= 0 && per_thread[t].utilisation <= 1.0);
+        }
+        if (threads == 1) CHECK(sum.setups == 2 && sum.stolen == 0);
+    }
+
+    // a capacity below the workers leaves the rest of the array alone; no array at all is fine
+    EPThreadStats small[3];
+    small[1].points = 12345;
+    stats = run(mixed, 3, small, 1);
+    CHECK(stats.threads == 3 && small[1].points == 12345);
+    stats = run(mixed, 2, nullptr, 0);
+    CHECK(stats.threads == 2 && stats.wall_ms > 0);
+
+    // nothing valid: no workers
+    stats = run(std::vector<EPParams>(mixed.end() - 3, mixed.end()), 2, per_thread, 4);
+    CHECK(stats.threads == 0 && stats.wall_ms == 0);
+
+    return check_report("test_scheduler_stats");
+}
@@ -0,0 +1,145 @@
+// Edit sessions against rebuilding from scratch: after moving, adding and removing points and changing
+// probabilities, a solve on the session (patched D, warm start) gives what exponents_custom_batch gives
+// for the same constellation, in dense and tiled mode and across changes of SNR and N; invalid edits
+// are rejected without changing the session.
+#include <vector>
+#include "check.h"
+#include "exponents.h"
+
+static const double BLOCKLENGTH = 100, THRESHOLD = 1e-6;
+
+struct Constellation {
+    std::vector<double> re, im, q;
+};
+
+static EPResult solve(EPSession* session, double snr, double R, int N, const EPBatchOptions* options = nullptr) {
+    EPResult result;
+    const int status = ep_session_solve(session, snr, R, N, BLOCKLENGTH, THRESHOLD, options, &result);
+    CHECK(status == result.status);
+    return result;
+}
+
+static EPResult rebuild(const Constellation& c, double snr, double R, int N, const EPBatchOptions* options = nullptr) {
+    double total = 0;
+    for (double w: c.q) total += w;
+    std::vector<double> q;
+    for (double w: c.q) q.push_back(w / total);
+    const EPCustomParams params = {c.re.data(), c.im.data(), q.data(), static_cast<int>(q.size()), N, snr, R, BLOCKLENGTH, THRESHOLD};
+    EPBatchOptions one = options ? *options : EPBatchOptions();
+    one.threads = 1;
+    EPResult result;
+    exponents_custom_batch(&params, 1, &result, &one);
+    return result;
+}
+
+static void check_same(const EPResult& session, const EPResult& scratch) {
+    CHECK(session.status == EP_STATUS_OK && scratch.status == EP_STATUS_OK);
+    CHECK(session.evaluation_mode == scratch.evaluation_mode);
+    CHECK_NEAR(session.E0, scratch.E0, 1e-9);
+    CHECK_NEAR(session.rho, scratch.rho, 1e-5);
+    CHECK_NEAR(session.mutual_information, scratch.mutual_information, 1e-12);
+    CHECK_NEAR(session.cutoff_rate, scratch.cutoff_rate, 1e-12);
+}
+
+int main() {
+    Constellation c;
+    c.re = {1.0, 0.3, -0.6, -1.1, -0.2, 0.7, 0.1, -0.5};
+    c.im = {0.1, 0.9, 0.7, -0.1, -0.9, -0.6, 0.2, -0.3};
+    c.q = {1, 1, 2, 1, 1, 2, 1, 1};
+    EPSession* session = ep_session_create(c.re.data(), c.im.data(), c.q.data(), 8);
+    CHECK(session && ep_session_size(session) == 8);
+
+    const double snr = 4.0, R = 0.8;
+    const int N = 8;
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+    // the same constellation again, from the kept D and PI
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    CHECK(ep_session_move_point(session, 2, -0.8, 0.5) == EP_STATUS_OK);
+    c.re[2] = -0.8;
+    c.im[2] = 0.5;
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    CHECK(ep_session_set_probability(session, 4, 3.0) == EP_STATUS_OK);
+    c.q[4] = 3.0;
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    CHECK(ep_session_add_point(session, 0.0, -0.4, 0.5) == EP_STATUS_OK);
+    c.re.push_back(0.0);
+    c.im.push_back(-0.4);
+    c.q.push_back(0.5);
+    CHECK(ep_session_size(session) == 9);
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    CHECK(ep_session_remove_point(session, 0) == EP_STATUS_OK);
+    c.re.erase(c.re.begin());
+    c.im.erase(c.im.begin());
+    c.q.erase(c.q.begin());
+    CHECK(ep_session_size(session) == 8);
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    // several edits between two solves
+    CHECK(ep_session_move_point(session, 7, 0.4, -0.2) == EP_STATUS_OK);
+    CHECK(ep_session_remove_point(session, 3) == EP_STATUS_OK);
+    CHECK(ep_session_add_point(session, -1.0, -0.8, 1.0) == EP_STATUS_OK);
+    c.re[7] = 0.4;
+    c.im[7] = -0.2;
+    c.re.erase(c.re.begin() + 3);
+    c.im.erase(c.im.begin() + 3);
+    c.q.erase(c.q.begin() + 3);
+    c.re.push_back(-1.0);
+    c.im.push_back(-0.8);
+    c.q.push_back(1.0);
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    // another SNR and N rebuild D; edits after that patch the new one
+    check_same(solve(session, 12.0, 1.2, 6), rebuild(c, 12.0, 1.2, 6));
+    CHECK(ep_session_move_point(session, 0, 0.2, 1.0) == EP_STATUS_OK);
+    c.re[0] = 0.2;
+    c.im[0] = 1.0;
+    check_same(solve(session, 12.0, 1.2, 6), rebuild(c, 12.0, 1.2, 6));
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    // tiled: no D kept, edits still apply
+    EPBatchOptions tiled = {};
+    tiled.tiled = 1;
+    CHECK(ep_session_move_point(session, 1, -0.3, 0.6) == EP_STATUS_OK);
+    c.re[1] = -0.3;
+    c.im[1] = 0.6;
+    const EPResult t = solve(session, snr, R, N, &tiled);
+    CHECK(t.evaluation_mode == EP_EVAL_TILED);
+    check_same(t, rebuild(c, snr, R, N, &tiled));
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    // invalid edits leave the session as it was
+    const int size = ep_session_size(session);
+    CHECK(ep_session_move_point(session, size, 0.0, 0.0) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_move_point(session, -1, 0.0, 0.0) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_set_probability(session, 0, -1.0) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_set_probability(session, size, 1.0) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_add_point(session, 0.0, 0.0, -0.5) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_remove_point(session, size) == EP_STATUS_INVALID_PARAMS);
+    CHECK(ep_session_size(session) == size);
+    check_same(solve(session, snr, R, N), rebuild(c, snr, R, N));
+
+    // invalid solves
+    EPResult result;
+    CHECK(ep_session_solve(session, snr, R, 0, BLOCKLENGTH, THRESHOLD, nullptr, &result) == EP_STATUS_INVALID_PARAMS);
+    CHECK(result.E0 == -1.0 && result.Pe == -1.0);
+    CHECK(ep_session_solve(nullptr, snr, R, N, BLOCKLENGTH, THRESHOLD, nullptr, &result) == EP_STATUS_INVALID_PARAMS);
+    for (int i = 0; i < size; i++) CHECK(ep_session_set_probability(session, i, 0.0) == EP_STATUS_OK);
+    CHECK(ep_session_solve(session, snr, R, N, BLOCKLENGTH, THRESHOLD, nullptr, &result) == EP_STATUS_INVALID_PARAMS);
+    ep_session_destroy(session);
+
+    // a single point cannot be removed; NULL arrays or no points create nothing
+    const double one = 1.0, zero = 0.0;
+    session = ep_session_create(&one, &zero, &one, 1);
+    CHECK(session && ep_session_remove_point(session, 0) == EP_STATUS_INVALID_PARAMS && ep_session_size(session) == 1);
+    ep_session_destroy(session);
+    CHECK(ep_session_create(nullptr, &zero, &one, 1) == nullptr);
+    CHECK(ep_session_create(&one, &zero, &one, 0) == nullptr);
+    CHECK(ep_session_size(nullptr) == 0);
+    ep_session_destroy(nullptr);
+
+    return check_report("test_session");
+}
@@ -0,0 +1,81 @@
+// Maxwell-Boltzmann shaping optimization (optimize_shaping): the beta it returns is at least as good
+// as a grid of betas over the same interval and its neighbours, for both objectives, and its outputs are
+// those of exponents() with the Maxwell-Boltzmann distribution at that beta.
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "check.h"
+
+extern "C" {
+double* exponents(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* distribution, double shaping_param, double* results);
+double* optimize_shaping(double M, const char* typeM, double SNR, double R, double N, double n, double threshold, const char* objective, double beta_lo, double beta_hi, double beta_start, double* q_out, double* results);
+}
+
+static const double N = 8, BLOCKLENGTH = 100, THRESHOLD = 1e-6, BETA_HI = 2.0;
+static const int GRID = 11;
+
+// {exponent, I(X;Y)} of the Maxwell-Boltzmann distribution at beta
+static void at_beta(int M, const char* type, double snr, double rate, double beta, double& exponent, double& mi) {
+    double results[6];
+    exponents(M, type, snr, rate, N, BLOCKLENGTH, THRESHOLD, "maxwell-boltzmann", beta, results);
+    exponent = results[1];
+    mi = results[3];
+}
+
+// gain: whether shaping beats the uniform Q here, otherwise the optimum is at beta = 0
+static void check_case(int M, const char* type, double snr, double rate, const char* objective, bool gain) {
+    const bool mutual_information = std::string(objective) == "mutual-information";
+    double q[256], results[8];
+    optimize_shaping(M, type, snr, rate, N, BLOCKLENGTH, THRESHOLD, objective, 0.0, BETA_HI, 0.5, q, results);
+    const double beta = results[6];
+    CHECK(beta >= 0.0 && beta <= BETA_HI);
+    CHECK(results[7] > 2 && results[7] <= 50);
+
+    double best = -INFINITY, uniform = 0, exponent, mi;
+    for (int k = 0; k < GRID; k++) {
+        at_beta(M, type, snr, rate, BETA_HI * k / (GRID - 1), exponent, mi);
+        const double value = mutual_information ? mi : exponent;
+        best = std::max(best, value);
+        if (k == 0) uniform = value;
+    }
+    const double found = mutual_information ? results[3] : results[1];
+    CHECK(found >= best - 1e-6);
+    // and a maximum between the grid points
+    for (double step: {-0.01, 0.01}) {
+        if (beta + step < 0 || beta + step > BETA_HI) continue;
+        at_beta(M, type, snr, rate, beta + step, exponent, mi);
+        CHECK(found >= (mutual_information ? mi : exponent) - 1e-9);
+    }
+    if (gain) {
+        CHECK(found > uniform);
+    } else {
+        CHECK(beta < 1e-3);
+        CHECK_NEAR(found, uniform, 1e-9);
+    }
+
+    // the same point through exponents()
+    double check[6];
+    exponents(M, type, snr, rate, N, BLOCKLENGTH, THRESHOLD, "maxwell-boltzmann", beta, check);
+    for (int k = 0; k < 6; k++) CHECK_NEAR(results[k], check[k], 1e-9);
+    double q_sum = 0;
+    for (int i = 0; i < M; i++) q_sum += q[i];
+    CHECK_NEAR(q_sum, 1.0, 1e-12);
+}
+
+int main() {
+    check_case(16, "QAM", 3.0, 1.0, "mutual-information", true);
+    check_case(16, "QAM", 3.0, 1.7, "exponent", true);
+    check_case(16, "QAM", 10.0, 3.0, "mutual-information", true);
+    check_case(8, "PAM", 10.0, 1.0, "exponent", true);
+    // far below capacity the exponent is best without shaping
+    check_case(16, "QAM", 3.0, 1.0, "exponent", false);
+
+    // no gain for a constant-energy constellation: every beta gives the uniform Q
+    double q[8], results[8], exponent, mi;
+    optimize_shaping(8, "PSK", 3.0, 1.0, N, BLOCKLENGTH, THRESHOLD, "mutual-information", 0.0, BETA_HI, 0.5, q, results);
+    at_beta(8, "PSK", 3.0, 1.0, 0.0, exponent, mi);
+    CHECK_NEAR(results[3], mi, 1e-9);
+    for (int i = 0; i < 8; i++) CHECK_NEAR(q[i], 1.0 / 8, 1e-12);
+
+    return check_report("test_shaping");
+}
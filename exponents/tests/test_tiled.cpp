@@ -0,0 +1,101 @@
+// The tiled kernel (E_0_co_tiled), requested or as the streaming fallback over the memory budget,
+// against the dense D/PI quadrature: E0 and its rho derivative over constellations, shaping and SNRs up
+// to where the inner sums leave the double range; splitting the tiles over kernel threads changes
+// nothing but the summation order; a batch gives the dense solver results in either mode.
+#include <vector>
+#include "functions.h"
+#include "check.h"
+#include "exponents.h"
+
+static const double TOLERANCE = 1e-10;
+static const double RHOS[3] = {0.0, 0.4, 1.0};
+
+struct Values {
+    double e0[3], d[3];
+    int mode;
+};
+
+static Values evaluate(int N) {
+    setN(N);
+    setPI();
+    setW();
+    Values v;
+    for (int k = 0; k < 3; k++) E_0_co(0, RHOS[k], v.d[k], v.e0[k]);
+    v.mode = getEvaluationMode();
+    return v;
+}
+
+static void check_close(const Values& got, const Values& dense) {
+    for (int k = 0; k < 3; k++) {
+        CHECK_NEAR(got.e0[k], dense.e0[k], TOLERANCE);
+        CHECK_NEAR(got.d[k], dense.d[k], TOLERANCE);
+    }
+}
+
+static void check_case(int M, const char* type, const char* distribution, double beta, double snr, int N) {
+    setMod(M, type);
+    setQ(distribution, beta);
+    normalizeX_for_Q();
+    setSNR(snr);
+
+    const Values dense = evaluate(N);
+    CHECK(dense.mode == EP_EVAL_DENSE);
+
+    setTiledEvaluation(1, 1);
+    const Values tiled = evaluate(N);
+    CHECK(tiled.mode == EP_EVAL_TILED);
+    check_close(tiled, dense);
+    setTiledEvaluation(-1, 0);
+
+    setMemoryBudget(quadraturePeakBytes(M, N) - 1);
+    const Values streaming = evaluate(N);
+    CHECK(streaming.mode == EP_EVAL_STREAMING);
+    check_close(streaming, dense);
+    setMemoryBudget(0);
+}
+
+int main() {
+    for (double snr: {0.5, 10.0, 1000.0}) {
+        check_case(4, "PAM", "uniform", 0.0, snr, 10);
+        check_case(8, "PSK", "uniform", 0.0, snr, 8);
+        check_case(16, "QAM", "uniform", 0.0, snr, 8);
+        check_case(16, "QAM", "maxwell-boltzmann", 0.5, snr, 6);
+    }
+
+    // enough cells for the tiles to be split over kernel threads
+    setMod(64, "QAM");
+    setQ("uniform", 0.0);
+    normalizeX_for_Q();
+    setSNR(30.0);
+    setTiledEvaluation(1, 1);
+    const Values one = evaluate(16);
+    setTiledEvaluation(1, 3);
+    const Values three = evaluate(16);
+    setTiledEvaluation(-1, 0);
+    for (int k = 0; k < 3; k++) {
+        CHECK_NEAR(three.e0[k], one.e0[k], 1e-12);
+        CHECK_NEAR(three.d[k], one.d[k], 1e-12);
+    }
+
+    // whole solves
+    std::vector<EPParams> params;
+    for (int k = 0; k < 4; k++) params.push_back({16, EP_MOD_QAM, EP_DIST_UNIFORM, 8, 0.0, 2.0 + 5 * k, 0.5 + 0.5 * k, 100, 1e-6});
+    std::vector<EPResult> dense(params.size()), tiled(params.size()), streaming(params.size());
+    EPBatchOptions options = {};
+    options.threads = 1;
+    exponents_batch(params.data(), params.size(), dense.data(), &options);
+    options.tiled = 1;
+    exponents_batch(params.data(), params.size(), tiled.data(), &options);
+    options.tiled = 0;
+    options.memory_budget = 1;
+    exponents_batch(params.data(), params.size(), streaming.data(), &options);
+    for (size_t k = 0; k < params.size(); k++) {
+        CHECK(tiled[k].evaluation_mode == EP_EVAL_TILED && streaming[k].evaluation_mode == EP_EVAL_STREAMING);
+        CHECK_NEAR(tiled[k].E0, dense[k].E0, 1e-8);
+        CHECK_NEAR(tiled[k].rho, dense[k].rho, 1e-6);
+        CHECK_NEAR(streaming[k].E0, dense[k].E0, 1e-8);
+        CHECK_NEAR(tiled[k].mutual_information, dense[k].mutual_information, TOLERANCE);
+    }
+
+    return check_report("test_tiled");
+}
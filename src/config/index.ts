@@ -28,9 +28,14 @@ const configSchema = z.object({
 
   // Computation
   MAX_COMPUTATION_TIME: z.coerce.number().default(30000), // 30 seconds
+  MAX_COMPUTATION_MEMORY_MB: z.coerce.number().default(1024), // Predicted peak per point (native addon)
+  NATIVE_TILED_EVALUATION: z.enum(['true', 'false']).default('false').transform(v => v === 'true'), // Cache-tiled E0 kernel instead of the dense matrices (parsed like the workers do)
+  NATIVE_KERNEL_THREADS: z.coerce.number().min(1).default(1), // Threads per E0 evaluation of a single native computation
+  ADAPTIVE_SAMPLING_TOLERANCE: z.coerce.number().positive().default(0.005), // Interpolation error of adaptive plots, relative to the plotted range
   MAX_CONCURRENT_COMPUTATIONS: z.coerce.number().default(10),
   ENABLE_COMPUTATION_CACHE: z.coerce.boolean().default(true),
   CACHE_TTL: z.coerce.number().default(3600), // 1 hour
+  USE_NATIVE_ADDON: z.enum(['true', 'false']).default('false').transform(v => v === 'true'), // In-process Node-API addon instead of worker processes
 
   // University settings
   UNIVERSITY_NAME: z.string().default('UPF'),
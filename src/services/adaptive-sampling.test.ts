@@ -0,0 +1,244 @@
+/**
+ * Unit tests for adaptive-sampling.ts
+ * Run with: npm test
+ */
+import { describe, it, expect } from 'vitest';
+import {
+  sampleInterval,
+  sampleGrid,
+  adaptiveOptions,
+  contourMatrix,
+  unsolvedResult,
+  type AdaptiveSolver
+} from './adaptive-sampling.js';
+import type { ComputationResult } from './computation.js';
+
+// ============================================================================
+// A channel with E0(rho) = C rho / (1 + rho): rho* = sqrt(C / R) - 1 between the critical rate C/4
+// (rho* = 1, a straight line below it) and capacity C (rho* = 0, zero exponent above it)
+// ============================================================================
+const BLOCKLENGTH = 100;
+const TOLERANCE = 1e-3;
+
+function point(R: number, C = 1): ComputationResult {
+  const rho = R <= C / 4 ? 1 : R >= C ? 0 : Math.sqrt(C / R) - 1;
+  const E = rho * C / (1 + rho) - rho * R;
+  return {
+    error_probability: Math.pow(2, -BLOCKLENGTH * E),
+    error_exponent: E,
+    optimal_rho: rho,
+    mutual_information: C,
+    cutoff_rate: C / 2,
+    critical_rate: C / 4,
+    computation_time_ms: 0,
+    cached: false
+  };
+}
+
+// Records every batch; cancels the given batch after its first keep points, and fails the points
+// for which fails() holds, as computeBatchByIndex reports them
+function solver<P>(at: (p: P) => ComputationResult, stop?: { batch: number; keep: number }, fails?: (p: P) => boolean) {
+  const batches: P[][] = [];
+  const solve: AdaptiveSolver<P> = async points => {
+    batches.push(points);
+    const cancelled = stop !== undefined && batches.length === stop.batch;
+    const results = points.map((p, i) =>
+      (cancelled && i >= stop!.keep) || fails?.(p) ? unsolvedResult() : at(p));
+    return { results, cancelled };
+  };
+  return { solve, batches, solves: () => batches.reduce((n, b) => n + b.length, 0) };
+}
+
+function linspaced(points: number): number[] {
+  return Array.from({ length: points }, (_, i) => 2 * i / (points - 1));
+}
+
+// Largest error of the piecewise linear interpolant of (x, y) against f on [lo, hi]
+function maxError(x: number[], y: number[], f: (x: number) => number, lo: number, hi: number): number {
+  let worst = 0;
+  for (let k = 0; k <= 2000; k++) {
+    const t = lo + (hi - lo) * k / 2000;
+    let i = 1;
+    while (i < x.length - 1 && x[i] < t) i++;
+    const linear = y[i - 1] + (y[i] - y[i - 1]) * (t - x[i - 1]) / (x[i] - x[i - 1]);
+    worst = Math.max(worst, Math.abs(linear - f(t)));
+  }
+  return worst;
+}
+
+// ============================================================================
+// sampleInterval tests
+// ============================================================================
+describe('sampleInterval', () => {
+  const options = adaptiveOptions('error_exponent', 'R', TOLERANCE);
+
+  it('never solves more points than the budget', async () => {
+    for (const budget of [1, 5, 9, 10, 25, 60]) {
+      const s = solver(point);
+      const samples = await sampleInterval(0, 2, budget, s.solve, options);
+      expect(s.solves()).toBeLessThanOrEqual(budget);
+      expect(samples.x.length).toBe(s.solves());
+      expect(samples.results.length).toBe(samples.x.length);
+      expect(samples.cancelled).toBe(false);
+    }
+  });
+
+  it('returns sorted samples covering the range', async () => {
+    const s = solver(point);
+    const samples = await sampleInterval(0, 2, 30, s.solve, options);
+    expect(samples.x[0]).toBe(0);
+    expect(samples.x[samples.x.length - 1]).toBe(2);
+    for (let i = 1; i < samples.x.length; i++) expect(samples.x[i]).toBeGreaterThan(samples.x[i - 1]);
+    samples.x.forEach((x, i) => expect(samples.results[i].error_exponent).toBe(point(x).error_exponent));
+  });
+
+  it('refines between the critical rate and capacity, not on the straight line below', async () => {
+    const s = solver(point);
+    const samples = await sampleInterval(0, 2, 40, s.solve, options);
+    const inside = (a: number, b: number) => samples.x.filter(x => x > a && x < b).length;
+    expect(inside(0.25, 1)).toBeGreaterThan(inside(0, 0.25));
+    expect(inside(0, 0.25)).toBeLessThanOrEqual(2); // the seed points only
+  });
+
+  it('is more accurate than uniform sampling with the same number of solves', async () => {
+    const s = solver(point);
+    const samples = await sampleInterval(0, 2, 40, s.solve, options);
+    const n = samples.x.length;
+    const uniform = Array.from({ length: n }, (_, i) => 2 * i / (n - 1));
+    const exact = (R: number) => point(R).error_exponent;
+    const adaptive = maxError(samples.x, samples.results.map(r => r.error_exponent), exact, 0, 2);
+    expect(adaptive).toBeLessThan(maxError(uniform, uniform.map(exact), exact, 0, 2));
+  });
+
+  it('uses divided differences when the slope is unknown', async () => {
+    expect(adaptiveOptions('error_exponent', 'SNR', TOLERANCE).slope).toBeUndefined();
+    expect(adaptiveOptions('error_probability', 'R', TOLERANCE).slope).toBeUndefined();
+    const s = solver(point);
+    const samples = await sampleInterval(0, 2, 40, s.solve, adaptiveOptions('optimal_rho', 'R', TOLERANCE));
+    expect(s.solves()).toBeLessThanOrEqual(40);
+    expect(samples.x.filter(x => x > 0.25 && x < 1).length).toBeGreaterThan(4);
+  });
+
+  it('stops at a cancelled batch and keeps what was solved', async () => {
+    const s = solver(point, { batch: 2, keep: 3 });
+    const samples = await sampleInterval(0, 2, 40, s.solve, options);
+    expect(samples.cancelled).toBe(true);
+    expect(s.batches.length).toBe(2);
+    expect(samples.x.length).toBe(9 + 3);
+    expect(samples.x).toEqual([...new Set([...linspaced(9), ...s.batches[1].slice(0, 3)])].sort((a, b) => a - b));
+    samples.x.forEach((x, i) => expect(samples.results[i].error_exponent).toBe(point(x).error_exponent));
+  });
+
+  it('refines around a failed point and keeps every later result at its own x', async () => {
+    // the seed point at R = 1 fails; so would anything solved at it again
+    const s = solver(point, undefined, R => R === 1);
+    const samples = await sampleInterval(0, 2, 40, s.solve, options);
+    expect(samples.cancelled).toBe(false);
+    expect(samples.x).not.toContain(1);
+    samples.x.forEach((x, i) => expect(samples.results[i].error_exponent).toBe(point(x).error_exponent));
+    // both intervals next to it split down to the finest spacing
+    const finest = 2 / (39 * 4);
+    const below = Math.max(...samples.x.filter(x => x < 1)), above = Math.min(...samples.x.filter(x => x > 1));
+    expect(1 - below).toBeLessThan(2 * finest);
+    expect(above - 1).toBeLessThan(2 * finest);
+    expect(s.batches.length).toBeGreaterThan(1);
+  });
+});
+
+// ============================================================================
+// sampleGrid tests
+// ============================================================================
+describe('sampleGrid', () => {
+  // rows: R in [0, 2], cols: capacity in [0.5, 2]
+  const ROWS = 33, COLS = 17;
+  const rate = (i: number) => 2 * i / (ROWS - 1);
+  const capacity = (j: number) => 0.5 + 1.5 * j / (COLS - 1);
+  const at = ([i, j]: [number, number]) => point(rate(i), capacity(j));
+
+  it('solves each node at most once and fills every node', async () => {
+    const s = solver(at);
+    const samples = await sampleGrid(ROWS, COLS, s.solve, adaptiveOptions('error_exponent', undefined, TOLERANCE));
+    const keys = s.batches.flat().map(([i, j]) => i * COLS + j);
+    expect(new Set(keys).size).toBe(keys.length);
+    expect(samples.solved).toBe(keys.length);
+    expect(samples.solved).toBeLessThan(ROWS * COLS);
+    expect(samples.cancelled).toBe(false);
+    for (const row of samples.values) for (const v of row) expect(Number.isFinite(v)).toBe(true);
+  });
+
+  it('keeps the interpolated nodes within the tolerance of the exact exponent', async () => {
+    const s = solver(at);
+    const samples = await sampleGrid(ROWS, COLS, s.solve, adaptiveOptions('error_exponent', undefined, TOLERANCE));
+    const z = contourMatrix(samples, 'error_exponent');
+    let range = 0, worst = 0;
+    for (let i = 0; i < ROWS; i++) {
+      for (let j = 0; j < COLS; j++) {
+        const exact = at([i, j]).error_exponent;
+        range = Math.max(range, exact);
+        worst = Math.max(worst, Math.abs(z[i][j] - exact));
+      }
+    }
+    expect(worst).toBeLessThan(2 * TOLERANCE * range);
+  });
+
+  it('fills every node from the seed when a later round is cancelled', async () => {
+    const s = solver(at, { batch: 2, keep: 0 });
+    const samples = await sampleGrid(ROWS, COLS, s.solve, adaptiveOptions('error_exponent', undefined, TOLERANCE));
+    expect(samples.cancelled).toBe(true);
+    expect(samples.solved).toBe(s.batches[0].length);
+    for (const row of samples.values) for (const v of row) expect(Number.isFinite(v)).toBe(true);
+  });
+
+  it('refines around a failed node and keeps every later result at its own node', async () => {
+    const failed = (i: number, j: number) => i === 16 && j === 8;
+    const s = solver(at, undefined, ([i, j]) => failed(i, j));
+    const samples = await sampleGrid(ROWS, COLS, s.solve, adaptiveOptions('error_exponent', undefined, TOLERANCE));
+    expect(samples.cancelled).toBe(false);
+    expect(samples.results[16][8]).toBeNull();
+    let solved = 0;
+    for (let i = 0; i < ROWS; i++) {
+      for (let j = 0; j < COLS; j++) {
+        const result = samples.results[i][j];
+        if (!result) continue;
+        solved++;
+        expect(result.error_exponent).toBe(at([i, j]).error_exponent);
+      }
+    }
+    expect(samples.solved).toBe(solved);
+    // its neighbours are solved, not interpolated across it
+    for (const [i, j] of [[15, 8], [17, 8], [16, 7], [16, 9]]) expect(samples.results[i][j]).not.toBeNull();
+    for (let i = 0; i < ROWS; i++) {
+      for (let j = 0; j < COLS; j++) if (!failed(i, j)) expect(Number.isFinite(samples.values[i][j])).toBe(true);
+    }
+  });
+});
+
+// ============================================================================
+// log10 Pe fill-in
+// ============================================================================
+describe('contourMatrix', () => {
+  it('interpolates Pe in log scale and returns solved nodes as computed', async () => {
+    // log10 Pe bilinear in the node indices, so its interpolant is exact and a linear one in Pe is not
+    const ROWS = 17, COLS = 17;
+    const pe = (i: number, j: number) => Math.pow(10, -(0.5 * i + 0.25 * j + 0.01 * i * j));
+    const at = ([i, j]: [number, number]): ComputationResult => ({ ...point(0.5), error_probability: pe(i, j), optimal_rho: 0.5 });
+    const s = solver(at);
+    const samples = await sampleGrid(ROWS, COLS, s.solve, adaptiveOptions('error_probability', undefined, TOLERANCE));
+    expect(samples.solved).toBeLessThan(ROWS * COLS);
+
+    const z = contourMatrix(samples, 'error_probability');
+    for (let i = 0; i < ROWS; i++) {
+      for (let j = 0; j < COLS; j++) {
+        if (samples.results[i][j]) expect(z[i][j]).toBe(pe(i, j));
+        expect(Math.abs(z[i][j] / pe(i, j) - 1)).toBeLessThan(1e-9);
+      }
+    }
+  });
+
+  it('returns the interpolated value itself for the other quantities', () => {
+    const samples = { values: [[0.1, 0.2]], results: [[point(0.5), null]], solved: 1, cancelled: false };
+    const z = contourMatrix(samples, 'optimal_rho');
+    expect(z[0][0]).toBe(point(0.5).optimal_rho);
+    expect(z[0][1]).toBe(0.2);
+  });
+});
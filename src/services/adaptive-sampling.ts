@@ -0,0 +1,322 @@
+/**
+ * Adaptive Sampling
+ *
+ * Chooses where plots and contours are solved instead of spreading the points evenly.
+ * A coarse uniform pass is refined in rounds, each solved as one batch:
+ * - Plots split the intervals whose midpoint a straight line would miss by more than the
+ *   tolerance. Along R the exponent's exact slope is known (dE/dR = -rho*), so the error comes
+ *   from the gap between the cubic Hermite and linear interpolants. Along other axes it comes from
+ *   second divided differences.
+ * - Contours refine a quadtree over the output grid. A cell is accepted once its edge midpoints and
+ *   center agree with the bilinear interpolant of its corners, and the rest of its nodes are
+ *   interpolated.
+ * Intervals and cells where rho* reaches 0 or 1 at some samples but not at others are refined down
+ * to half the seed spacing whatever their error, since that is where the exponent has its knee (the
+ * critical rate) or drops to zero (capacity). Samples without a finite value, failed points
+ * included, are refined down to the finest spacing.
+ */
+
+import type { ComputationResult } from './computation.js'
+
+export interface AdaptiveOptions {
+  value: (result: ComputationResult) => number   // quantity whose interpolation error is bounded
+  slope?: (result: ComputationResult) => number   // its exact derivative along the axis, if known
+  tolerance: number                               // relative to the range of value over the samples
+}
+
+// Solves the given points: results[i] is the result for points[i], unsolvedResult() where that point
+// failed or, in a cancelled batch, was never reached.
+export type AdaptiveSolver<P> = (points: P[]) => Promise<{ results: ComputationResult[]; cancelled: boolean }>
+
+// Placeholder for a point without a result; every value is NaN
+export function unsolvedResult(): ComputationResult {
+  return {
+    error_probability: NaN,
+    error_exponent: NaN,
+    optimal_rho: NaN,
+    mutual_information: NaN,
+    cutoff_rate: NaN,
+    critical_rate: NaN,
+    computation_time_ms: 0,
+    cached: false
+  }
+}
+
+function isUnsolved(result: ComputationResult): boolean {
+  return Number.isNaN(result.error_exponent)
+}
+
+export interface AdaptivePlotSamples {
+  x: number[]                      // sorted, nonuniform; the solved samples only
+  results: ComputationResult[]     // results[i] at x[i]
+  cancelled: boolean
+}
+
+export interface AdaptiveContourSamples {
+  values: number[][]               // value() at every node, interpolated where not solved
+  results: Array<Array<ComputationResult | null>>  // the solved nodes
+  solved: number                   // nodes with a result (failed ones are not counted)
+  cancelled: boolean
+}
+
+const SEED_POINTS = 9              // a plot's first pass; the exponent has no features narrower than its spacing
+const FINEST_SPACING = 4           // intervals stop splitting at 1/4 of the uniform spacing
+const SEED_CELLS = 4               // a contour's seed lattice has at least this many cells per axis
+const RHO_EDGE = 1e-3              // rho* within this of 0 or 1 counts as on the boundary
+const REGIME_SPLITS = 2            // intervals and cells across a regime change split down to half the seed spacing
+
+// 0: rho* = 0, 1: interior, 2: rho* = 1, -1: no finite value
+function regime(result: ComputationResult, value: number): number {
+  if (!Number.isFinite(value)) return -1
+  if (result.optimal_rho <= RHO_EDGE) return 0
+  if (result.optimal_rho >= 1 - RHO_EDGE) return 2
+  return 1
+}
+
+function spread(values: number[]): number {
+  let lo = Infinity, hi = -Infinity
+  for (const v of values) {
+    if (!Number.isFinite(v)) continue
+    lo = Math.min(lo, v)
+    hi = Math.max(hi, v)
+  }
+  return hi > lo ? hi - lo : 0
+}
+
+function linspace(start: number, end: number, points: number): number[] {
+  if (points === 1) return [start]
+  return Array.from({ length: points }, (_, i) => start + (end - start) * i / (points - 1))
+}
+
+/**
+ * Samples [lo, hi] with at most budget solves.
+ */
+export async function sampleInterval(
+  lo: number,
+  hi: number,
+  budget: number,
+  solve: AdaptiveSolver<number>,
+  options: AdaptiveOptions
+): Promise<AdaptivePlotSamples> {
+  const samples: Array<{ x: number; result: ComputationResult }> = []
+  // failed samples stay (as non-finite values, which force refinement around them) unless the
+  // batch was cancelled, where they cannot be told from the points it never reached
+  const run = async (xs: number[]): Promise<boolean> => {
+    const batch = await solve(xs)
+    batch.results.forEach((result, i) => {
+      if (!batch.cancelled || !isUnsolved(result)) samples.push({ x: xs[i], result })
+    })
+    samples.sort((a, b) => a.x - b.x)
+    return batch.cancelled
+  }
+  const done = (cancelled: boolean): AdaptivePlotSamples => {
+    const kept = samples.filter(s => !isUnsolved(s.result))
+    return { x: kept.map(s => s.x), results: kept.map(s => s.result), cancelled }
+  }
+
+  const seed = Math.min(budget, SEED_POINTS)
+  if (await run(linspace(lo, hi, seed))) return done(true)
+  if (budget <= seed || hi <= lo) return done(false)
+
+  const finest = (hi - lo) / ((budget - 1) * FINEST_SPACING)
+  const regimeSpacing = (hi - lo) / ((seed - 1) * REGIME_SPLITS)
+  while (samples.length < budget) {
+    const x = samples.map(s => s.x)
+    const y = samples.map(s => options.value(s.result))
+    const regimes = samples.map((s, i) => regime(s.result, y[i]))
+    const threshold = options.tolerance * spread(y)
+
+    // |f''| at each node from the divided differences around it
+    const curvature = y.map((_, k) => {
+      if (k === 0 || k === y.length - 1) return 0
+      const c = 2 * ((y[k + 1] - y[k]) / (x[k + 1] - x[k]) - (y[k] - y[k - 1]) / (x[k] - x[k - 1])) / (x[k + 1] - x[k - 1])
+      return Number.isFinite(c) ? Math.abs(c) : 0
+    })
+
+    // regime changes first, widest first; then the largest interpolation errors
+    const candidates: Array<{ mid: number; change: boolean; weight: number }> = []
+    for (let i = 0; i + 1 < samples.length; i++) {
+      const h = x[i + 1] - x[i]
+      if (h / 2 < finest) continue
+      let error: number
+      if (options.slope) {
+        // cubic Hermite minus chord at the midpoint: h (f'(a) - f'(b)) / 8
+        error = Math.abs(h * (options.slope(samples[i].result) - options.slope(samples[i + 1].result)) / 8)
+      } else {
+        error = Math.max(curvature[i], curvature[i + 1]) * h * h / 8
+      }
+      const failed = regimes[i] < 0 || regimes[i + 1] < 0
+      if (regimes[i] !== regimes[i + 1] && (h > regimeSpacing || failed)) {
+        candidates.push({ mid: x[i] + h / 2, change: true, weight: h })
+      } else if (Number.isFinite(error) && error > threshold) {
+        candidates.push({ mid: x[i] + h / 2, change: false, weight: error })
+      }
+    }
+    if (candidates.length === 0) break
+
+    candidates.sort((a, b) => Number(b.change) - Number(a.change) || b.weight - a.weight)
+    const next = candidates.slice(0, budget - samples.length).map(c => c.mid)
+    if (await run(next)) return done(true)
+  }
+  return done(false)
+}
+
+interface Cell {
+  i0: number
+  i1: number
+  j0: number
+  j1: number
+}
+
+/**
+ * Samples the rows x cols grid of nodes (i, j), solving its corners first and refining a quadtree
+ * of cells from a seed lattice. Every node ends up solved or inside a cell with solved corners.
+ */
+export async function sampleGrid(
+  rows: number,
+  cols: number,
+  solve: AdaptiveSolver<[number, number]>,
+  options: AdaptiveOptions
+): Promise<AdaptiveContourSamples> {
+  const solved = new Map<number, { result: ComputationResult; value: number }>()
+  const key = (i: number, j: number) => i * cols + j
+  // failed nodes are kept with a non-finite value, as in sampleInterval
+  const run = async (nodes: Array<[number, number]>): Promise<boolean> => {
+    const batch = await solve(nodes)
+    batch.results.forEach((result, k) => {
+      if (batch.cancelled && isUnsolved(result)) return
+      solved.set(key(nodes[k][0], nodes[k][1]), { result, value: options.value(result) })
+    })
+    return batch.cancelled
+  }
+  const unsolved = (nodes: Array<[number, number]>) => {
+    const seen = new Set<number>()
+    return nodes.filter(([i, j]) => {
+      const k = key(i, j)
+      if (solved.has(k) || seen.has(k)) return false
+      seen.add(k)
+      return true
+    })
+  }
+
+  // seed lattice: power-of-two strides leaving at least SEED_CELLS cells per axis, plus the last line
+  const lattice = (n: number) => {
+    let stride = 1
+    while ((n - 1) / (stride * 2) >= SEED_CELLS) stride *= 2
+    const lines: number[] = []
+    for (let i = 0; i < n - 1; i += stride) lines.push(i)
+    lines.push(n - 1)
+    return lines
+  }
+  const lines1 = rows > 1 ? lattice(rows) : [0]
+  const lines2 = cols > 1 ? lattice(cols) : [0]
+  const regimeSpan1 = (lines1.length > 1 ? lines1[1] - lines1[0] : 0) / REGIME_SPLITS
+  const regimeSpan2 = (lines2.length > 1 ? lines2[1] - lines2[0] : 0) / REGIME_SPLITS
+  let active: Cell[] = []
+  const leaves: Cell[] = []
+  for (let a = 0; a < Math.max(1, lines1.length - 1); a++) {
+    for (let b = 0; b < Math.max(1, lines2.length - 1); b++) {
+      active.push({
+        i0: lines1[a], i1: lines1[Math.min(a + 1, lines1.length - 1)],
+        j0: lines2[b], j1: lines2[Math.min(b + 1, lines2.length - 1)]
+      })
+    }
+  }
+  const seed: Array<[number, number]> = []
+  for (const i of lines1) for (const j of lines2) seed.push([i, j])
+  let cancelled = await run(seed)
+
+  // test nodes of a cell, which become the corners of its children
+  const splits = (c: Cell) => {
+    const im = c.i1 - c.i0 >= 2 ? Math.floor((c.i0 + c.i1) / 2) : -1
+    const jm = c.j1 - c.j0 >= 2 ? Math.floor((c.j0 + c.j1) / 2) : -1
+    const is = im >= 0 ? [c.i0, im, c.i1] : [c.i0, c.i1]
+    const js = jm >= 0 ? [c.j0, jm, c.j1] : [c.j0, c.j1]
+    const children: Cell[] = []
+    for (let a = 0; a + 1 < is.length; a++) {
+      for (let b = 0; b + 1 < js.length; b++) children.push({ i0: is[a], i1: is[a + 1], j0: js[b], j1: js[b + 1] })
+    }
+    const nodes: Array<[number, number]> = []
+    for (const i of is) for (const j of js) nodes.push([i, j])
+    return { children, nodes }
+  }
+  const bilinear = (c: Cell, i: number, j: number) => {
+    const u = c.i1 > c.i0 ? (i - c.i0) / (c.i1 - c.i0) : 0
+    const v = c.j1 > c.j0 ? (j - c.j0) / (c.j1 - c.j0) : 0
+    const z = (a: number, b: number) => solved.get(key(a, b))?.value ?? NaN // corners of a cancelled seed
+    return (1 - u) * ((1 - v) * z(c.i0, c.j0) + v * z(c.i0, c.j1)) + u * ((1 - v) * z(c.i1, c.j0) + v * z(c.i1, c.j1))
+  }
+
+  while (!cancelled && active.length > 0) {
+    const refinable = active.filter(c => c.i1 - c.i0 >= 2 || c.j1 - c.j0 >= 2)
+    leaves.push(...active.filter(c => c.i1 - c.i0 < 2 && c.j1 - c.j0 < 2))
+    if (refinable.length === 0) {
+      active = []
+      break
+    }
+    const tests = refinable.map(splits)
+    cancelled = await run(unsolved(tests.flatMap(t => t.nodes)))
+    if (cancelled) {
+      active = refinable
+      break
+    }
+
+    const threshold = options.tolerance * spread([...solved.values()].map(s => s.value))
+    active = []
+    refinable.forEach((cell, k) => {
+      const nodes = tests[k].nodes.map(([i, j]) => ({ i, j, ...solved.get(key(i, j))! }))
+      const regimes = new Set(nodes.map(n => regime(n.result, n.value)))
+      // the children interpolate over half the spacing, with about a quarter of this deviation
+      const accurate = nodes.every(n => Math.abs(n.value - bilinear(cell, n.i, n.j)) <= 4 * threshold)
+      const straddles = regimes.size > 1 && (cell.i1 - cell.i0 > regimeSpan1 || cell.j1 - cell.j0 > regimeSpan2)
+      if (!straddles && !regimes.has(-1) && accurate) {
+        leaves.push(...tests[k].children) // the children's corners are all solved
+      } else {
+        active.push(...tests[k].children)
+      }
+    })
+  }
+
+  // fill from the leaves, finest last so that they win on shared edges
+  const values: number[][] = Array.from({ length: rows }, () => new Array(cols).fill(NaN))
+  const area = (c: Cell) => (c.i1 - c.i0 + 1) * (c.j1 - c.j0 + 1)
+  for (const cell of [...leaves, ...active].sort((a, b) => area(b) - area(a))) {
+    for (let i = cell.i0; i <= cell.i1; i++) {
+      for (let j = cell.j0; j <= cell.j1; j++) values[i][j] = bilinear(cell, i, j)
+    }
+  }
+  const results: Array<Array<ComputationResult | null>> = Array.from({ length: rows }, () => new Array(cols).fill(null))
+  let count = 0
+  for (const [k, s] of solved) {
+    if (isUnsolved(s.result)) continue
+    values[Math.floor(k / cols)][k % cols] = s.value
+    results[Math.floor(k / cols)][k % cols] = s.result
+    count++
+  }
+  return { values, results, solved: count, cancelled }
+}
+
+/**
+ * What adaptive sampling keeps accurate for a plotted quantity y: Pe in log scale, and the exact
+ * slope dE/dR = -rho* of the exponent when sweeping R
+ */
+export function adaptiveOptions(y: string, axis: string | undefined, tolerance: number): AdaptiveOptions {
+  return {
+    value: result => y === 'error_probability' ? Math.log10(result.error_probability)
+      : y === 'optimal_rho' ? result.optimal_rho : result.error_exponent,
+    slope: axis === 'R' && (y === 'error_exponent' || y === 'all') ? result => -result.optimal_rho : undefined,
+    tolerance
+  }
+}
+
+/**
+ * The contour of y from its samples: solved nodes as computed, the others from the interpolated
+ * values (log10 Pe for Pe)
+ */
+export function contourMatrix(samples: AdaptiveContourSamples, y: string): number[][] {
+  return samples.values.map((row, i) => row.map((value, j) => {
+    const result = samples.results[i][j]
+    if (result) return result[y as keyof ComputationResult] as number
+    return y === 'error_probability' ? Math.pow(10, value) : value
+  }))
+}
@@ -3,7 +3,9 @@ import { createHash, randomUUID } from 'crypto'
 import { config } from '../config/index.js'
 import { DatabaseService } from './database.js'
 import { cppCalculator } from './cpp-exact.js'
-import { getWorkerPool, shutdownWorkerPool, type CPPWorkerPool } from './cpp-worker-pool.js'
+import { nativeCalculator } from './cpp-native.js'
+import { getWorkerPool, shutdownWorkerPool, type CPPWorkerPool, type BatchResultItem } from './cpp-worker-pool.js'
+import { adaptiveOptions, contourMatrix, sampleGrid, sampleInterval, unsolvedResult } from './adaptive-sampling.js'
 import type { CancellationToken } from '../utils/cancellation.js'
 import type { FastifyBaseLogger } from 'fastify'
 import ref from 'ref-napi'
@@ -52,6 +54,7 @@ export interface PlotParameters extends ComputationParameters {
   x_range: [number, number]
   points: number
   snrUnit?: 'dB' | 'linear'
+  sampling?: 'uniform' | 'adaptive'  // adaptive: at most `points` solves, placed where the curve bends (SNR, R, threshold)
 }
 
 export interface PlotResult {
@@ -91,6 +94,7 @@ export interface ContourParameters extends ComputationParameters {
   points1: number
   points2: number
   snrUnit?: 'dB' | 'linear'
+  sampling?: 'uniform' | 'adaptive'  // adaptive: quadtree refinement of the grid, the rest interpolated (SNR, R, threshold)
 }
 
 export interface ContourResult {
@@ -102,6 +106,7 @@ export interface ContourResult {
   incomplete?: boolean       // true if cancelled before completion
   computed_points?: number   // how many points were computed
   requested_points?: number  // how many were requested
+  interpolated_points?: number // adaptive sampling: grid nodes filled from the solved ones around them
 }
 
 /**
@@ -114,6 +119,16 @@ export interface BatchResult {
   allCached: boolean
 }
 
+/**
+ * The same with results[i] for the i-th requested point, null where it failed or was not reached
+ */
+export interface IndexedBatchResult {
+  results: Array<ComputationResult | null>
+  cancelled: boolean
+  totalRequested: number
+  allCached: boolean
+}
+
 export class ComputationService {
   private static instance: ComputationService
   private workers: Worker[] = []
@@ -122,6 +137,7 @@ export class ComputationService {
   private logger?: FastifyBaseLogger
   private workerPool?: CPPWorkerPool
   private useWorkerPool = true  // Toggle between worker pool and direct FFI
+  private useNativeAddon = false  // In-process Node-API addon instead of both (USE_NATIVE_ADDON)
 
   private constructor() {}
 
@@ -135,6 +151,13 @@ export class ComputationService {
     )
   }
 
+  /**
+   * Axes on which adaptive sampling may place points anywhere in the range
+   */
+  private isContinuousAxis(axis: string): boolean {
+    return axis === 'SNR' || axis === 'R' || axis === 'threshold'
+  }
+
   static getInstance(): ComputationService {
     if (!ComputationService.instance) {
       ComputationService.instance = new ComputationService()
@@ -150,6 +173,21 @@ export class ComputationService {
     this.logger = logger
 
     try {
+      // The native addon runs on the libuv thread pool, so no worker processes are needed
+      if (config.USE_NATIVE_ADDON) {
+        if (nativeCalculator.isReady()) {
+          this.useNativeAddon = true
+          this.useWorkerPool = false
+          this.logger?.info('✅ Using the in-process native addon for computations')
+          nativeCalculator.calibrateCostModel().then((model: any) => {
+            this.logger?.info(`Native cost model calibrated in ${model.calibrationMs.toFixed(0)} ms: ` +
+              `${model.evalNsPerCell.toFixed(2)} ns/cell per E0 evaluation, ${model.evaluations.toFixed(1)} evaluations per point`)
+          })
+        } else {
+          this.logger?.warn('USE_NATIVE_ADDON is set but the addon is not built (npm run build:native)')
+        }
+      }
+
       // Initialize worker pool for CPU-intensive computations with cancellation support
       if (this.useWorkerPool) {
         this.workerPool = getWorkerPool(this.logger)
@@ -373,6 +411,187 @@ export class ComputationService {
     }
   }
 
+  /**
+   * Run fn with a native cancel token that follows cancellationToken: the engine checks it between
+   * E0 evaluations, so a cancelled request stops the solver instead of running to completion
+   */
+  private async withNativeCancellation<T>(
+    cancellationToken: CancellationToken | undefined,
+    fn: (nativeToken: unknown) => Promise<T>
+  ): Promise<T> {
+    const nativeToken = nativeCalculator.createCancelToken()
+    const checkInterval = cancellationToken && setInterval(() => {
+      if (cancellationToken.isCancelled) {
+        clearInterval(checkInterval)
+        nativeCalculator.cancel(nativeToken)
+      }
+    }, 10) // Same polling period as the worker pool
+
+    try {
+      return await fn(nativeToken)
+    } finally {
+      if (checkInterval) clearInterval(checkInterval)
+    }
+  }
+
+  /**
+   * Reject a point whose predicted time (native cost model) exceeds MAX_COMPUTATION_TIME, or
+   * whose memory exceeds MAX_COMPUTATION_MEMORY_MB, before anything is allocated. Both are
+   * predicted for the mode the point will run in with the options of the call: points over
+   * memoryBudgetMb in dense mode switch to streaming, whose buffers are what counts then.
+   */
+  private checkNativeBudget(params: ComputationParameters | CustomComputationParameters): void {
+    const options = { memoryBudgetMb: config.MAX_COMPUTATION_MEMORY_MB, tiled: config.NATIVE_TILED_EVALUATION }
+    const estimate = 'customConstellation' in params && params.customConstellation
+      ? nativeCalculator.estimateCustomCost(params.customConstellation.points, { SNR: params.SNR, N: params.N }, options)
+      : nativeCalculator.estimateCost(params, options)
+    const peakMB = estimate.peakBytes / (1024 * 1024)
+
+    if (peakMB > config.MAX_COMPUTATION_MEMORY_MB) {
+      throw new Error(`Computation exceeds the memory budget: predicted ${peakMB.toFixed(0)} MB > ${config.MAX_COMPUTATION_MEMORY_MB} MB (reduce N or M)`)
+    }
+    if (estimate.timeMs > config.MAX_COMPUTATION_TIME) {
+      throw new Error(`Computation exceeds the time budget: predicted ${(estimate.timeMs / 1000).toFixed(1)} s > ${config.MAX_COMPUTATION_TIME / 1000} s (reduce N or M)`)
+    }
+  }
+
+  /**
+   * Execute computation via the native addon (asynchronous, cancellable while solving,
+   * stopped after MAX_COMPUTATION_TIME)
+   */
+  private async callNativeComputation(
+    params: ComputationParameters | CustomComputationParameters,
+    cancellationToken?: CancellationToken
+  ): Promise<Omit<ComputationResult, 'cached'>> {
+    const startTime = Date.now()
+
+    if (cancellationToken?.isCancelled) {
+      throw new Error('Computation cancelled before execution')
+    }
+    this.checkNativeBudget(params)
+
+    try {
+      const result: any = await this.withNativeCancellation(cancellationToken, nativeToken => {
+        const options = {
+          cancelToken: nativeToken,
+          timeoutMs: config.MAX_COMPUTATION_TIME,
+          memoryBudgetMb: config.MAX_COMPUTATION_MEMORY_MB,
+          tiled: config.NATIVE_TILED_EVALUATION,
+          kernelThreads: config.NATIVE_KERNEL_THREADS
+        }
+
+        if ('customConstellation' in params && params.customConstellation) {
+          const points = params.customConstellation.points
+          this.logger?.info(`Native Custom computation: ${points.length} points, SNR=${params.SNR}, R=${params.R}`)
+          return nativeCalculator.computeCustom(points, params.SNR, params.R, params.N, params.n, params.threshold, options)
+        }
+        const stdParams = params as ComputationParameters
+        this.logger?.info(`Native Standard computation: M=${stdParams.M}, type=${stdParams.typeModulation}, SNR=${stdParams.SNR}, R=${stdParams.R}`)
+        return nativeCalculator.compute(
+          stdParams.M,
+          stdParams.typeModulation,
+          stdParams.SNR,
+          stdParams.R,
+          stdParams.N,
+          stdParams.n,
+          stdParams.threshold,
+          'uniform',
+          0.0,
+          options
+        )
+      })
+
+      // A solver stopped by the deadline keeps its last iterate, which must not be cached as a result
+      if (result.stopped) {
+        throw new Error(`Computation cancelled before convergence (${config.MAX_COMPUTATION_TIME} ms limit)`)
+      }
+      if (result.evaluation_mode === 'streaming') {
+        this.logger?.info(`Native computation ran in streaming mode (dense matrices over ${config.MAX_COMPUTATION_MEMORY_MB} MB)`)
+      }
+
+      return {
+        error_probability: result.error_probability,
+        error_exponent: result.error_exponent,
+        optimal_rho: result.optimal_rho,
+        mutual_information: result.mutual_information,
+        cutoff_rate: result.cutoff_rate,
+        critical_rate: result.critical_rate,
+        computation_time_ms: Date.now() - startTime
+      }
+
+    } catch (error) {
+      this.logger?.error('Native computation failed:', error)
+      throw new Error(`Computation failed: ${error instanceof Error ? error.message : 'Unknown error'}`)
+    }
+  }
+
+  /**
+   * Execute a batch via the native addon: standard points in one call, custom points in one
+   * call per distinct constellation. Results are returned in the order of params; onItem also
+   * receives each of them, with its index in params, as soon as it is solved. Cancelling stops
+   * the points still being solved; they come back as cancelled items. Points over the budgets of
+   * checkNativeBudget fail without being run.
+   */
+  private async callNativeBatch(
+    params: Array<ComputationParameters | CustomComputationParameters>,
+    onItem?: (index: number, item: BatchResultItem) => void,
+    cancellationToken?: CancellationToken
+  ): Promise<BatchResultItem[]> {
+    const results: BatchResultItem[] = new Array(params.length)
+    const standard: number[] = []
+    const custom = new Map<string, number[]>()
+
+    params.forEach((p, index) => {
+      try {
+        this.checkNativeBudget(p)
+      } catch (error) {
+        results[index] = { taskId: `native_${index}`, success: false, error: error instanceof Error ? error.message : String(error) }
+        onItem?.(index, results[index])
+        return
+      }
+      if ('customConstellation' in p && p.customConstellation) {
+        const key = JSON.stringify(p.customConstellation.points)
+        custom.set(key, [...(custom.get(key) ?? []), index])
+      } else {
+        standard.push(index)
+      }
+    })
+
+    // Per-worker utilisation of the engine's work-stealing scheduler
+    const onStats = (stats: { wallMs: number; threads: Array<{ utilisation: number; stolen: number }> }) => {
+      const utilisation = stats.threads.map(t => `${Math.round(t.utilisation * 100)}%`).join(' ')
+      const stolen = stats.threads.reduce((sum, t) => sum + t.stolen, 0)
+      this.logger?.debug(`Native batch: ${stats.wallMs.toFixed(1)} ms, utilisation ${utilisation}, ${stolen} chunks stolen`)
+    }
+
+    // The batch already keeps every core busy with whole points, so each E0 evaluation stays on one thread
+    const memoryBudgetMb = config.MAX_COMPUTATION_MEMORY_MB
+    const tiled = config.NATIVE_TILED_EVALUATION
+    await this.withNativeCancellation(cancellationToken, async cancelToken => {
+      const runs: Array<Promise<void>> = []
+      if (standard.length > 0) {
+        const points = standard.map(index => params[index] as ComputationParameters)
+        const onResult = onItem && ((k: number, item: BatchResultItem) => onItem(standard[k], item))
+        runs.push(nativeCalculator.computeBatch(points, { onResult, onStats, cancelToken, memoryBudgetMb, tiled }).then(batch => {
+          batch.forEach((item, k) => { results[standard[k]] = item })
+        }))
+      }
+      for (const indices of custom.values()) {
+        const first = params[indices[0]] as CustomComputationParameters
+        const points = indices.map(index => {
+          const p = params[index]
+          return { SNR: p.SNR, R: p.R, N: p.N, n: p.n, threshold: p.threshold }
+        })
+        const onResult = onItem && ((k: number, item: BatchResultItem) => onItem(indices[k], item))
+        runs.push(nativeCalculator.computeCustomBatch(first.customConstellation.points, points, { onResult, onStats, cancelToken, memoryBudgetMb, tiled }).then(batch => {
+          batch.forEach((item, k) => { results[indices[k]] = item })
+        }))
+      }
+      await Promise.all(runs)
+    })
+    return results
+  }
+
   /**
    * Route computation to either worker pool (cancellable) or direct FFI
    */
@@ -380,6 +599,9 @@ export class ComputationService {
     params: ComputationParameters | CustomComputationParameters,
     cancellationToken?: CancellationToken
   ): Promise<Omit<ComputationResult, 'cached'>> {
+    if (this.useNativeAddon) {
+      return this.callNativeComputation(params, cancellationToken)
+    }
     // Use worker pool if available and cancellation is needed
     if (this.useWorkerPool && this.workerPool && cancellationToken) {
       return this.callWorkerComputation(params, cancellationToken)
@@ -496,19 +718,40 @@ export class ComputationService {
    * 4. Only compute uncached points
    * 5. Merge results maintaining original order
    * 6. Handle cancellation with partial results
+   *
+   * With the native addon, each computed point is cached and passed to onResult (with its index
+   * in paramsList) as soon as it is solved, so partial results survive a failure later in the batch.
+   *
+   * The results leave out the points that failed or were not reached; computeBatchByIndex keeps
+   * their places.
    */
   async computeBatch(
     paramsList: (ComputationParameters | CustomComputationParameters)[],
     sessionId?: string,
     ipAddress?: string,
-    cancellationToken?: CancellationToken
+    cancellationToken?: CancellationToken,
+    onResult?: (index: number, result: ComputationResult) => void
   ): Promise<BatchResult> {
+    const batch = await this.computeBatchByIndex(paramsList, sessionId, ipAddress, cancellationToken, onResult)
+    return { ...batch, results: batch.results.filter((r): r is ComputationResult => r !== null) }
+  }
+
+  /**
+   * computeBatch with one entry per requested point, null for those without a result
+   */
+  async computeBatchByIndex(
+    paramsList: (ComputationParameters | CustomComputationParameters)[],
+    sessionId?: string,
+    ipAddress?: string,
+    cancellationToken?: CancellationToken,
+    onResult?: (index: number, result: ComputationResult) => void
+  ): Promise<IndexedBatchResult> {
     const totalRequested = paramsList.length
     let cancelled = false
 
     // Early cancellation check
     if (cancellationToken?.isCancelled) {
-      return { results: [], cancelled: true, totalRequested, allCached: false }
+      return { results: new Array(totalRequested).fill(null), cancelled: true, totalRequested, allCached: false }
     }
 
     // Step 1: Generate hashes for all parameters and validate
@@ -547,7 +790,7 @@ export class ComputationService {
     if (uncachedItems.length === 0) {
       this.logger?.info('All points from cache, no computation needed')
       return {
-        results: finalResults as ComputationResult[],
+        results: finalResults,
         cancelled: false,
         totalRequested,
         allCached: true
@@ -560,58 +803,12 @@ export class ComputationService {
     const startTime = Date.now()
 
     try {
-      if (this.useWorkerPool && this.workerPool) {
-        // Prepare tasks for batch execution
-        const batchTasks = uncachedItems.map((item, idx) => {
-          const isCustom = 'customConstellation' in item.params && item.params.customConstellation
-
-          if (isCustom) {
-            const customParams = item.params as CustomComputationParameters
-            const points = customParams.customConstellation.points
-            const numPoints = points.length
-
-            // Create typed arrays for FFI
-            const realParts = Buffer.alloc(numPoints * 8)
-            const imagParts = Buffer.alloc(numPoints * 8)
-            const probabilities = Buffer.alloc(numPoints * 8)
-
-            for (let i = 0; i < numPoints; i++) {
-              realParts.writeDoubleLE(points[i].real, i * 8)
-              imagParts.writeDoubleLE(points[i].imag, i * 8)
-              probabilities.writeDoubleLE(points[i].prob, i * 8)
-            }
-
-            return {
-              id: `task_${idx}_${item.hash.substring(0, 8)}`,
-              type: 'compute_custom' as const,
-              params: [realParts, imagParts, probabilities, numPoints,
-                       customParams.SNR, customParams.R, customParams.N,
-                       customParams.n, customParams.threshold]
-            }
-          } else {
-            const stdParams = item.params as ComputationParameters
-            return {
-              id: `task_${idx}_${item.hash.substring(0, 8)}`,
-              type: 'compute' as const,
-              params: [stdParams.M, stdParams.typeModulation, stdParams.SNR,
-                       stdParams.R, stdParams.N, stdParams.n, stdParams.threshold,
-                       'uniform', 0.0]
-            }
-          }
-        })
-
-        // Execute all uncached tasks via batched IPC
-        const batchResults = await this.workerPool.executeBatch(batchTasks, cancellationToken)
-
-        const batchTime = Date.now() - startTime
-        this.logger?.info(`Batched computation completed in ${batchTime}ms for ${uncachedItems.length} points`)
-
-        // Process results and save to cache
+      if (this.useNativeAddon || (this.useWorkerPool && this.workerPool)) {
         const timestamp = new Date().toISOString()
         let computedCount = 0
 
-        for (let i = 0; i < batchResults.length; i++) {
-          const batchResult = batchResults[i]
+        // Store one computed point and save it to the cache (async, don't wait)
+        const recordResult = (i: number, batchResult: BatchResultItem, computation_time_ms: number) => {
           const item = uncachedItems[i]
 
           if (batchResult.success && batchResult.data) {
@@ -622,14 +819,14 @@ export class ComputationService {
               mutual_information: batchResult.data.mutual_information,
               cutoff_rate: batchResult.data.cutoff_rate,
               critical_rate: batchResult.data.critical_rate,
-              computation_time_ms: Math.round(batchTime / uncachedItems.length), // Amortized time
+              computation_time_ms,
               cached: false
             }
 
             finalResults[item.index] = result
             computedCount++
+            onResult?.(item.index, result)
 
-            // Save to database cache (async, don't wait)
             db.saveComputation({
               timestamp,
               parameters: item.hash,
@@ -644,6 +841,68 @@ export class ComputationService {
           // If result failed for non-cancellation reason, leave as null
         }
 
+        let batchResults: BatchResultItem[]
+        const streamed = new Set<number>()
+        if (this.useNativeAddon) {
+          // One in-process call per constellation, no task serialization; points are recorded as they finish
+          batchResults = await this.callNativeBatch(uncachedItems.map(item => item.params), (i, batchResult) => {
+            streamed.add(i)
+            recordResult(i, batchResult, Math.round((Date.now() - startTime) / streamed.size)) // Amortized time so far
+          }, cancellationToken)
+        } else {
+          // Prepare tasks for batch execution
+          const batchTasks = uncachedItems.map((item, idx) => {
+            const isCustom = 'customConstellation' in item.params && item.params.customConstellation
+
+            if (isCustom) {
+              const customParams = item.params as CustomComputationParameters
+              const points = customParams.customConstellation.points
+              const numPoints = points.length
+
+              // Create typed arrays for FFI
+              const realParts = Buffer.alloc(numPoints * 8)
+              const imagParts = Buffer.alloc(numPoints * 8)
+              const probabilities = Buffer.alloc(numPoints * 8)
+
+              for (let i = 0; i < numPoints; i++) {
+                realParts.writeDoubleLE(points[i].real, i * 8)
+                imagParts.writeDoubleLE(points[i].imag, i * 8)
+                probabilities.writeDoubleLE(points[i].prob, i * 8)
+              }
+
+              return {
+                id: `task_${idx}_${item.hash.substring(0, 8)}`,
+                type: 'compute_custom' as const,
+                params: [realParts, imagParts, probabilities, numPoints,
+                         customParams.SNR, customParams.R, customParams.N,
+                         customParams.n, customParams.threshold]
+              }
+            } else {
+              const stdParams = item.params as ComputationParameters
+              return {
+                id: `task_${idx}_${item.hash.substring(0, 8)}`,
+                type: 'compute' as const,
+                params: [stdParams.M, stdParams.typeModulation, stdParams.SNR,
+                         stdParams.R, stdParams.N, stdParams.n, stdParams.threshold,
+                         'uniform', 0.0]
+              }
+            }
+          })
+
+          // Execute all uncached tasks via batched IPC
+          batchResults = await this.workerPool!.executeBatch(batchTasks, cancellationToken)
+        }
+
+        const batchTime = Date.now() - startTime
+        this.logger?.info(`Batched computation completed in ${batchTime}ms for ${uncachedItems.length} points`)
+
+        // Process the results not recorded yet and save them to cache
+        for (let i = 0; i < batchResults.length; i++) {
+          if (!streamed.has(i)) {
+            recordResult(i, batchResults[i], Math.round(batchTime / uncachedItems.length)) // Amortized time
+          }
+        }
+
         this.logger?.info(`Batch processed: ${computedCount}/${uncachedItems.length} computed successfully`)
 
       } else {
@@ -680,12 +939,9 @@ export class ComputationService {
       }
     }
 
-    // Step 5: Filter out null results (incomplete due to cancellation)
-    // Return only the results that were actually computed
-    const validResults = finalResults.filter((r): r is ComputationResult => r !== null)
-
+    // Step 5: null where a point failed or was not reached (cancellation)
     return {
-      results: validResults,
+      results: finalResults,
       cancelled,
       totalRequested,
       allCached: false
@@ -765,54 +1021,80 @@ export class ComputationService {
       }
     }
 
-    // Generate x values for display (in the requested unit)
-    // And compute values (which may need conversion for computation)
-    const x_values_display: number[] = []  // Values to return for plotting (in requested unit)
-    const x_values_compute: number[] = []  // Values to use in computation (always linear for SNR)
-    const x_range = params.x_range
-
-    if (params.x === 'M' || params.x === 'N' || params.x === 'n') {
-      // Integer values - display and compute are the same
-      const raw = this.linspace(x_range[0], x_range[1], params.points)
-      const unique = [...new Set(raw.map(v => Math.round(v)))].sort((a, b) => a - b)
-      x_values_display.push(...unique)
-      x_values_compute.push(...unique)
-    } else if (params.x === 'SNR' && params.snrUnit === 'dB') {
-      // For SNR in dB:
-      // - Display values are in dB (what the user requested)
-      // - Compute values are converted to linear (what the computation needs)
-      const dBValues = this.linspace(x_range[0], x_range[1], params.points)
-      for (const dB of dBValues) {
-        x_values_display.push(dB)  // Return dB values for plotting
-        x_values_compute.push(Math.pow(10, dB / 10))  // Use linear for computation
-      }
-    } else {
-      // Continuous values (linear spacing) - display and compute are the same
-      const values = this.linspace(x_range[0], x_range[1], params.points)
-      x_values_display.push(...values)
-      x_values_compute.push(...values)
-    }
-
-    // Generate computation parameters for each x value (using compute values)
-    const computationParams: (ComputationParameters | CustomComputationParameters)[] = x_values_compute.map(x_val => {
+    let computed_x_values: number[]
+    let batchResult: BatchResult
+    if (params.sampling === 'adaptive' && this.isContinuousAxis(params.x)) {
       const baseParams = { ...params }
       delete (baseParams as any).y
       delete (baseParams as any).x
       delete (baseParams as any).x_range
       delete (baseParams as any).points
-      delete (baseParams as any).snrUnit  // Remove snrUnit from computation params
-
-      return {
-        ...baseParams,
-        [params.x]: x_val
+      delete (baseParams as any).snrUnit
+      delete (baseParams as any).sampling
+
+      // Samples are placed in display units (dB for SNR in dB), so the refinement follows the plot
+      const toCompute = (x: number) => params.x === 'SNR' && params.snrUnit === 'dB' ? Math.pow(10, x / 10) : x
+      let allCached = true
+      const samples = await sampleInterval(params.x_range[0], params.x_range[1], params.points, async xs => {
+        const round = await this.computeBatchByIndex(xs.map(x => ({ ...baseParams, [params.x]: toCompute(x) })),
+          sessionId, ipAddress, cancellationToken)
+        allCached = allCached && round.allCached
+        return { results: round.results.map(r => r ?? unsolvedResult()), cancelled: round.cancelled }
+      }, adaptiveOptions(params.y, params.x, config.ADAPTIVE_SAMPLING_TOLERANCE))
+
+      computed_x_values = samples.x
+      batchResult = { results: samples.results, cancelled: samples.cancelled, totalRequested: params.points, allCached }
+    } else {
+      // Generate x values for display (in the requested unit)
+      // And compute values (which may need conversion for computation)
+      const x_values_display: number[] = []  // Values to return for plotting (in requested unit)
+      const x_values_compute: number[] = []  // Values to use in computation (always linear for SNR)
+      const x_range = params.x_range
+
+      if (params.x === 'M' || params.x === 'N' || params.x === 'n') {
+        // Integer values - display and compute are the same
+        const raw = this.linspace(x_range[0], x_range[1], params.points)
+        const unique = [...new Set(raw.map(v => Math.round(v)))].sort((a, b) => a - b)
+        x_values_display.push(...unique)
+        x_values_compute.push(...unique)
+      } else if (params.x === 'SNR' && params.snrUnit === 'dB') {
+        // For SNR in dB:
+        // - Display values are in dB (what the user requested)
+        // - Compute values are converted to linear (what the computation needs)
+        const dBValues = this.linspace(x_range[0], x_range[1], params.points)
+        for (const dB of dBValues) {
+          x_values_display.push(dB)  // Return dB values for plotting
+          x_values_compute.push(Math.pow(10, dB / 10))  // Use linear for computation
+        }
+      } else {
+        // Continuous values (linear spacing) - display and compute are the same
+        const values = this.linspace(x_range[0], x_range[1], params.points)
+        x_values_display.push(...values)
+        x_values_compute.push(...values)
       }
-    })
 
-    // Compute results with cancellation and caching support
-    const batchResult = await this.computeBatch(computationParams, sessionId, ipAddress, cancellationToken)
+      // Generate computation parameters for each x value (using compute values)
+      const computationParams: (ComputationParameters | CustomComputationParameters)[] = x_values_compute.map(x_val => {
+        const baseParams = { ...params }
+        delete (baseParams as any).y
+        delete (baseParams as any).x
+        delete (baseParams as any).x_range
+        delete (baseParams as any).points
+        delete (baseParams as any).snrUnit  // Remove snrUnit from computation params
+        delete (baseParams as any).sampling
+
+        return {
+          ...baseParams,
+          [params.x]: x_val
+        }
+      })
 
-    // Slice x_values to match the number of computed results
-    const computed_x_values = x_values_display.slice(0, batchResult.results.length)
+      // Compute results with cancellation and caching support
+      batchResult = await this.computeBatch(computationParams, sessionId, ipAddress, cancellationToken)
+
+      // Slice x_values to match the number of computed results
+      computed_x_values = x_values_display.slice(0, batchResult.results.length)
+    }
 
     const computation_time_ms = Date.now() - startTime
 
@@ -904,6 +1186,44 @@ export class ComputationService {
     const x1_data = generateValuesWithCompute(params.x1, params.x1_range, params.points1, params.snrUnit)
     const x2_data = generateValuesWithCompute(params.x2, params.x2_range, params.points2, params.snrUnit)
 
+    if (params.sampling === 'adaptive' && this.isContinuousAxis(params.x1) && this.isContinuousAxis(params.x2)) {
+      const baseParams = { ...params }
+      delete (baseParams as any).y
+      delete (baseParams as any).x1
+      delete (baseParams as any).x2
+      delete (baseParams as any).x1_range
+      delete (baseParams as any).x2_range
+      delete (baseParams as any).points1
+      delete (baseParams as any).points2
+      delete (baseParams as any).snrUnit
+      delete (baseParams as any).sampling
+
+      let allCached = true
+      const samples = await sampleGrid(x1_data.compute.length, x2_data.compute.length, async nodes => {
+        const round = await this.computeBatchByIndex(nodes.map(([i, j]) => ({
+          ...baseParams,
+          [params.x1]: x1_data.compute[i],
+          [params.x2]: x2_data.compute[j]
+        })), sessionId, ipAddress, cancellationToken)
+        allCached = allCached && round.allCached
+        return { results: round.results.map(r => r ?? unsolvedResult()), cancelled: round.cancelled }
+      }, adaptiveOptions(params.y, undefined, config.ADAPTIVE_SAMPLING_TOLERANCE))
+
+      const z_matrix = contourMatrix(samples, params.y)
+
+      return {
+        x1_values: x1_data.display,
+        x2_values: x2_data.display,
+        z_matrix,
+        computation_time_ms: Date.now() - startTime,
+        cached: allCached,
+        incomplete: samples.cancelled,
+        computed_points: samples.solved,
+        requested_points: totalPoints,
+        interpolated_points: totalPoints - samples.solved
+      }
+    }
+
     // Generate computation parameters for each combination (using compute values)
     const computationParams: (ComputationParameters | CustomComputationParameters)[] = []
     for (const x1_val of x1_data.compute) {
@@ -917,6 +1237,7 @@ export class ComputationService {
         delete (baseParams as any).points1
         delete (baseParams as any).points2
         delete (baseParams as any).snrUnit  // Remove snrUnit from computation params
+        delete (baseParams as any).sampling
 
         computationParams.push({
           ...baseParams,
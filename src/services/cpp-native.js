@@ -0,0 +1,359 @@
+// In-process C++ interface through the Node-API addon (exponents/addon.cpp, built with
+// `npm run build:native`). Computations run on the libuv thread pool and return Promises,
+// so no worker process, FFI marshalling or IPC is involved.
+
+import path from 'path';
+import { createRequire } from 'module';
+import { fileURLToPath } from 'url';
+
+const __filename = fileURLToPath(import.meta.url);
+const __dirname = path.dirname(__filename);
+const require = createRequire(import.meta.url);
+
+const addonPath = path.join(__dirname, '../../exponents/build/Release/epcalculator.node');
+
+let addon = null;
+let isAddonLoaded = false;
+
+try {
+    addon = require(addonPath);
+    isAddonLoaded = true;
+    console.log('✅ C++ native addon loaded successfully from:', addonPath);
+} catch (error) {
+    // Optional: the FFI library and the worker pool remain the default path
+    isAddonLoaded = false;
+}
+
+// EPStatus values of exponents/exponents.h
+const STATUS_OK = 0;
+const STATUS_INVALID_EXPONENT = 2;
+const STATUS_CANCELLED = 4;
+const STATUS_STOPPED = 5;
+
+// EPEvaluationMode values
+const EVALUATION_MODES = ['dense', 'streaming', 'low_snr_series', 'tiled', 'global_grid', 'fast_gauss'];
+
+/**
+ * Convert one row {Pe, E0, rho, I, R0, R_crit, status, converged, mode} of a result array into the
+ * result object used by cpp-exact.js, applying the same validation. A point stopped while solving
+ * keeps its last iterate (converged: false); one cancelled before it started throws.
+ */
+function toResult(row, method) {
+    const [Pe, E0, rho, mutualInformation, cutoffRate, criticalRate, status, converged, mode] = row;
+
+    if (status === STATUS_INVALID_EXPONENT) {
+        throw new Error('Numerical overflow detected in C++ computation');
+    }
+    if (status === STATUS_CANCELLED) {
+        throw new Error('Computation cancelled');
+    }
+    if (status !== STATUS_OK && status !== STATUS_STOPPED) {
+        throw new Error(`C++ computation failed with status ${status}`);
+    }
+    if (!isFinite(Pe) || !isFinite(E0) || !isFinite(rho)) {
+        throw new Error('C++ computation returned invalid values');
+    }
+
+    return {
+        error_probability: Pe,
+        error_exponent: Math.max(E0, 0.0),
+        optimal_rho: rho,
+        mutual_information: mutualInformation,
+        cutoff_rate: cutoffRate,
+        critical_rate: criticalRate,
+        converged: converged === 1,
+        evaluation_mode: EVALUATION_MODES[mode] ?? 'dense',
+        stopped: status === STATUS_STOPPED,
+        success: true,
+        computation_method: method
+    };
+}
+
+/**
+ * Cost estimate of the addon with its evaluationMode as one of EVALUATION_MODES
+ */
+function withModeName(estimate) {
+    return { ...estimate, evaluationMode: EVALUATION_MODES[estimate.evaluationMode] ?? 'dense' };
+}
+
+/**
+ * Batch entry {success, data} or {success, error} for one result row; a stopped point is
+ * reported as cancelled, with its last iterate still in data
+ */
+function toItem(row, method) {
+    try {
+        const data = toResult(row, method);
+        if (data.stopped) {
+            return { success: false, error: 'Computation cancelled before convergence', data };
+        }
+        return { success: true, data };
+    } catch (error) {
+        return { success: false, error: error.message };
+    }
+}
+
+/**
+ * Pack {real, imag, prob} points into the Float64Arrays read in place by the addon
+ */
+function toConstellation(points) {
+    const real = new Float64Array(points.length);
+    const imag = new Float64Array(points.length);
+    const probabilities = new Float64Array(points.length);
+    for (let i = 0; i < points.length; i++) {
+        real[i] = points[i].real;
+        imag[i] = points[i].imag;
+        probabilities[i] = points[i].prob;
+    }
+    return { real, imag, probabilities };
+}
+
+const toSolveResult = (result, method) =>
+    toResult([result.error_probability, result.error_exponent, result.optimal_rho, result.mutual_information,
+              result.cutoff_rate, result.critical_rate, result.status, result.converged, result.evaluation_mode], method);
+
+/**
+ * {level, N, errorEstimate, final} of a progressive level plus its {success, data} or {success, error} entry
+ */
+function toLevel({ result, ...level }, method) {
+    try {
+        return { ...level, success: true, data: toSolveResult(result, method) };
+    } catch (error) {
+        return { ...level, success: false, error: error.message };
+    }
+}
+
+/**
+ * Custom constellation kept by the engine between solves (exponents.h, EPSession): moving, adding or
+ * removing one point patches the cached distance matrix instead of rebuilding it, and each solve is
+ * warm-started from the previous optimal rho. Operations run in call order; an edit made while a
+ * solve is running waits for it.
+ */
+export class NativeSession {
+    constructor(points) {
+        this.handle = addon.createSession(toConstellation(points));
+        this.queue = Promise.resolve();
+    }
+
+    enqueue(operation) {
+        const next = this.queue.then(operation);
+        this.queue = next.catch(() => {});
+        return next;
+    }
+
+    movePoint(index, real, imag) {
+        return this.enqueue(() => addon.sessionMovePoint(this.handle, index, real, imag));
+    }
+
+    setProbability(index, prob) {
+        return this.enqueue(() => addon.sessionSetProbability(this.handle, index, prob));
+    }
+
+    /**
+     * @returns {Promise<number>} Index of the new point (the last one)
+     */
+    addPoint(real, imag, prob) {
+        return this.enqueue(() => addon.sessionAddPoint(this.handle, real, imag, prob));
+    }
+
+    /**
+     * Later points move down by one index
+     */
+    removePoint(index) {
+        return this.enqueue(() => addon.sessionRemovePoint(this.handle, index));
+    }
+
+    /**
+     * Same result as computeCustom for the session's current points
+     * @param {Object} options - {cancelToken, timeoutMs, memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance}
+     */
+    solve(SNR, R, N, n, threshold, options = {}) {
+        return this.enqueue(async () => {
+            const result = await addon.sessionSolve(this.handle, { SNR, R, N, n, threshold }, options);
+            return toSolveResult(result, 'cpp_native_session');
+        });
+    }
+}
+
+export class EPCalculatorNative {
+    constructor() {
+        this.isAvailable = isAddonLoaded;
+    }
+
+    /**
+     * Token for options.cancelToken; pass it to cancel() to stop every call using it
+     */
+    createCancelToken() {
+        this.ensureAvailable();
+        return addon.createCancelToken();
+    }
+
+    cancel(token) {
+        addon.cancel(token);
+    }
+
+    /**
+     * Predicted single-thread time and peak memory of one point, from the engine's cost model, in the
+     * evaluation mode the point would run in with these options
+     * @param {Object} params - {M, typeModulation, SNR, N, distribution, shaping_param}
+     * @param {Object} options - {memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance}, as for compute
+     * @returns {Object} {timeMs, peakBytes, streamingPeakBytes, evaluations, evaluationMode}
+     */
+    estimateCost(params, options) {
+        this.ensureAvailable();
+        return withModeName(addon.estimateCost(params, options));
+    }
+
+    /**
+     * Same for {real, imag, prob} points and {SNR, N}
+     */
+    estimateCustomCost(points, params, options) {
+        this.ensureAvailable();
+        return withModeName(addon.estimateCustomCost(toConstellation(points), params, options));
+    }
+
+    /**
+     * Run the cost-model microbenchmark off the event loop (otherwise the first estimate runs it)
+     * @returns {Promise<Object>} Model coefficients
+     */
+    async calibrateCostModel() {
+        this.ensureAvailable();
+        return addon.calibrateCostModel();
+    }
+
+    /**
+     * Compute error exponents for a standard modulation (same arguments as cppCalculator.compute)
+     * @param {Object} options - {cancelToken, timeoutMs, memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance}
+     * @returns {Promise<Object>} Computation results
+     */
+    async compute(M, typeModulation, SNR, R, N, n, threshold, distribution = 'uniform', shaping_param = 0.0, options = {}) {
+        this.ensureAvailable();
+        const result = await addon.exponents({ M, typeModulation, SNR, R, N, n, threshold, distribution, shaping_param }, options);
+        return toSolveResult(result, 'cpp_native');
+    }
+
+    /**
+     * Compute error exponents for a custom constellation given as {real, imag, prob} points
+     * @returns {Promise<Object>} Computation results
+     */
+    async computeCustom(points, SNR, R, N, n, threshold, options = {}) {
+        this.ensureAvailable();
+        if (!points || points.length < 2) {
+            throw new Error('Custom constellation must have at least 2 points');
+        }
+        const result = await addon.exponentsCustom(toConstellation(points), { SNR, R, N, n, threshold }, options);
+        return toSolveResult(result, 'cpp_native_custom');
+    }
+
+    /**
+     * Progressive evaluation of one standard-modulation point: solved first at options.initialN
+     * (default 5) quadrature nodes, then at growing N (x options.growth, default 2) up to N until the
+     * error estimate is below options.tolerance. options.onLevel({level, N, errorEstimate, final, success,
+     * data | error}) receives every level as soon as it is solved.
+     * @param {Object} options - {initialN, growth, tolerance, onLevel} and {cancelToken, timeoutMs, memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance}
+     * @returns {Promise<Object>} The last level, as passed to onLevel
+     */
+    async computeProgressive(M, typeModulation, SNR, R, N, n, threshold, distribution = 'uniform', shaping_param = 0.0, options = {}) {
+        this.ensureAvailable();
+        const level = await addon.exponentsProgressive({ M, typeModulation, SNR, R, N, n, threshold, distribution, shaping_param },
+                                                       this.progressiveOptions(options, 'cpp_native_progressive'));
+        return toLevel(level, 'cpp_native_progressive');
+    }
+
+    /**
+     * Same for a custom constellation given as {real, imag, prob} points
+     */
+    async computeCustomProgressive(points, SNR, R, N, n, threshold, options = {}) {
+        this.ensureAvailable();
+        if (!points || points.length < 2) {
+            throw new Error('Custom constellation must have at least 2 points');
+        }
+        const level = await addon.exponentsCustomProgressive(toConstellation(points), { SNR, R, N, n, threshold },
+                                                             this.progressiveOptions(options, 'cpp_native_custom_progressive'));
+        return toLevel(level, 'cpp_native_custom_progressive');
+    }
+
+    progressiveOptions({ onLevel, ...options }, method) {
+        if (!onLevel) return options;
+        return { ...options, onLevel: (level) => onLevel(toLevel(level, method)) };
+    }
+
+    /**
+     * Session for a custom constellation that is edited one point at a time (see NativeSession)
+     * @param {Array} points - {real, imag, prob} points
+     */
+    createSession(points) {
+        this.ensureAvailable();
+        if (!points || points.length < 2) {
+            throw new Error('Custom constellation must have at least 2 points');
+        }
+        return new NativeSession(points);
+    }
+
+    /**
+     * Compute many standard-modulation points in one call. The engine groups points sharing a
+     * constellation and spreads them over its own threads.
+     * @param {Array} params - Objects {M, typeModulation, SNR, R, N, n, threshold, distribution, shaping_param}
+     * @param {Object} options - {threads} (0: all cores), {cancelToken, timeoutMs, memoryBudgetMb, tiled, kernelThreads, globalGrid, fastGaussTolerance} and optionally
+     *   onResult(index, item), called with each point's {success, data} or {success, error} entry as
+     *   soon as it is solved, and onStats({wallMs, threads}), called with the per-worker
+     *   utilisation of the scheduler before the Promise settles
+     * @returns {Promise<Array>} One {success, data} or {success, error} entry per point, in order
+     */
+    async computeBatch(params, options = {}) {
+        this.ensureAvailable();
+        const out = await addon.exponentsBatch(params, this.addonOptions(options, 'cpp_native'));
+        return this.unpack(out, params.length, 'cpp_native');
+    }
+
+    /**
+     * Same for points {SNR, R, N, n, threshold} of one custom constellation
+     */
+    async computeCustomBatch(points, params, options = {}) {
+        this.ensureAvailable();
+        const out = await addon.exponentsCustomBatch(toConstellation(points), params, this.addonOptions(options, 'cpp_native_custom'));
+        return this.unpack(out, params.length, 'cpp_native_custom');
+    }
+
+    addonOptions({ onResult, ...options }, method) {
+        if (!onResult) return options;
+        return { ...options, onResult: (index, row) => onResult(index, toItem(row, method)) };
+    }
+
+    unpack(out, count, method) {
+        const fields = addon.RESULT_FIELDS;
+        const results = [];
+        for (let k = 0; k < count; k++) {
+            results.push(toItem(out.subarray(k * fields, (k + 1) * fields), method));
+        }
+        return results;
+    }
+
+    ensureAvailable() {
+        if (!this.isAvailable) {
+            throw new Error('C++ native addon not available - run `npm run build:native`');
+        }
+    }
+
+    /**
+     * Check if the native addon is available
+     * @returns {boolean} True if the addon is loaded
+     */
+    isReady() {
+        return this.isAvailable;
+    }
+
+    /**
+     * Get addon status information
+     * @returns {Object} Status information
+     */
+    getStatus() {
+        return {
+            addon_loaded: this.isAvailable,
+            addon_path: addonPath,
+            computation_method: 'cpp_native_napi'
+        };
+    }
+}
+
+// Create singleton instance
+export const nativeCalculator = new EPCalculatorNative();
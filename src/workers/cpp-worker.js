@@ -45,8 +45,17 @@ try {
       'double',       // n
       'double',       // threshold
       DoubleArray     // results (output array)
-    ]]
+    ]],
+    'ep_set_memory_budget': ['void', ['size_t']],
+    'ep_set_tiled_evaluation': ['void', ['int', 'int']]
   })
+  // Over this budget the engine evaluates without the dense quadrature matrices (streaming mode)
+  // instead of allocating them, so one large request cannot get the worker OOM-killed
+  const memoryBudgetMb = Number(process.env.MAX_COMPUTATION_MEMORY_MB ?? 1024)
+  cppLib.ep_set_memory_budget(memoryBudgetMb * 1024 * 1024)
+  // Cache-tiled E0 kernel for every point when enabled (off by default); each worker is one of
+  // many, so one kernel thread
+  cppLib.ep_set_tiled_evaluation(process.env.NATIVE_TILED_EVALUATION === 'true' ? 1 : 0, 1)
   console.log(`[Worker] C++ library loaded successfully`)
 } catch (error) {
   console.error(`[Worker] Failed to load C++ library: ${error.message}`)